@@ -2,45 +2,131 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <stdarg.h>
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+#ifdef ESTATISTICAS_RDTSC
+#include <x86intrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // Constantes
 #define TAM_HASH 23
 #define MAX_COMODOS 30
-#define MAX_SUSPEITOS 20
+#define EST_BALDES 32 // baldes dos histogramas de instrumentação
+#define LIMIAR_ORDENACAO_PARALELA 16384 // abaixo disso o qsort simples ganha
+#define DISTANCIA_PREFETCH 8
+#define LOTE_INTERCALADO 16     // consultas em voo em buscarBSTEmLote e comodosDosCaminhos
+#define LOTE_INTERCALADO_MAX 64 // maior grupo aceito pelas versões com grupo explícito
+#define LAMBDA_CHD 5       // chaves por balde no hash perfeito
+#define CARGA_CHD 0.99     // ocupação das posições intermediárias
+#define TENTATIVAS_CHD 32  // sementes testadas antes de desistir
+#define TAM_CORREDOR 4     // cômodos por corredor na FORMA_CORREDORES
+#define LIMIAR_ACUSACAO 2.0 // pontuação mínima para uma acusação valer
+#define EPSILON_PONTUACAO 1e-9
+#define LIMIAR_RELATORIO_PARALELO 16384 // pistas coletadas; abaixo disso o relatório usa uma thread
+#define TAM_SAIDA_SESSAO 2048 // saída pendente de uma sessão do servidor
+#define MAX_RESPOSTA 1024     // maior resposta de um passo (ranking com MAX_RANKING_SESSAO)
+#define MAX_RANKING_SESSAO 10 // suspeitos mostrados no ranking do servidor
+#define TAM_ENTRADA_SESSAO 128
+#define MAX_EVENTOS 256
 
 // ---------------------------------
 // Estruturas
 // ---------------------------------
 
+// --- Arena: blocos grandes liberados de uma vez ---
+typedef struct BlocoArena
+{
+    struct BlocoArena *proximo;
+    size_t usado, capacidade;
+    unsigned char dados[];
+} BlocoArena;
+
+typedef struct
+{
+    BlocoArena *blocos;
+    size_t bytes; // total entregue pela arena
+} Arena;
+
+// --- Texto compacto (nomes e pistas) ---
+// tam bytes, sem contar o '\0'. Até TAM_TEXTO_CURTO bytes o texto fica
+// inteiro na struct (a partir de prefixo). Acima disso prefixo guarda os
+// 4 primeiros bytes e longo aponta para o texto completo, fora da struct:
+// numa arena, no fim da alocação do próprio nó ou numa tabela estática.
+#define TAM_TEXTO_CURTO 11
+typedef struct
+{
+    uint32_t tam;
+    char prefixo[4];
+    union
+    {
+        char resto[8];
+        const char *longo;
+    };
+} Texto;
+
 // --- Estrutura de um cômodo ---
 typedef struct Comodo
 {
-    char nome[50];
-    char pista[100];
+    Texto nome;
+    Texto pista; // tam 0 = sem pista
     struct Comodo *esquerda;
     struct Comodo *direita;
 } Comodo;
 
 // --- Árvore Binária de Pistas (BST) ---
+// Pista normalizada para comparar: prefixo de 64 bits (big-endian) e o texto todo
+typedef struct
+{
+    uint64_t prefixo;
+    const char *texto;
+    size_t tam;
+} ChavePista;
+
 typedef struct NoBST
 {
-    char pista[100];
+    uint64_t chave;     // prefixo da pista normalizada
+    Texto normalizada;  // chave completa (ordem da árvore)
+    Texto pista;        // como foi vista pela primeira vez (cópia própria do nó)
     struct NoBST *esquerda;
     struct NoBST *direita;
 } NoBST;
 
 // --- Ligação pista -> suspeito ---
+// Os textos são de quem monta a base (literais, arena do gerador, bloco da
+// base sintética) e vivem mais que ela; nenhum tamanho fixo no caminho.
 typedef struct
 {
-    char pista[100];
-    char suspeito[50];
+    const char *pista;
+    const char *suspeito;
 } LigacaoPistaSuspeito;
 
 // --- Nó para tabela hash (chaining) ---
 typedef struct HashNo
 {
-    char pista[100];
-    char suspeito[50];
+    Texto pista;
+    Texto suspeito;
     struct HashNo *proximo;
 } HashNo;
 
@@ -50,10 +136,440 @@ typedef struct
     HashNo *tabela[TAM_HASH];
 } HashPistas;
 
+// --- Hash perfeito mínimo (CHD) sobre um vocabulário fixo ---
+// Cada balde guarda só um deslocamento de 16 bits; a posição intermediária
+// (0..m-1) é comprimida para 0..n-1 com rank sobre o bitvector de ocupação.
+typedef struct
+{
+    uint32_t n;             // chaves distintas (posições finais 0..n-1)
+    uint32_t m;             // posições intermediárias (primo)
+    uint32_t baldes;
+    uint64_t semente;
+    uint16_t *deslocamento; // um por balde
+    uint64_t *ocupado;      // bitvector das m posições
+    uint32_t *rank;         // 1s acumulados antes de cada bloco de 512 bits
+} HashPerfeito;
+
+// --- Tabela pista -> suspeito só leitura sobre o hash perfeito ---
+typedef struct
+{
+    HashPerfeito indice;
+    const char **pista;    // pista de cada posição (aponta para a base)
+    const char **suspeito; // suspeito de cada posição
+} HashPistasPerfeito;
+
+// --- Índice radix (trie comprimida) das pistas coletadas ---
+typedef struct NoRadix
+{
+    char *rotulo;            // trecho da aresta que chega neste nó
+    int tamRotulo;
+    int terminal;            // 1 se alguma pista termina aqui
+    int qtdFilhos;
+    int capFilhos;
+    struct NoRadix **filhos; // ordenados pelo primeiro byte (como strcmp)
+} NoRadix;
+
+// --- Ligação ponderada pista -> suspeito (uma pista pode apontar para vários) ---
+typedef struct
+{
+    const char *pista;
+    const char *suspeito;
+    double peso;
+} LigacaoPonderada;
+
+// --- Índice de nomes de suspeito (nome -> posição na lista) ---
+typedef struct
+{
+    HashPerfeito hp;
+    int *id;      // posição do hash -> posição em nomes[]
+    char **nomes;
+    int total;
+} IndiceSuspeitos;
+
+// --- Relação muitos-para-muitos pista <-> suspeito ---
+// Dois índices CSR montados juntos: pista -> suspeitos e suspeito -> pistas.
+// Os vizinhos de um id ficam contíguos em [inicio[id], inicio[id+1]).
+typedef struct
+{
+    HashPerfeito indicePistas;
+    const char **pistas;  // texto de cada id de pista
+    int totalPistas;
+    int totalSuspeitos;
+    int totalLigacoes;
+    int *inicioPista;     // pista -> suspeitos
+    int *suspeitoDe;
+    double *pesoPista;
+    int *inicioSuspeito;  // suspeito -> pistas
+    int *pistaDe;
+    double *pesoSuspeito;
+} RelacaoPistaSuspeito;
+
+// --- Motor de pontuação por evidências ponderadas ---
+// Coletar uma pista custa O(grau dela) na relação. A relação é compartilhada
+// (só leitura); o motor guarda apenas o estado de uma partida, dimensionado
+// pela relação.
+typedef struct
+{
+    const RelacaoPistaSuspeito *rel;
+    double *pontuacao;  // por suspeito, atualizada a cada pista coletada
+    uint64_t *coletada; // bit por id de pista
+    int totalColetadas;
+} MotorPontuacao;
+
+// --- Relatório final (contagens, listas e ranking por suspeito) ---
+typedef struct
+{
+    char *dados;
+    size_t tam, cap;
+} TextoRelatorio;
+
+typedef struct
+{
+    int totalSuspeitos;
+    int totalColetadas;   // pistas coletadas agregadas
+    int totalLigacoes;    // ligações dessas pistas (uma pista pode pesar contra vários)
+    int *contagem;        // pistas por suspeito
+    int *inicio;          // CSR suspeito -> pistas, na ordem das coletadas
+    const char **pistas;
+    int *ranking;         // suspeitos da maior para a menor pontuação
+    TextoRelatorio texto; // relatório já formatado, emitido de uma vez
+} RelatorioFinal;
+
+// --- Coleção persistente de pistas (bifurcação O(1)) ---
+// Versões antigas nunca mudam: inserir copia só o caminho até a posição
+// nova e compartilha o resto. Os nós vivem numa arena liberada de uma vez.
+typedef struct NoPersistente
+{
+    const char *pista; // o texto não é copiado (vive na mansão ou na base)
+    uint32_t prioridade; // treap: heap de prioridades derivadas do hash do texto
+    const struct NoPersistente *esquerda, *direita;
+} NoPersistente;
+
+typedef struct NoContagem
+{
+    const struct NoContagem *filho[2]; // NULL = subárvore toda zerada
+    uint32_t valor;                    // só nas folhas
+} NoContagem;
+
+typedef struct
+{
+    const NoPersistente *pistas;
+    const NoContagem *contagem; // pistas por suspeito, árvore sobre os ids
+    int totalPistas;
+    int niveis;                 // altura da árvore de contagem (ceil log2 suspeitos)
+} ColecaoPersistente;
+
+// --- Rota ótima até uma acusação válida ---
+typedef struct
+{
+    int suspeito;     // -1 se nenhuma acusação é alcançável
+    int movimentos;   // tamanho de rota
+    double pontuacao; // do suspeito ao fim da rota
+    char *rota;       // 'e', 'd' ou 'v' (volta ao cômodo anterior), terminada em '\0'
+    uint64_t estados; // subárvores examinadas pela busca
+} RotaOtima;
+
+// --- Registro compartilhado de pistas (modo cooperativo) ---
+// Conjunto de endereçamento aberto com capacidade fixa. Uma posição é
+// reivindicada por CAS e nunca volta a ficar livre, então não há trava
+// global, nem ABA, nem registro duplicado.
+typedef struct
+{
+    size_t mascara;      // capacidade - 1 (potência de 2)
+    const char **pista;  // NULL = livre; escrita uma única vez por CAS
+    int *suspeito;       // -1 até o vencedor do CAS publicar
+    uint64_t *contagem;  // pistas por suspeito (incremento atômico)
+    int totalSuspeitos;
+    uint64_t total;      // pistas distintas registradas
+} RegistroCompartilhado;
+
+// --- Motor de jogo: regras como função de passo pura ---
+// passoJogo(mundo, estado, entrada) atualiza o estado e devolve eventos num
+// vetor do chamador; não faz E/S nem alocação. Terminal, servidor, scripts e
+// benchmarks só traduzem eventos em texto ou efeitos colaterais.
+#define MAX_EVENTOS_PASSO 4
+
+typedef struct
+{
+    const Comodo *raiz;
+    const RelacaoPistaSuspeito *rel; // pistas e pesos (compartilhado, só leitura); 1ª ligação = suspeito principal
+    char **suspeitos;
+    int totalSuspeitos;
+    struct MansaoSobDemanda *sobDemanda; // NULL: mansão inteira já em memória
+    const Comodo *comodos;               // com pistaDe: vetor de onde vêm os cômodos
+    const int16_t *pistaDe;              // id na relação da pista de cada cômodo (-1 = sem pista);
+                                         // NULL: a pista está no próprio Comodo
+} MundoJogo;
+
+typedef enum
+{
+    FASE_MAPA,
+    FASE_FINAL,
+    FASE_LISTAR,     // esperando o número do suspeito para listar pistas
+    FASE_ACUSAR,     // esperando o número do suspeito acusado
+    FASE_PREFIXO,    // esperando o prefixo da busca
+    FASE_APROXIMADA, // esperando o texto da busca aproximada
+    FASE_DISTANCIA,  // esperando a distância máxima
+    FASE_FIM
+} FaseJogo;
+
+// Estado de uma partida. Pistas coletadas e pontuações ficam no motor, alocado
+// em iniciarJogo do tamanho da relação do mundo (liberarJogo devolve).
+typedef struct
+{
+    unsigned char fase;
+    const Comodo *atual;
+    MotorPontuacao motor;
+    char termo[80]; // texto da busca aproximada entre FASE_APROXIMADA e FASE_DISTANCIA
+} EstadoJogo;
+
+typedef enum
+{
+    EVENTO_ENTROU,           // comodo
+    EVENTO_PISTA_NOVA,       // comodo, pista, valor = id da pista, texto = suspeito principal
+    EVENTO_PISTA_REPETIDA,   // comodo, pista
+    EVENTO_PISTA_SOLTA,      // comodo, pista; pista sem ligação com os suspeitos da lista
+    EVENTO_SEM_PISTA,
+    EVENTO_SEM_CAMINHO,
+    EVENTO_OPCAO_INVALIDA,
+    EVENTO_SAIU_MAPA,
+    EVENTO_RANKING,          // ver rankingMotor
+    EVENTO_PISTAS_SUSPEITO,  // valor = suspeito
+    EVENTO_ACUSACAO,         // valor = suspeito, correta
+    EVENTO_ESCOLHA_INVALIDA,
+    EVENTO_BUSCA_PREFIXO,    // texto = prefixo
+    EVENTO_BUSCA_APROXIMADA, // texto = termo, valor = distância
+    EVENTO_RELATORIO,
+    EVENTO_FIM
+} TipoEvento;
+
+typedef struct
+{
+    TipoEvento tipo;
+    int valor;
+    int correta;
+    const Comodo *comodo;
+    const char *pista; // texto da pista do cômodo (no mundo)
+    const char *texto; // aponta para o mundo, o estado ou a entrada do passo
+} EventoJogo;
+
+
+// --- Mansão procedural (gerada para testes de escala) ---
+typedef enum
+{
+    FORMA_BALANCEADA, // filhos de i em 2i+1 e 2i+2
+    FORMA_ENVIESADA,  // espinha funda: cada cômodo da espinha tem uma folha à esquerda
+    FORMA_CORREDORES  // árvore balanceada de corredores (como jardim -> estufa)
+} FormaMansao;
+
+typedef struct
+{
+    Comodo *comodos;             // vetor contíguo; comodos[0] é o Hall
+    size_t total;
+    FormaMansao forma;
+    uint64_t semente;
+    char **suspeitos;            // corpus sintético
+    int totalSuspeitos;
+    LigacaoPistaSuspeito *base;
+    int totalBase;
+    Arena textos;                // nomes longos dos cômodos (pistas apontam para base)
+    Arena textosBase;            // textos das pistas de base
+} MansaoProcedural;
+
+// --- Mansão congelada: cópia contígua e só de leitura de uma árvore pronta ---
+typedef enum
+{
+    ORDEM_BFS, // nível a nível, como o vetor do gerador balanceado
+    ORDEM_VEB  // van Emde Boas: subárvores de altura ~h/2 contíguas, recursivamente
+} OrdemCongelada;
+
+typedef struct
+{
+    Comodo *comodos; // comodos[0] é o Hall
+    size_t total;
+    OrdemCongelada ordem;
+    Arena textos; // nomes longos (pistas apontam para a base)
+} MansaoCongelada;
+
+// --- Cenário padrão pronto para o motor de jogo ---
+// Com mestre_tabelas.h nada é montado: relação e mansão são tabelas estáticas
+// só de leitura e a partida sorteia apenas a pista de cada cômodo (pistaDe).
+// Sem o cabeçalho, relação e mansão são construídas e a mansão é congelada.
+typedef struct
+{
+    MundoJogo mundo;
+    LigacaoPonderada *ligacoes;   // sem as tabelas
+    RelacaoPistaSuspeito relacao; // sem as tabelas
+    MansaoCongelada *congelada;   // sem as tabelas
+    int16_t pistaDe[MAX_COMODOS]; // com as tabelas
+} CenarioPadrao;
+
+// --- Mansão sucinta: topologia em 2 bits por cômodo, textos fora ---
+// Um bloco só, sem ponteiros internos: o mesmo bytes na memória e no arquivo
+typedef struct
+{
+    char magica[8];
+    uint64_t total, totalPistas, totalUns, bytesNomes, bytesPistas, tamBloco;
+} CabecalhoSucinta;
+
+typedef struct
+{
+    const uint64_t *bits;     // cômodos em BFS; bit 2i: i tem filho à esquerda, 2i+1: à direita
+    const uint32_t *rank;     // 1s antes de cada bloco de 8 palavras
+    const uint32_t *amostras; // bloco onde está o 1 de número 512k
+    const uint64_t *baseNome; // início dos nomes de cada grupo de 256 cômodos
+    const uint32_t *offNome;  // nome do cômodo, a partir do início do grupo
+    const uint32_t *pistaDe;  // id da pista de cada cômodo (0 = sem pista)
+    const uint32_t *offPista;
+    const char *nomes, *pistas;
+    size_t total, totalPistas, totalUns;
+    CabecalhoSucinta *bloco;
+    int mapeada; // bloco vem de mmap (só leitura)
+} MansaoSucinta;
+
+// --- Mansão sob demanda: cômodos criados ao serem alcançados, LRU limitada ---
+typedef struct ComodoSobDemanda
+{
+    Comodo comodo;     // o que o motor de jogo vê (primeiro campo)
+    uint64_t semente;  // derivada do caminho desde o Hall
+    uint64_t indice;   // índice de heap do caminho (nome do cômodo)
+    uint32_t profundidade;
+    int filhosProntos; // esquerda/direita já refletem os filhos que existem
+    struct ComodoSobDemanda *pai;                // NULL se o pai foi despejado
+    struct ComodoSobDemanda *anterior, *proximo; // LRU (mais recente na frente)
+} ComodoSobDemanda;
+
+typedef struct MansaoSobDemanda
+{
+    uint64_t semente;
+    uint32_t profundidadeMaxima;
+    LigacaoPistaSuspeito *base; // pistas sorteadas para os cômodos
+    int totalBase;
+    size_t capacidade;          // cômodos vivos fora o Hall
+    size_t vivos, picoVivos;    // pico medido depois do despejo: nunca passa da capacidade
+    uint64_t criados, despejados;
+    ComodoSobDemanda *hall;
+    ComodoSobDemanda *maisRecente, *menosRecente;
+} MansaoSobDemanda;
+
+// Chamado para cada pista encontrada numa busca do índice
+typedef void (*VisitaPista)(const char *pista, int distancia, void *ctx);
+
+// --- Contadores de instrumentação (ativos só com -DESTATISTICAS) ---
+typedef struct
+{
+    uint64_t insercoesBST;
+    uint64_t buscasBST;
+    uint64_t profInsercaoBST[EST_BALDES]; // histograma de profundidade
+    uint64_t profBuscaBST[EST_BALDES];
+    uint64_t latInsercaoBST[EST_BALDES]; // histograma log2 de latência
+    uint64_t latBuscaBST[EST_BALDES];
+    uint64_t insercoesHash;
+    uint64_t cadeiaHash[EST_BALDES]; // tamanho do balde antes de inserir
+    uint64_t chamadasHash;
+    uint64_t tempoHash; // soma das latências de funcao_hash
+    uint64_t latHash[EST_BALDES];
+    uint64_t buscasRadix;      // prefixo e aproximada no menu final
+    uint64_t consultasRelacao; // idPistaRelacao (sonda no CHD das pistas)
+    uint64_t passos;           // passoJogo vindos do terminal
+    uint64_t movimentos;
+    uint64_t tempoPassosNs; // só o trabalho dos passos (sem fgets nem printf)
+} Estatisticas;
+
+// --- Contabilidade de memória por estrutura (sempre ativa) ---
+typedef enum
+{
+    MEM_COMODOS, // criarComodo e o vetor das mansões geradas
+    MEM_PISTAS,  // nós da BST de pistas
+    MEM_HASH,    // nós da tabela hash pista -> suspeito
+    MEM_ARENA,   // blocos de arena (textos longos, coleção persistente)
+    MEM_RADIX,   // nós do índice radix (rótulo no fim do nó) e vetores de filhos
+    MEM_RELACAO, // vetores CSR da relação pista <-> suspeito
+    MEM_CHD,     // vetores dos hashes perfeitos (deslocamentos, ocupação, rank)
+    TOTAL_CATEGORIAS_MEMORIA
+} CategoriaMemoria;
+
+// Só cresce; vivos = alocados - liberados. Uma linha de cache por categoria.
+typedef struct
+{
+    _Alignas(64) uint64_t alocacoes;
+    uint64_t liberacoes;
+    uint64_t bytesAlocados;
+    uint64_t bytesLiberados;
+    uint64_t picoBytes; // maior valor de bytes vivos já visto
+} ContadorMemoria;
+
+// Retrato de uma categoria num instante
+typedef struct
+{
+    uint64_t objetos, bytes; // vivos
+    uint64_t picoBytes;
+    uint64_t alocacoes, bytesAlocados; // acumulados desde o início
+} ContagemMemoria;
+
+// ---------------------------------
+// Cenário padrão
+// ---------------------------------
+// Lista fixa de suspeitos solicitada
+static char *suspeitosPadrao[] = {
+    "Mordomo",
+    "Jardineiro",
+    "Cozinheira",
+    "Bibliotecario",
+    "Visitante Misterioso"};
+
+// pista -> suspeito
+static LigacaoPistaSuspeito basePadrao[] = {
+    {"A luz está apagada.", "Mordomo"},
+    {"Há pegadas de lama.", "Jardineiro"},
+    {"Um objeto foi derrubado.", "Cozinheira"},
+    {"Uma janela está entreaberta.", "Visitante Misterioso"},
+    {"Um cheiro estranho vem daqui.", "Jardineiro"},
+    {"Marcas de faca na mesa.", "Cozinheira"},
+    {"Perfume caro no ar.", "Visitante Misterioso"},
+    {"Livro antigo fora do lugar.", "Mordomo"},
+    {"Ferramentas sujas largadas.", "Jardineiro"},
+    {"Copo quebrado na cozinha.", "Cozinheira"},
+    {"Bilhete com letras cortadas.", "Visitante Misterioso"},
+    {"Papel rasgado no chão.", "Mordomo"},
+    {"Sinais de lama na estufa.", "Jardineiro"},
+    {"Sujeira próxima aos arquivos.", "Mordomo"},
+    {"Garrafa vazia na adega.", "Visitante Misterioso"}};
+
+// Evidências secundárias: pistas que também pesam contra outro suspeito.
+// As ligações de basePadrao entram com peso 1.
+static LigacaoPonderada evidenciasExtrasPadrao[] = {
+    {"Livro antigo fora do lugar.", "Bibliotecario", 1.0},
+    {"Sujeira próxima aos arquivos.", "Bibliotecario", 0.5},
+    {"Há pegadas de lama.", "Visitante Misterioso", 0.5},
+    {"Copo quebrado na cozinha.", "Mordomo", 0.5},
+    {"Garrafa vazia na adega.", "Mordomo", 0.5}};
+
+#define TOTAL_SUSPEITOS_PADRAO (int)(sizeof(suspeitosPadrao) / sizeof(suspeitosPadrao[0]))
+#define TOTAL_BASE_PADRAO (int)(sizeof(basePadrao) / sizeof(basePadrao[0]))
+#define TOTAL_EXTRAS_PADRAO (int)(sizeof(evidenciasExtrasPadrao) / sizeof(evidenciasExtrasPadrao[0]))
+
 // ---------------------------------
 // Protótipos
 // ---------------------------------
 
+// Arena e texto compacto
+void *alocarArena(Arena *a, size_t tam);
+void juntarArena(Arena *destino, Arena *origem);
+void liberarArena(Arena *a);
+static inline const char *lerTexto(const Texto *t);
+static inline size_t extraTexto(size_t tam);
+Texto montarTexto(const char *s, size_t tam, char *fora);
+Texto referenciarTexto(const char *s);
+Texto guardarTexto(Arena *a, const char *s);
+const char *guardarString(Arena *a, const char *s);
+
+// Normalização de pistas
+size_t normalizarPista(const char *pista, size_t tam, char *destino);
+ChavePista montarChave(const char *texto, size_t tam);
+int compararChaves(const ChavePista *a, const ChavePista *b);
+ChavePista chaveDaPista(const char *pista, char *local, size_t cap, char **alocado);
+
 // Mansão / construção
 Comodo *criarComodo(const char *nome, const char *pista);
 void ligar(Comodo *origem, Comodo *esq, Comodo *dir);
@@ -74,17 +590,226 @@ void liberarBST(NoBST *raiz);
 int funcao_hash(const char *chave);
 void inicializarHashPistas(HashPistas *hash);
 void inserirHashPista(HashPistas *hash, const char *pista, const char *suspeito);
+void inserirHashPistaIdx(HashPistas *hash, int idx, const char *pista, const char *suspeito);
 int contarPistasPorSuspeito(HashPistas *hash, const char *suspeito);
 void listarPistasPorSuspeito(HashPistas *hash, const char *suspeito);
 void mostrarHashPistas(HashPistas *hash);
 void liberarHashPistas(HashPistas *hash);
+const char *buscarHashPista(HashPistas *hash, const char *pista);
+
+// Hash perfeito (CHD)
+int construirHashPerfeito(HashPerfeito *hp, const char *const chaves[], uint32_t n, int32_t posicao[]);
+uint32_t posicaoHashPerfeito(const HashPerfeito *hp, const char *chave);
+size_t bitsHashPerfeito(const HashPerfeito *hp);
+void liberarHashPerfeito(HashPerfeito *hp);
+int construirHashPistasPerfeito(HashPistasPerfeito *t, LigacaoPistaSuspeito base[], int totalBase);
+const char *buscarHashPistasPerfeito(const HashPistasPerfeito *t, const char *pista);
+void liberarHashPistasPerfeito(HashPistasPerfeito *t);
+
+// Tabelas geradas (mestre_tabelas.h)
+uint32_t hashSemente(const char *s, uint32_t semente);
+uint64_t impressaoCenarioPadrao(void);
+int conferirTabelasGeradas(void);
+void montarCenarioPadrao(CenarioPadrao *c, MansaoSobDemanda *sobDemanda);
+void liberarCenarioPadrao(CenarioPadrao *c);
+int gerarTabelas(FILE *saida);
+
+// Inserção em lote
+int numeroThreads(void);
+void ordenarTextos(const char **v, size_t n);
+int inserirPistasEmLote(NoBST **pistasBST, HashPistas *hash, const char *pistas[], int qtd, LigacaoPistaSuspeito base[], int totalBase);
+
+// Índice radix (busca por prefixo e aproximada)
+NoRadix *criarNoRadix(const char *rotulo, int tam);
+void inserirRadix(NoRadix *raiz, const char *pista);
+NoRadix *construirIndicePistas(NoBST *raiz);
+int percorrerRadix(NoRadix *raiz, VisitaPista visitar, void *ctx);
+int buscarPrefixoRadix(NoRadix *raiz, const char *prefixo, VisitaPista visitar, void *ctx);
+int buscarAproximadoRadix(NoRadix *raiz, const char *termo, int maxDist, VisitaPista visitar, void *ctx);
+void mostrarPistasRadix(NoRadix *raiz);
+void liberarRadix(NoRadix *raiz);
+
+// Gerador procedural de mansões
+MansaoProcedural *gerarMansao(size_t total, FormaMansao forma, uint64_t semente, int totalSuspeitos, int totalPistas, int threads);
+int lerFormaMansao(const char *nome, FormaMansao *forma);
+const char *nomeFormaMansao(FormaMansao forma);
+size_t alturaMansao(Comodo *raiz);
+void liberarMansaoProcedural(MansaoProcedural *m);
+
+// Mansão congelada (layout contíguo da árvore pronta)
+MansaoCongelada *congelarMansao(const Comodo *raiz, OrdemCongelada ordem);
+void liberarMansaoCongelada(MansaoCongelada *m);
+
+// Mansão sucinta (topologia LOUDS com rank/select; pode ser mapeada de arquivo)
+MansaoSucinta *sucintarMansao(const Comodo *raiz);
+int gravarMansaoSucinta(const MansaoSucinta *m, int fd);
+MansaoSucinta *mapearMansaoSucinta(int fd);
+size_t filhoSucinto(const MansaoSucinta *m, size_t i, int lado);
+size_t paiSucinto(const MansaoSucinta *m, size_t i);
+const char *nomeSucinto(const MansaoSucinta *m, size_t i);
+const char *pistaSucinta(const MansaoSucinta *m, size_t i);
+void liberarMansaoSucinta(MansaoSucinta *m);
+
+// Mansão sob demanda
+MansaoSobDemanda *criarMansaoSobDemanda(uint64_t semente, size_t capacidade, uint32_t profundidadeMaxima,
+                                        LigacaoPistaSuspeito *base, int totalBase);
+void prepararComodo(MansaoSobDemanda *m, const Comodo *atual);
+void liberarMansaoSobDemanda(MansaoSobDemanda *m);
+
+// Consultas em lote intercaladas (prefetch de um passo por consulta em voo)
+void buscarBSTEmLote(NoBST *raiz, const char *const pistas[], size_t n, int achou[]);
+const Comodo *comodoDoCaminho(const Comodo *hall, uint64_t indice);
+void comodosDosCaminhos(const Comodo *hall, const uint64_t indices[], size_t n, const Comodo *saida[]);
+
+// Relação pista <-> suspeito (CSR)
+void construirRelacao(RelacaoPistaSuspeito *rel, const LigacaoPonderada lig[], int totalLig, char *suspeitos[], int totalSuspeitos);
+int idPistaRelacao(const RelacaoPistaSuspeito *rel, const char *pista);
+const int *suspeitosDaPista(const RelacaoPistaSuspeito *rel, int pista, int *qtd);
+const int *pistasDoSuspeito(const RelacaoPistaSuspeito *rel, int suspeito, int *qtd);
+void liberarRelacao(RelacaoPistaSuspeito *rel);
+
+// Pontuação ponderada
+LigacaoPonderada *montarLigacoesPonderadas(LigacaoPistaSuspeito base[], int totalBase, LigacaoPonderada extras[], int totalExtras);
+void iniciarMotorPontuacao(MotorPontuacao *mp, const RelacaoPistaSuspeito *rel);
+void zerarMotorPontuacao(MotorPontuacao *mp);
+int idPistaMotor(const MotorPontuacao *mp, const char *pista);
+int coletarPistaMotor(MotorPontuacao *mp, int p);
+int registrarPistaMotor(MotorPontuacao *mp, const char *pista);
+int pistasColetadasMotor(const MotorPontuacao *mp, int ids[]);
+int rankingMotor(const MotorPontuacao *mp, int ordem[]);
+int acusacaoCorreta(const MotorPontuacao *mp, int suspeito);
+int contarPistasColetadasSuspeito(const MotorPontuacao *mp, int suspeito);
+void listarPistasColetadasSuspeito(const MotorPontuacao *mp, char *suspeitos[], int suspeito);
+void liberarMotorPontuacao(MotorPontuacao *mp);
+
+// Relatório final (agregação paralela)
+void montarRelatorio(RelatorioFinal *r, const RelacaoPistaSuspeito *rel, const int coletadas[], int qtdColetadas,
+                     const double *pontuacao, char *suspeitos[], int threads);
+void emitirRelatorio(const RelatorioFinal *r, FILE *saida);
+void liberarRelatorio(RelatorioFinal *r);
+
+// Coleção persistente (bifurcação de sessões)
+ColecaoPersistente colecaoVazia(int totalSuspeitos);
+int registrarPistaPersistente(Arena *a, ColecaoPersistente *c, const char *pista, int suspeito);
+int buscarPersistente(const NoPersistente *raiz, const char *pista);
+uint32_t contagemPersistente(const ColecaoPersistente *c, int suspeito);
+
+// Rota ótima (resolvedor com poda)
+void resolverRotaOtima(const Comodo *hall, const RelacaoPistaSuspeito *rel, int threads, RotaOtima *r);
+void liberarRotaOtima(RotaOtima *r);
+
+// Registro compartilhado (modo cooperativo)
+void criarRegistroCompartilhado(RegistroCompartilhado *r, size_t maxPistas, int totalSuspeitos);
+int registrarPistaCompartilhada(RegistroCompartilhado *r, const char *pista, int suspeito);
+int contemPistaCompartilhada(const RegistroCompartilhado *r, const char *pista);
+uint64_t contagemCompartilhada(const RegistroCompartilhado *r, int suspeito);
+void liberarRegistroCompartilhado(RegistroCompartilhado *r);
+int executarCoop(int argc, char *argv[]);
+
+// Modo servidor (epoll) e gerador de carga
+int executarServidor(int argc, char *argv[]);
+int executarCarga(int argc, char *argv[]);
+
+// Comparação entre níveis (novato, aventureiro, mestre e variantes)
+int compararNiveis(int argc, char *argv[]);
+
+// Motor de jogo (passo puro)
+void iniciarJogo(const MundoJogo *mundo, EstadoJogo *e);
+void reiniciarJogo(const MundoJogo *mundo, EstadoJogo *e);
+void liberarJogo(EstadoJogo *e);
+int passoJogo(const MundoJogo *mundo, EstadoJogo *e, const char *entrada, EventoJogo ev[]);
 
 // Interface / menus
-void menu(Comodo *raiz, NoBST **pistasBST, HashPistas *hash, LigacaoPistaSuspeito base[], int totalBase, char *suspeitos[], int totalSuspeitos);
-void menuFinal(HashPistas *hash, char *suspeitos[], int totalSuspeitos);
+void imprimirPromptJogo(const MundoJogo *mundo, const EstadoJogo *e);
+void imprimirEventoJogo(const MundoJogo *mundo, const EstadoJogo *e, const EventoJogo *ev);
+void menu(const MundoJogo *mundo, EstadoJogo *jogo, NoBST **pistasBST);
+void montarRelatorioJogo(RelatorioFinal *r, const MundoJogo *mundo, const EstadoJogo *jogo);
+void menuFinal(const MundoJogo *mundo, EstadoJogo *jogo, NoRadix *indice);
 
 // Utilitários
 void trim_newline(char *s); // remove \n e \r
+uint64_t misturar64(uint64_t z);
+uint64_t aleatorio64(uint64_t *estado);
+
+// Benchmarks (./mestre bench ...)
+int executarBenchmarks(int argc, char *argv[]);
+
+// Instrumentação
+uint64_t relogioNs(void);
+void registrarEstatisticas(void);
+void consolidarEstatisticas(void);
+void imprimirEstatisticas(int fd);
+void *alocarContado(CategoriaMemoria cat, size_t objetos, size_t bytes);
+void *realocarContado(CategoriaMemoria cat, void *p, size_t bytesAntes, size_t bytes);
+void liberarContado(CategoriaMemoria cat, void *p, size_t objetos, size_t bytes);
+void consultarMemoria(CategoriaMemoria cat, ContagemMemoria *c);
+void imprimirMemoria(int fd);
+int conferirVazamentos(const ContagemMemoria antes[], const char *contexto);
+void registrarMemoria(void);
+
+// ---------------------------------
+// Tabelas geradas para o cenário padrão
+// ---------------------------------
+// mestre_tabelas.h é emitido por "./mestre gerar-tabelas > mestre_tabelas.h".
+// Sem o arquivo o jogo monta a mansão com malloc e procura o suspeito com a
+// varredura linear de base[], como antes. Os _Static_assert só pegam mudanças
+// de tamanho; o conteúdo (cômodos, ligações, pistas e suspeitos) é conferido
+// fora da partida, por "./mestre conferir-tabelas" e pelo bench tabelas,
+// contra a impressão digital que gerar-tabelas grava no cabeçalho.
+#if defined(__has_include)
+#if __has_include("mestre_tabelas.h")
+#include "mestre_tabelas.h"
+#endif
+#endif
+
+#ifdef TABELAS_GERADAS
+#ifndef RELACAO_GERADA
+#error "mestre_tabelas.h de um formato antigo: rode ./mestre gerar-tabelas > mestre_tabelas.h"
+#endif
+_Static_assert(TOTAL_BASE_GERADA == sizeof(basePadrao) / sizeof(basePadrao[0]),
+               "mestre_tabelas.h desatualizado: rode ./mestre gerar-tabelas > mestre_tabelas.h");
+_Static_assert(TOTAL_SUSPEITOS_GERADOS == sizeof(suspeitosPadrao) / sizeof(suspeitosPadrao[0]),
+               "mestre_tabelas.h desatualizado: rode ./mestre gerar-tabelas > mestre_tabelas.h");
+_Static_assert(TOTAL_COMODOS_GERADOS <= MAX_COMODOS, "mansão gerada maior que MAX_COMODOS");
+void sortearPistasGeradas(int16_t pistaDe[]);
+#endif
+
+// ---------------------------------
+// Macros de instrumentação
+// ---------------------------------
+// Sem -DESTATISTICAS todas viram ((void)0) e não sobra custo nenhum.
+// Os contadores são por thread; consolidarEstatisticas() soma na global.
+#ifdef ESTATISTICAS
+static _Thread_local Estatisticas estLocal;
+static Estatisticas estGlobal;
+#ifdef ESTATISTICAS_RDTSC
+#define EST_RELOGIO() ((uint64_t)__rdtsc())
+#define EST_UNIDADE "ciclos"
+#else
+#define EST_RELOGIO() relogioNs()
+#define EST_UNIDADE "ns"
+#endif
+static inline int baldeLog2(uint64_t v)
+{
+    int b = 0;
+    while (v >>= 1)
+        b++;
+    return b < EST_BALDES ? b : EST_BALDES - 1;
+}
+#define EST_TEMPO(var) uint64_t var = EST_RELOGIO()
+#define EST_INC(campo) (estLocal.campo++)
+#define EST_HIST(hist, v) (estLocal.hist[(v) < EST_BALDES ? (v) : EST_BALDES - 1]++)
+#define EST_LATENCIA(hist, inicio) (estLocal.hist[baldeLog2(EST_RELOGIO() - (inicio))]++)
+#define EST_INICIO_NS(var) uint64_t var = relogioNs()
+#define EST_ACUMULAR_NS(campo, inicio) (estLocal.campo += relogioNs() - (inicio))
+#else
+#define EST_TEMPO(var) ((void)0)
+#define EST_INC(campo) ((void)0)
+#define EST_HIST(hist, v) ((void)0)
+#define EST_LATENCIA(hist, inicio) ((void)0)
+#define EST_INICIO_NS(var) ((void)0)
+#define EST_ACUMULAR_NS(campo, inicio) ((void)0)
+#endif
 
 // ---------------------------------
 // Implementação
@@ -93,57 +818,72 @@ void trim_newline(char *s); // remove \n e \r
 // ---------------------------------
 // Função principal
 // ---------------------------------
-int main(void)
+// Uso:
+//   ./mestre                 jogo interativo
+//   ./mestre bench [nome]    benchmarks (sem nome: todos)
+//   ./mestre gerar-tabelas   emite mestre_tabelas.h para o cenário padrão
+//   ./mestre conferir-tabelas
+//                            falha se mestre_tabelas.h não bate com as fontes
+//   ./mestre sob-demanda [semente] [capacidade] [profundidade]
+//                            jogo numa mansão procedural criada conforme se anda
+//   ./mestre comparar [repetições] [nível=executável ...]
+//                            mesmos roteiros no novato, aventureiro e mestre
+int main(int argc, char *argv[])
 {
-    srand((unsigned)time(NULL));
+    registrarMemoria();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        return executarBenchmarks(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "gerar-tabelas") == 0)
+        return gerarTabelas(stdout);
+    if (argc > 1 && strcmp(argv[1], "conferir-tabelas") == 0)
+    {
+        if (conferirTabelasGeradas())
+            return 0;
+        fprintf(stderr, "mestre_tabelas.h desatualizado: rode ./mestre gerar-tabelas > mestre_tabelas.h e recompile\n");
+        return 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "coop") == 0)
+        return executarCoop(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "servidor") == 0)
+        return executarServidor(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "carga") == 0)
+        return executarCarga(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "comparar") == 0)
+        return compararNiveis(argc - 2, argv + 2);
 
-    // Lista fixa de suspeitos solicitada
-    char *suspeitos[] = {
-        "Mordomo",
-        "Jardineiro",
-        "Cozinheira",
-        "Bibliotecario",
-        "Visitante Misterioso"};
-    int totalSuspeitos = 5;
-
-    // pista -> suspeito
-    LigacaoPistaSuspeito base[] = {
-        {"A luz está apagada.", "Mordomo"},
-        {"Há pegadas de lama.", "Jardineiro"},
-        {"Um objeto foi derrubado.", "Cozinheira"},
-        {"Uma janela está entreaberta.", "Visitante Misterioso"},
-        {"Um cheiro estranho vem daqui.", "Jardineiro"},
-        {"Marcas de faca na mesa.", "Cozinheira"},
-        {"Perfume caro no ar.", "Visitante Misterioso"},
-        {"Livro antigo fora do lugar.", "Mordomo"},
-        {"Ferramentas sujas largadas.", "Jardineiro"},
-        {"Copo quebrado na cozinha.", "Cozinheira"},
-        {"Bilhete com letras cortadas.", "Visitante Misterioso"},
-        {"Papel rasgado no chão.", "Mordomo"},
-        {"Sinais de lama na estufa.", "Jardineiro"},
-        {"Sujeira próxima aos arquivos.", "Mordomo"},
-        {"Garrafa vazia na adega.", "Visitante Misterioso"}};
-    int totalBase = sizeof(base) / sizeof(base[0]);
-
-    // Estruturas de armazenamento
-    HashPistas tabela;
-    inicializarHashPistas(&tabela);
+    // MESTRE_SEMENTE fixa o sorteio das pistas (./mestre comparar repete partidas com ela)
+    const char *semente = getenv("MESTRE_SEMENTE");
+    srand(semente != NULL ? (unsigned)strtoul(semente, NULL, 10) : (unsigned)time(NULL));
+    registrarEstatisticas();
 
+    // Pistas coletadas em ordem alfabética (base do índice radix do menu final)
     NoBST *pistasEncontradas = NULL;
 
-    // Montar mansão e obter todos os cômodos
-    Comodo *todos[MAX_COMODOS];
-    int qtdComodos = 0;
-    Comodo *raiz = montarMansao(todos, &qtdComodos);
+    MansaoSobDemanda *sobDemanda = NULL;
+    if (argc > 1 && strcmp(argv[1], "sob-demanda") == 0)
+    {
+        // Só o Hall existe agora; cada cômodo nasce (já com pista) quando o pai é alcançado
+        uint64_t semente = argc > 2 ? (uint64_t)atoll(argv[2]) : (uint64_t)time(NULL);
+        size_t capacidade = argc > 3 ? (size_t)atoll(argv[3]) : 4096;
+        uint32_t profundidade = argc > 4 ? (uint32_t)atoi(argv[4]) : 62;
+        sobDemanda = criarMansaoSobDemanda(semente, capacidade, profundidade, basePadrao, TOTAL_BASE_PADRAO);
+    }
+
+    // Cenário padrão: suspeitos, relação pista <-> suspeito e mansão com as pistas sorteadas
+    CenarioPadrao cenario;
+    montarCenarioPadrao(&cenario, sobDemanda);
 
-    // Distribuir pistas automaticamente (aleatoriamente escolhendo da base)
-    distribuirPistas(todos, qtdComodos, base, totalBase);
+    // Regras da partida (motor de passo puro)
+    const MundoJogo mundo = cenario.mundo;
+    EstadoJogo jogo;
+    iniciarJogo(&mundo, &jogo);
 
     // Menu principal (navegação)
-    menu(raiz, &pistasEncontradas, &tabela, base, totalBase, suspeitos, totalSuspeitos);
+    menu(&mundo, &jogo, &pistasEncontradas);
 
     // Menu final de investigação
-    menuFinal(&tabela, suspeitos, totalSuspeitos);
+    NoRadix *indice = construirIndicePistas(pistasEncontradas);
+    menuFinal(&mundo, &jogo, indice);
 
     // Exibir BST final (opcional)
     printf("\n===== Pistas Encontradas (ordenadas) =====\n");
@@ -152,38 +892,357 @@ int main(void)
     else
         mostrarPistasBST(pistasEncontradas);
 
-    // Mostrar tabela hash completa
-    printf("\n===== Tabela Hash (pista -> suspeito) =====\n");
-    mostrarHashPistas(&tabela);
+    // Relatório final: pistas e pontuação por suspeito, agregadas em paralelo
+    RelatorioFinal relatorio;
+    montarRelatorioJogo(&relatorio, &mundo, &jogo);
+    printf("\n===== Relatório Final (por suspeito) =====\n");
+    emitirRelatorio(&relatorio, stdout);
+    liberarRelatorio(&relatorio);
 
     // Liberar memória
+    liberarRadix(indice);
     liberarBST(pistasEncontradas);
-    liberarHashPistas(&tabela);
-    liberarArvore(raiz);
+    liberarJogo(&jogo);
+    liberarCenarioPadrao(&cenario);
+    liberarMansaoSobDemanda(sobDemanda);
 
     return 0;
 }
 
+// ---------------------------------
+// Arena e texto compacto
+// ---------------------------------
+#define BLOCO_ARENA (64 * 1024)
+
+// Reserva tam bytes alinhados (relativo ao bloco) a alinhamento, potência de 2
+static void *reservarArena(Arena *a, size_t tam, size_t alinhamento)
+{
+    BlocoArena *b = a->blocos;
+    size_t inicio = b ? (b->usado + alinhamento - 1) & ~(alinhamento - 1) : 0;
+    if (b == NULL || inicio + tam > b->capacidade)
+    {
+        size_t cap = tam > BLOCO_ARENA ? tam : BLOCO_ARENA;
+        b = alocarContado(MEM_ARENA, 1, sizeof(*b) + cap);
+        if (b == NULL)
+        {
+            printf("Erro ao alocar memória para a arena.\n");
+            exit(1);
+        }
+        b->proximo = a->blocos;
+        b->capacidade = cap;
+        a->blocos = b;
+        inicio = 0;
+    }
+    b->usado = inicio + tam;
+    a->bytes += tam;
+    return b->dados + inicio;
+}
+
+void *alocarArena(Arena *a, size_t tam)
+{
+    return reservarArena(a, (tam + 15) & ~(size_t)15, 16);
+}
+
+// Passa os blocos de origem para destino (arenas preenchidas por threads diferentes)
+void juntarArena(Arena *destino, Arena *origem)
+{
+    while (origem->blocos)
+    {
+        BlocoArena *b = origem->blocos;
+        origem->blocos = b->proximo;
+        b->proximo = destino->blocos;
+        destino->blocos = b;
+    }
+    destino->bytes += origem->bytes;
+    origem->bytes = 0;
+}
+
+void liberarArena(Arena *a)
+{
+    while (a->blocos)
+    {
+        BlocoArena *prox = a->blocos->proximo;
+        liberarContado(MEM_ARENA, a->blocos, 1, sizeof(*a->blocos) + a->blocos->capacidade);
+        a->blocos = prox;
+    }
+    a->bytes = 0;
+}
+
+// O texto como string C (inline ou fora da struct)
+static inline const char *lerTexto(const Texto *t)
+{
+    return t->tam <= TAM_TEXTO_CURTO ? (const char *)t + offsetof(Texto, prefixo) : t->longo;
+}
+
+// Bytes fora da struct que um texto de tam bytes precisa (0 se couber inline)
+static inline size_t extraTexto(size_t tam)
+{
+    return tam > TAM_TEXTO_CURTO ? tam + 1 : 0;
+}
+
+// Texto de tam bytes; o longo é copiado para fora (tam + 1 bytes) ou,
+// com fora == NULL, só referenciado
+Texto montarTexto(const char *s, size_t tam, char *fora)
+{
+    Texto t;
+    memset(&t, 0, sizeof(t));
+    t.tam = (uint32_t)tam;
+    if (tam <= TAM_TEXTO_CURTO)
+    {
+        memcpy((char *)&t + offsetof(Texto, prefixo), s, tam);
+        return t;
+    }
+    memcpy(t.prefixo, s, sizeof(t.prefixo));
+    if (fora)
+    {
+        memcpy(fora, s, tam);
+        fora[tam] = '\0';
+        s = fora;
+    }
+    t.longo = s;
+    return t;
+}
+
+// Texto que aponta para s se for longo: s precisa viver mais que ele
+Texto referenciarTexto(const char *s)
+{
+    return montarTexto(s, strlen(s), NULL);
+}
+
+// Texto com o longo copiado para a arena
+Texto guardarTexto(Arena *a, const char *s)
+{
+    size_t tam = strlen(s);
+    return montarTexto(s, tam, tam > TAM_TEXTO_CURTO ? reservarArena(a, tam + 1, 1) : NULL);
+}
+
+// String C inteira copiada para a arena (para quem guarda const char *)
+const char *guardarString(Arena *a, const char *s)
+{
+    size_t tam = strlen(s) + 1;
+    return memcpy(reservarArena(a, tam, 1), s, tam);
+}
+
+// ---------------------------------
+// Normalização de pistas
+// ---------------------------------
+// Forma canônica usada como chave: ASCII em minúsculas, acentos do Latin-1
+// (UTF-8 C3 xx) trocados pela letra base, brancos (e NBSP) colapsados num
+// espaço só e aparados nas pontas. O resultado nunca é maior que a entrada.
+// O SIMD resolve o trecho de cada bloco até o primeiro byte >= 0x80 ou branco
+// repetido; só esse byte (ou par UTF-8) passa pelo caminho escalar.
+
+// Letra base do segundo byte de C3 80..C3 BF; 0 mantém os dois bytes
+static const char semAcento[64] =
+    "aaaaaa\0ceeeeiiii"
+    "dnooooo\0ouuuuy\0\0"
+    "aaaaaa\0ceeeeiiii"
+    "dnooooo\0ouuuuy\0y";
+
+// Normaliza s[i..fim) (pode passar de fim pelo segundo byte de um par UTF-8).
+// espaco diz se o último byte escrito foi espaço (ou se nada foi escrito).
+static size_t normalizarTrecho(const unsigned char *s, size_t i, size_t fim, size_t tam, char *d, size_t *o, int *espaco)
+{
+    while (i < fim)
+    {
+        unsigned char c = s[i];
+        int nbsp = c == 0xC2 && i + 1 < tam && s[i + 1] == 0xA0;
+        if (c == ' ' || (c >= '\t' && c <= '\r') || nbsp)
+        {
+            if (!*espaco)
+                d[(*o)++] = ' ';
+            *espaco = 1;
+            i += nbsp ? 2 : 1;
+            continue;
+        }
+        *espaco = 0;
+        if (c == 0xC3 && i + 1 < tam && s[i + 1] >= 0x80 && s[i + 1] <= 0xBF)
+        {
+            unsigned char seg = s[i + 1];
+            if (semAcento[seg - 0x80])
+                d[(*o)++] = semAcento[seg - 0x80];
+            else
+            {
+                // Æ Þ viram æ þ; × ß ÷ ficam
+                d[(*o)++] = (char)c;
+                d[(*o)++] = (char)(seg <= 0x9E && seg != 0x97 ? seg + 0x20 : seg);
+            }
+            i += 2;
+            continue;
+        }
+        d[(*o)++] = (char)(c >= 'A' && c <= 'Z' ? c + 0x20 : c);
+        i++;
+    }
+    return i;
+}
+
+#if defined(__AVX2__)
+#define LARGURA_NORMALIZACAO 32
+typedef __m256i VetorTexto;
+#define CARREGAR_VETOR(p) _mm256_loadu_si256((const __m256i *)(p))
+#define GUARDAR_VETOR(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#define REPETIR_BYTE(c) _mm256_set1_epi8((char)(c))
+#define MAIOR_BYTE(a, b) _mm256_cmpgt_epi8(a, b)
+#define IGUAL_BYTE(a, b) _mm256_cmpeq_epi8(a, b)
+#define E_VETOR(a, b) _mm256_and_si256(a, b)
+#define OU_VETOR(a, b) _mm256_or_si256(a, b)
+#define SOMAR_BYTE(a, b) _mm256_add_epi8(a, b)
+#define ESCOLHER_BYTE(a, b, m) _mm256_blendv_epi8(a, b, m)
+#define MASCARA_VETOR(v) (uint32_t) _mm256_movemask_epi8(v)
+#elif defined(__SSE2__)
+#define LARGURA_NORMALIZACAO 16
+typedef __m128i VetorTexto;
+#define CARREGAR_VETOR(p) _mm_loadu_si128((const __m128i *)(p))
+#define GUARDAR_VETOR(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define REPETIR_BYTE(c) _mm_set1_epi8((char)(c))
+#define MAIOR_BYTE(a, b) _mm_cmpgt_epi8(a, b)
+#define IGUAL_BYTE(a, b) _mm_cmpeq_epi8(a, b)
+#define E_VETOR(a, b) _mm_and_si128(a, b)
+#define OU_VETOR(a, b) _mm_or_si128(a, b)
+#define SOMAR_BYTE(a, b) _mm_add_epi8(a, b)
+#define ESCOLHER_BYTE(a, b, m) _mm_or_si128(_mm_andnot_si128(m, a), _mm_and_si128(m, b))
+#define MASCARA_VETOR(v) (uint32_t) _mm_movemask_epi8(v)
+#endif
+
+#ifdef LARGURA_NORMALIZACAO
+// Um bloco de uma vez: minúsculas por faixa e brancos trocados por ' '. O
+// vetor é gravado inteiro, mas só vale até o primeiro byte >= 0x80 ou branco
+// repetido; devolve quantos bytes valem (LARGURA_NORMALIZACAO se todos).
+static inline int normalizarBloco(const unsigned char *s, char *d, int *espaco)
+{
+    VetorTexto v = CARREGAR_VETOR(s);
+    // bytes altos são negativos na comparação com sinal: não caem em faixa nenhuma
+    VetorTexto branco = OU_VETOR(IGUAL_BYTE(v, REPETIR_BYTE(' ')),
+                                 E_VETOR(MAIOR_BYTE(v, REPETIR_BYTE('\t' - 1)), MAIOR_BYTE(REPETIR_BYTE('\r' + 1), v)));
+    uint32_t b = MASCARA_VETOR(branco);
+    uint32_t parada = MASCARA_VETOR(v) | (b & ((b << 1) | (uint32_t)*espaco));
+    VetorTexto maiuscula = E_VETOR(MAIOR_BYTE(v, REPETIR_BYTE('A' - 1)), MAIOR_BYTE(REPETIR_BYTE('Z' + 1), v));
+    v = SOMAR_BYTE(v, E_VETOR(maiuscula, REPETIR_BYTE(0x20)));
+    GUARDAR_VETOR(d, ESCOLHER_BYTE(v, REPETIR_BYTE(' '), branco));
+    int feitos = parada ? __builtin_ctz(parada) : LARGURA_NORMALIZACAO;
+    if (feitos > 0)
+        *espaco = (int)((b >> (feitos - 1)) & 1);
+    return feitos;
+}
+#endif
+
+// Escreve a forma normalizada de pista[0..tam) em destino (tam + 1 bytes
+// bastam) e devolve o tamanho dela
+size_t normalizarPista(const char *pista, size_t tam, char *destino)
+{
+    const unsigned char *s = (const unsigned char *)pista;
+    size_t i = 0, o = 0;
+    int espaco = 1; // brancos do início somem
+#ifdef LARGURA_NORMALIZACAO
+    // o <= i sempre, então o bloco gravado cabe em destino
+    while (i + LARGURA_NORMALIZACAO <= tam)
+    {
+        int feitos = normalizarBloco(s + i, destino + o, &espaco);
+        i += (size_t)feitos;
+        o += (size_t)feitos;
+        if (feitos < LARGURA_NORMALIZACAO)
+            i = normalizarTrecho(s, i, i + 1, tam, destino, &o, &espaco);
+    }
+#endif
+    normalizarTrecho(s, i, tam, tam, destino, &o, &espaco);
+    if (espaco && o > 0)
+        o--;
+    destino[o] = '\0';
+    return o;
+}
+
+// Mesma saída, só pelo caminho escalar (referência do benchmark)
+static size_t normalizarPistaEscalar(const char *pista, size_t tam, char *destino)
+{
+    size_t o = 0;
+    int espaco = 1;
+    normalizarTrecho((const unsigned char *)pista, 0, tam, tam, destino, &o, &espaco);
+    if (espaco && o > 0)
+        o--;
+    destino[o] = '\0';
+    return o;
+}
+
+// Primeiros 8 bytes em big-endian, completados com zero: comparar dois
+// prefixos como inteiros dá a mesma ordem que strcmp nesses bytes
+static inline uint64_t prefixoChave(const char *s, size_t tam)
+{
+    uint64_t v = 0;
+    memcpy(&v, s, tam < 8 ? tam : 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// Chave de uma pista já normalizada em texto[0..tam)
+ChavePista montarChave(const char *texto, size_t tam)
+{
+    return (ChavePista){prefixoChave(texto, tam), texto, tam};
+}
+
+// Ordem de strcmp entre chaves normalizadas: prefixo de 64 bits primeiro,
+// depois blocos de 16 bytes a partir do oitavo
+int compararChaves(const ChavePista *a, const ChavePista *b)
+{
+    if (a->prefixo != b->prefixo)
+        return a->prefixo < b->prefixo ? -1 : 1;
+    size_t m = a->tam < b->tam ? a->tam : b->tam, k = 8;
+#ifdef __SSE2__
+    for (; k + 16 <= m; k += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a->texto + k));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b->texto + k));
+        unsigned diferentes = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xFFFFu;
+        if (diferentes)
+        {
+            k += (size_t)__builtin_ctz(diferentes);
+            return (unsigned char)a->texto[k] - (unsigned char)b->texto[k];
+        }
+    }
+#endif
+    for (; k < m; ++k)
+        if (a->texto[k] != b->texto[k])
+            return (unsigned char)a->texto[k] - (unsigned char)b->texto[k];
+    return (a->tam > b->tam) - (a->tam < b->tam);
+}
+
+// Normaliza pista em local (cap bytes) ou, se não couber, num buffer novo
+// devolvido em *alocado (o chamador libera)
+ChavePista chaveDaPista(const char *pista, char *local, size_t cap, char **alocado)
+{
+    size_t tam = strlen(pista);
+    char *destino = local;
+    *alocado = NULL;
+    if (tam + 1 > cap)
+    {
+        destino = *alocado = malloc(tam + 1);
+        if (destino == NULL)
+        {
+            printf("Erro ao alocar memória para normalizar pista.\n");
+            exit(1);
+        }
+    }
+    return montarChave(destino, normalizarPista(pista, tam, destino));
+}
+
 // ---------------------------------
 // Funções da Mansão e criação de cômodos
 // ---------------------------------
 
-// Cria um novo cômodo
+// Cria um novo cômodo. O nome longo vai no fim da mesma alocação; a pista
+// é só referenciada (vem da base, que vive mais que a mansão).
 Comodo *criarComodo(const char *nome, const char *pista)
 {
-    Comodo *c = malloc(sizeof(Comodo));
+    size_t tam = strlen(nome);
+    Comodo *c = alocarContado(MEM_COMODOS, 1, sizeof(Comodo) + extraTexto(tam));
     if (c == NULL)
     {
         printf("Erro ao alocar memória para cômodo.\n");
         exit(1);
     }
-    strncpy(c->nome, nome, sizeof(c->nome) - 1);
-    c->nome[sizeof(c->nome) - 1] = '\0';
-    if (pista)
-        strncpy(c->pista, pista, sizeof(c->pista) - 1);
-    else
-        c->pista[0] = '\0';
-    c->pista[sizeof(c->pista) - 1] = '\0';
+    c->nome = montarTexto(nome, tam, (char *)(c + 1));
+    c->pista = referenciarTexto(pista ? pista : "");
     c->esquerda = c->direita = NULL;
     return c;
 }
@@ -252,7 +1311,7 @@ void liberarArvore(Comodo *no)
         return;
     liberarArvore(no->esquerda);
     liberarArvore(no->direita);
-    free(no);
+    liberarContado(MEM_COMODOS, no, 1, sizeof(Comodo) + extraTexto(no->nome.tam));
 }
 
 // ---------------------------------
@@ -261,19 +1320,18 @@ void liberarArvore(Comodo *no)
 void distribuirPistas(Comodo *comodos[], int qtdComodos, LigacaoPistaSuspeito base[], int totalBase)
 {
     // Distribui pistas aleatoriamente entre os cômodos
-    // (nem todos recebem pista)
+    // (nem todos recebem pista); o texto longo continua em base[]
     for (int i = 0; i < qtdComodos; i++)
     {
         // 90% de chance de ter pista
         if ((rand() % 100) < 90)
         {
             int id = rand() % totalBase;
-            strncpy(comodos[i]->pista, base[id].pista, sizeof(comodos[i]->pista) - 1);
-            comodos[i]->pista[sizeof(comodos[i]->pista) - 1] = '\0';
+            comodos[i]->pista = referenciarTexto(base[id].pista);
         }
         else
         {
-            comodos[i]->pista[0] = '\0';
+            comodos[i]->pista = referenciarTexto("");
         }
     }
 }
@@ -281,42 +1339,105 @@ void distribuirPistas(Comodo *comodos[], int qtdComodos, LigacaoPistaSuspeito ba
 // ---------------------------------
 // BST (pistas encontradas)
 // ---------------------------------
-// Cria um novo nó da BST
-NoBST *criarNoBST(const char *pista)
+// A ordem é a da pista normalizada. O nó é dono dos seus textos: o que não
+// cabe inline vai no fim da mesma alocação, primeiro a pista (para exibição)
+// e depois a chave, que só ocupa espaço se for longa e diferente da pista.
+// Quem insere pode liberar a string logo depois.
+static size_t tamanhoNoBST(const NoBST *n)
+{
+    size_t tam = sizeof(NoBST) + extraTexto(n->pista.tam);
+    if (n->normalizada.tam > TAM_TEXTO_CURTO && n->normalizada.longo != lerTexto(&n->pista))
+        tam += extraTexto(n->normalizada.tam);
+    return tam;
+}
+
+// Cria o nó de uma pista cuja chave normalizada já foi calculada
+static NoBST *criarNoBSTChave(const char *pista, const ChavePista *k)
 {
-    NoBST *n = malloc(sizeof(NoBST));
+    size_t tam = strlen(pista);
+    int mesma = k->tam == tam && memcmp(k->texto, pista, tam) == 0;
+    size_t extraPista = extraTexto(tam);
+    NoBST *n = alocarContado(MEM_PISTAS, 1, sizeof(NoBST) + extraPista + (mesma ? 0 : extraTexto(k->tam)));
     if (n == NULL)
     {
         printf("Erro ao alocar memória para nó BST.\n");
         exit(1);
     }
-    strncpy(n->pista, pista, sizeof(n->pista) - 1);
-    n->pista[sizeof(n->pista) - 1] = '\0';
+    char *fora = (char *)(n + 1);
+    n->pista = montarTexto(pista, tam, extraPista ? fora : NULL);
+    n->normalizada = mesma ? n->pista : montarTexto(k->texto, k->tam, fora + extraPista);
+    n->chave = k->prefixo;
     n->esquerda = n->direita = NULL;
     return n;
 }
-// Busca uma pista na BST; retorna 1 se encontrada, 0 caso contrário
-int buscarBST(NoBST *raiz, const char *pista)
+// Cria um novo nó da BST
+NoBST *criarNoBST(const char *pista)
 {
-    if (raiz == NULL)
-        return 0;
-    int cmp = strcmp(pista, raiz->pista);
-    if (cmp == 0)
-        return 1;
-    if (cmp < 0)
-        return buscarBST(raiz->esquerda, pista);
-    return buscarBST(raiz->direita, pista);
+    char local[128], *alocado;
+    ChavePista k = chaveDaPista(pista, local, sizeof(local), &alocado);
+    NoBST *n = criarNoBSTChave(pista, &k);
+    free(alocado);
+    return n;
+}
+// Chave contra nó: quase sempre decide no prefixo, sem tocar no texto
+static inline int compararChaveNo(const ChavePista *k, const NoBST *n)
+{
+    if (k->prefixo != n->chave)
+        return k->prefixo < n->chave ? -1 : 1;
+    ChavePista outra = {n->chave, lerTexto(&n->normalizada), n->normalizada.tam};
+    return compararChaves(k, &outra);
+}
+// Busca uma pista na BST; retorna 1 se encontrada, 0 caso contrário
+// (iterativa para medir a profundidade e não estourar a pilha em árvores degeneradas)
+int buscarBST(NoBST *raiz, const char *pista)
+{
+    EST_TEMPO(t0);
+    char local[128], *alocado;
+    ChavePista k = chaveDaPista(pista, local, sizeof(local), &alocado);
+    int prof = 0;
+    int achou = 0;
+    while (raiz != NULL)
+    {
+        int cmp = compararChaveNo(&k, raiz);
+        if (cmp == 0)
+        {
+            achou = 1;
+            break;
+        }
+        raiz = cmp < 0 ? raiz->esquerda : raiz->direita;
+        prof++;
+    }
+    free(alocado);
+    EST_INC(buscasBST);
+    EST_HIST(profBuscaBST, prof);
+    EST_LATENCIA(latBuscaBST, t0);
+    (void)prof;
+    return achou;
 }
-// Insere uma pista na BST
+// Insere uma pista na BST (duplicatas, inclusive as que só diferem na
+// normalização, são ignoradas; fica o texto da primeira)
 NoBST *inserirBST(NoBST *raiz, const char *pista)
 {
-    if (raiz == NULL)
-        return criarNoBST(pista);
-    int cmp = strcmp(pista, raiz->pista);
-    if (cmp < 0)
-        raiz->esquerda = inserirBST(raiz->esquerda, pista);
-    else if (cmp > 0)
-        raiz->direita = inserirBST(raiz->direita, pista);
+    EST_TEMPO(t0);
+    char local[128], *alocado;
+    ChavePista k = chaveDaPista(pista, local, sizeof(local), &alocado);
+    NoBST **pos = &raiz;
+    int prof = 0;
+    while (*pos != NULL)
+    {
+        int cmp = compararChaveNo(&k, *pos);
+        if (cmp == 0)
+            break;
+        pos = cmp < 0 ? &(*pos)->esquerda : &(*pos)->direita;
+        prof++;
+    }
+    if (*pos == NULL && k.tam > 0)
+        *pos = criarNoBSTChave(pista, &k);
+    free(alocado);
+    EST_INC(insercoesBST);
+    EST_HIST(profInsercaoBST, prof);
+    EST_LATENCIA(latInsercaoBST, t0);
+    (void)prof;
     return raiz;
 }
 // Mostra todas as pistas na BST (ordem)
@@ -325,7 +1446,7 @@ void mostrarPistasBST(NoBST *raiz)
     if (raiz == NULL)
         return;
     mostrarPistasBST(raiz->esquerda);
-    printf(" - %s\n", raiz->pista);
+    printf(" - %s\n", lerTexto(&raiz->pista));
     mostrarPistasBST(raiz->direita);
 }
 // Libera memória da BST
@@ -335,7 +1456,158 @@ void liberarBST(NoBST *raiz)
         return;
     liberarBST(raiz->esquerda);
     liberarBST(raiz->direita);
-    free(raiz);
+    liberarContado(MEM_PISTAS, raiz, 1, tamanhoNoBST(raiz));
+}
+
+// ---------------------------------
+// Consultas em lote intercaladas
+// ---------------------------------
+// Numa árvore maior que a cache cada passo de uma busca espera a memória, e o
+// passo seguinte depende dele. Com várias consultas em voo, cada uma guarda
+// onde parou (uma corrotina feita à mão): a rodada pede o próximo nó de uma
+// (prefetch) e passa à outra, e quando volta o nó já chegou.
+
+// Uma busca na BST parada entre dois passos
+typedef struct
+{
+    ChavePista k;
+    const NoBST *no;
+    size_t consulta;
+    int prof;
+    char *alocado;
+    char local[96];
+} BuscaEmVoo;
+
+// Começa a próxima consulta na vaga; 0 se não há mais consultas
+static int iniciarBuscaEmVoo(BuscaEmVoo *b, const NoBST *raiz, const char *const pistas[], size_t *proxima, size_t n)
+{
+    if (*proxima >= n)
+        return 0;
+    b->consulta = (*proxima)++;
+    b->k = chaveDaPista(pistas[b->consulta], b->local, sizeof(b->local), &b->alocado);
+    b->no = raiz;
+    b->prof = 0;
+    return 1;
+}
+
+// Como buscarBST para cada pista (achou[i] = 0 ou 1), com até grupo buscas intercaladas
+static void buscarBSTIntercalado(const NoBST *raiz, const char *const pistas[], size_t n, int achou[], int grupo)
+{
+    BuscaEmVoo voo[LOTE_INTERCALADO_MAX];
+    if (grupo < 1)
+        grupo = 1;
+    if (grupo > LOTE_INTERCALADO_MAX)
+        grupo = LOTE_INTERCALADO_MAX;
+    size_t proxima = 0;
+    int ativas = 0;
+    for (int s = 0; s < grupo && iniciarBuscaEmVoo(&voo[ativas], raiz, pistas, &proxima, n); ++s)
+        ativas++;
+    while (ativas > 0)
+    {
+        for (int s = 0; s < ativas;)
+        {
+            BuscaEmVoo *b = &voo[s];
+            int cmp = b->no != NULL ? compararChaveNo(&b->k, b->no) : 1;
+            if (b->no != NULL && cmp != 0)
+            {
+                b->no = cmp < 0 ? b->no->esquerda : b->no->direita;
+                b->prof++;
+                __builtin_prefetch(b->no);
+                ++s;
+                continue;
+            }
+            // terminou: grava, e a vaga recebe a próxima consulta (ou a última vaga)
+            achou[b->consulta] = b->no != NULL;
+            free(b->alocado);
+            EST_INC(buscasBST);
+            EST_HIST(profBuscaBST, b->prof);
+            if (!iniciarBuscaEmVoo(b, raiz, pistas, &proxima, n))
+            {
+                *b = voo[--ativas];
+                if (b->alocado == NULL)
+                    b->k.texto = b->local; // a chave normalizada veio junto no local da outra vaga
+            }
+            else
+                ++s;
+        }
+    }
+}
+
+// n buscas na BST de uma vez (achou[i] como buscarBST(raiz, pistas[i]))
+void buscarBSTEmLote(NoBST *raiz, const char *const pistas[], size_t n, int achou[])
+{
+    buscarBSTIntercalado(raiz, pistas, n, achou, LOTE_INTERCALADO);
+}
+
+// Cômodo no fim do caminho de índice de heap indice (bits de indice+1 abaixo
+// do mais alto: 0 = esquerda, 1 = direita); NULL se a mansão não chega lá
+const Comodo *comodoDoCaminho(const Comodo *hall, uint64_t indice)
+{
+    uint64_t k = indice + 1;
+    const Comodo *c = hall;
+    for (int b = 62 - __builtin_clzll(k); b >= 0 && c != NULL; --b)
+        c = (k >> b) & 1 ? c->direita : c->esquerda;
+    return c;
+}
+
+// Um caminho pela mansão parado entre dois passos
+typedef struct
+{
+    const Comodo *c;
+    uint64_t k;
+    int bit;
+    size_t consulta;
+} CaminhoEmVoo;
+
+static int iniciarCaminhoEmVoo(CaminhoEmVoo *w, const Comodo *hall, const uint64_t indices[], size_t *proximo, size_t n)
+{
+    if (*proximo >= n)
+        return 0;
+    w->consulta = (*proximo)++;
+    w->k = indices[w->consulta] + 1;
+    w->bit = 62 - __builtin_clzll(w->k);
+    w->c = hall;
+    return 1;
+}
+
+// Como comodoDoCaminho para cada índice, com até grupo caminhos intercalados
+static void comodosDosCaminhosIntercalado(const Comodo *hall, const uint64_t indices[], size_t n, const Comodo *saida[], int grupo)
+{
+    CaminhoEmVoo voo[LOTE_INTERCALADO_MAX];
+    if (grupo < 1)
+        grupo = 1;
+    if (grupo > LOTE_INTERCALADO_MAX)
+        grupo = LOTE_INTERCALADO_MAX;
+    size_t proximo = 0;
+    int ativos = 0;
+    for (int s = 0; s < grupo && iniciarCaminhoEmVoo(&voo[ativos], hall, indices, &proximo, n); ++s)
+        ativos++;
+    while (ativos > 0)
+    {
+        for (int s = 0; s < ativos;)
+        {
+            CaminhoEmVoo *w = &voo[s];
+            if (w->bit >= 0 && w->c != NULL)
+            {
+                w->c = (w->k >> w->bit) & 1 ? w->c->direita : w->c->esquerda;
+                w->bit--;
+                __builtin_prefetch(w->c);
+                ++s;
+                continue;
+            }
+            saida[w->consulta] = w->c;
+            if (!iniciarCaminhoEmVoo(w, hall, indices, &proximo, n))
+                *w = voo[--ativos];
+            else
+                ++s;
+        }
+    }
+}
+
+// n caminhos de uma vez (saida[i] = comodoDoCaminho(hall, indices[i]))
+void comodosDosCaminhos(const Comodo *hall, const uint64_t indices[], size_t n, const Comodo *saida[])
+{
+    comodosDosCaminhosIntercalado(hall, indices, n, saida, LOTE_INTERCALADO);
 }
 
 // ---------------------------------
@@ -344,11 +1616,18 @@ void liberarBST(NoBST *raiz)
 // Função de hash
 int funcao_hash(const char *chave)
 {
+    EST_TEMPO(t0);
     int soma = 0;
     for (int i = 0; chave[i] != '\0'; i++)
     {
         soma += (unsigned char)chave[i];
     }
+#ifdef ESTATISTICAS
+    uint64_t custo = EST_RELOGIO() - t0;
+    estLocal.chamadasHash++;
+    estLocal.tempoHash += custo;
+    estLocal.latHash[baldeLog2(custo)]++;
+#endif
     return soma % TAM_HASH;
 }
 // Inicializa a tabela hash
@@ -360,17 +1639,29 @@ void inicializarHashPistas(HashPistas *hash)
 // Insere uma pista e seu suspeito associado na tabela hash
 void inserirHashPista(HashPistas *hash, const char *pista, const char *suspeito)
 {
-    int idx = funcao_hash(pista);
-    HashNo *novo = malloc(sizeof(HashNo));
+    inserirHashPistaIdx(hash, funcao_hash(pista), pista, suspeito);
+}
+// Insere no balde idx já calculado (usado também pela inserção em lote)
+void inserirHashPistaIdx(HashPistas *hash, int idx, const char *pista, const char *suspeito)
+{
+#ifdef ESTATISTICAS
+    int cadeia = 0;
+    for (HashNo *h = hash->tabela[idx]; h; h = h->proximo)
+        cadeia++;
+    EST_INC(insercoesHash);
+    EST_HIST(cadeiaHash, cadeia);
+#endif
+    // textos longos no fim da mesma alocação
+    size_t tamPista = strlen(pista), tamSuspeito = strlen(suspeito);
+    HashNo *novo = alocarContado(MEM_HASH, 1, sizeof(HashNo) + extraTexto(tamPista) + extraTexto(tamSuspeito));
     if (novo == NULL)
     {
         printf("Erro ao alocar memória para nó da tabela hash.\n");
         exit(1);
     }
-    strncpy(novo->pista, pista, sizeof(novo->pista) - 1);
-    novo->pista[sizeof(novo->pista) - 1] = '\0';
-    strncpy(novo->suspeito, suspeito, sizeof(novo->suspeito) - 1);
-    novo->suspeito[sizeof(novo->suspeito) - 1] = '\0';
+    char *fora = (char *)(novo + 1);
+    novo->pista = montarTexto(pista, tamPista, fora);
+    novo->suspeito = montarTexto(suspeito, tamSuspeito, fora + extraTexto(tamPista));
     novo->proximo = hash->tabela[idx];
     hash->tabela[idx] = novo;
 }
@@ -382,7 +1673,7 @@ int contarPistasPorSuspeito(HashPistas *hash, const char *suspeito)
     for (int i = 0; i < TAM_HASH; ++i)
     {
         for (HashNo *h = hash->tabela[i]; h; h = h->proximo)
-            if (strcmp(h->suspeito, suspeito) == 0)
+            if (strcmp(lerTexto(&h->suspeito), suspeito) == 0)
                 ++cont;
     }
     return cont;
@@ -395,14 +1686,14 @@ void listarPistasPorSuspeito(HashPistas *hash, const char *suspeito)
     {
         for (HashNo *h = hash->tabela[i]; h; h = h->proximo)
         {
-            if (strcmp(h->suspeito, suspeito) == 0)
+            if (strcmp(lerTexto(&h->suspeito), suspeito) == 0)
             {
                 if (encontrou == 0)
                 {
                     printf("\nPistas associadas a %s:\n", suspeito);
                     encontrou = 1;
                 }
-                printf(" - %s\n", h->pista);
+                printf(" - %s\n", lerTexto(&h->pista));
             }
         }
     }
@@ -422,7 +1713,7 @@ void mostrarHashPistas(HashPistas *hash)
                 printf("\n");
                 any = 1;
             }
-            printf("Pista: %-40s -> Suspeito: %s\n", h->pista, h->suspeito);
+            printf("Pista: %-40s -> Suspeito: %s\n", lerTexto(&h->pista), lerTexto(&h->suspeito));
         }
     }
     if (any == 0)
@@ -437,223 +1728,7811 @@ void liberarHashPistas(HashPistas *hash)
         while (h)
         {
             HashNo *tmp = h->proximo;
-            free(h);
+            liberarContado(MEM_HASH, h, 1, sizeof(HashNo) + extraTexto(h->pista.tam) + extraTexto(h->suspeito.tam));
             h = tmp;
         }
         hash->tabela[i] = NULL;
     }
 }
+// Procura uma pista na hash; devolve o suspeito ou NULL
+const char *buscarHashPista(HashPistas *hash, const char *pista)
+{
+    for (HashNo *h = hash->tabela[funcao_hash(pista)]; h; h = h->proximo)
+        if (strcmp(lerTexto(&h->pista), pista) == 0)
+            return lerTexto(&h->suspeito);
+    return NULL;
+}
 
 // ---------------------------------
-// Trim utility
+// Hash perfeito mínimo (CHD - compress, hash and displace)
 // ---------------------------------
-void trim_newline(char *s) // remove \n e \r
+// Construção em tempo linear: as chaves são distribuídas em baldes de ~LAMBDA_CHD,
+// os baldes são tratados do maior para o menor e cada um procura o menor
+// deslocamento d (16 bits) que leva todas as suas chaves a posições livres.
+// Cada d dá um espalhamento independente; com 1% das posições livres, um balde
+// de uma chave precisa em média de ~100 tentativas das 65536 disponíveis.
+
+static uint64_t hash64Semente(const char *s, uint64_t semente)
 {
-    if (!s)
-        return;
-    s[strcspn(s, "\r\n")] = '\0';
+    uint64_t h = 1469598103934665603ull ^ semente;
+    for (; *s; ++s)
+    {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ull;
+    }
+    return misturar64(h);
 }
 
-// ---------------------------------
-// Menu de navegação (coleção de pistas)
-// ---------------------------------
-void menu(Comodo *raiz, NoBST **pistasBST, HashPistas *hash, LigacaoPistaSuspeito base[], int totalBase, char *suspeitos[], int totalSuspeitos)
+static inline uint32_t posicaoIntermediaria(const HashPerfeito *hp, uint64_t h, uint32_t d)
 {
-    Comodo *atual = raiz;
-    char entrada[64];
+    return (uint32_t)(misturar64(h ^ ((uint64_t)d * 0x9E3779B97F4A7C15ull)) % hp->m);
+}
+
+static inline uint32_t baldeDaChave(const HashPerfeito *hp, uint64_t h)
+{
+    return (uint32_t)((h >> 32) % hp->baldes);
+}
+
+static inline uint32_t rankOcupado(const HashPerfeito *hp, uint32_t pos)
+{
+    uint32_t palavra = pos >> 6;
+    uint32_t r = hp->rank[palavra >> 3];
+    for (uint32_t w = palavra & ~7u; w < palavra; ++w)
+        r += (uint32_t)__builtin_popcountll(hp->ocupado[w]);
+    uint64_t resto = hp->ocupado[palavra] & ((1ull << (pos & 63)) - 1);
+    return r + (uint32_t)__builtin_popcountll(resto);
+}
 
-    while (1)
+// Monta o hash perfeito para chaves[0..n). posicao[i] recebe a posição final
+// da chave i, ou -1 se ela repete uma chave anterior (a primeira vale).
+// Retorna 0 em sucesso, 1 se nenhuma semente funcionou.
+int construirHashPerfeito(HashPerfeito *hp, const char *const chaves[], uint32_t n, int32_t posicao[])
+{
+    memset(hp, 0, sizeof(*hp));
+    uint32_t m = (uint32_t)(n / CARGA_CHD) + 2;
+    hp->m = m;
+    hp->baldes = n / LAMBDA_CHD + 1;
+
+    size_t palavras = (size_t)m / 64 + 1;
+    uint64_t *h = malloc((size_t)n * sizeof(*h) + 1);
+    uint32_t *inicio = malloc(((size_t)hp->baldes + 1) * sizeof(*inicio));
+    uint32_t *cursor = malloc((size_t)hp->baldes * sizeof(*cursor));
+    uint32_t *ordem = malloc((size_t)n * sizeof(*ordem) + 1);
+    uint32_t *porTamanho = malloc((size_t)hp->baldes * sizeof(*porTamanho));
+    uint32_t *posTmp = malloc((size_t)n * sizeof(*posTmp) + 1);
+    hp->deslocamento = alocarContado(MEM_CHD, 1, (size_t)hp->baldes * sizeof(*hp->deslocamento));
+    hp->ocupado = alocarContado(MEM_CHD, 1, palavras * sizeof(*hp->ocupado));
+    hp->rank = alocarContado(MEM_CHD, 1, (palavras / 8 + 1) * sizeof(*hp->rank));
+    if (!h || !inicio || !cursor || !ordem || !porTamanho || !posTmp || !hp->deslocamento || !hp->ocupado || !hp->rank)
     {
-        printf("\n===== Mapa da Mansão =====\n");
-        printf("Você está em: %s\n\n", atual->nome);
-        printf("e - Ir para esquerda  [%s]\n", atual->esquerda ? atual->esquerda->nome : "Nenhum");
-        printf("d - Ir para direita   [%s]\n", atual->direita ? atual->direita->nome : "Nenhum");
-        printf("s - Sair do mapa (Ir para o menu de suspeitos)\n");
-        printf("===========================\n");
-        printf("Escolha: ");
-        if (fgets(entrada, sizeof(entrada), stdin) == NULL)
-            break;
-        trim_newline(entrada);
-        if (strlen(entrada) == 0)
-            continue;
-        char c = entrada[0];
+        printf("Erro ao alocar memória para o hash perfeito.\n");
+        exit(1);
+    }
 
-        if (c == 's')
+    uint64_t geradorSemente = 0x5EED;
+    int ok = 0;
+    for (int tentativa = 0; tentativa < TENTATIVAS_CHD && !ok; ++tentativa)
+    {
+        hp->semente = aleatorio64(&geradorSemente);
+        memset(hp->ocupado, 0, palavras * sizeof(*hp->ocupado));
+
+        // agrupar chaves por balde (contagem estável: mantém a ordem original)
+        memset(inicio, 0, ((size_t)hp->baldes + 1) * sizeof(*inicio));
+        for (uint32_t i = 0; i < n; ++i)
         {
-            printf("Saindo do mapa.\n");
-            break;
+            h[i] = hash64Semente(chaves[i], hp->semente);
+            inicio[baldeDaChave(hp, h[i]) + 1]++;
         }
-
-        Comodo *dest = NULL; // ir para o cômodo escolhido
-        if (c == 'e')
-            dest = atual->esquerda;
-        else if (c == 'd')
-            dest = atual->direita;
-        else
+        uint32_t maior = 0;
+        for (uint32_t b = 0; b < hp->baldes; ++b)
         {
-            printf("Opção inválida.\n");
-            continue;
+            if (inicio[b + 1] > maior)
+                maior = inicio[b + 1];
+            inicio[b + 1] += inicio[b];
+            cursor[b] = inicio[b];
         }
+        for (uint32_t i = 0; i < n; ++i)
+            ordem[cursor[baldeDaChave(hp, h[i])]++] = i;
 
-        if (dest == NULL)
+        // baldes do maior para o menor (contagem por tamanho)
+        uint32_t *qtdTamanho = calloc((size_t)maior + 2, sizeof(*qtdTamanho));
+        if (qtdTamanho == NULL)
         {
-            printf("Não existe cômodo nessa direção.\n");
-            continue;
+            printf("Erro ao alocar memória para o hash perfeito.\n");
+            exit(1);
         }
+        for (uint32_t b = 0; b < hp->baldes; ++b)
+            qtdTamanho[maior - (inicio[b + 1] - inicio[b])]++;
+        for (uint32_t t = 1; t <= maior + 1; ++t)
+            qtdTamanho[t] += qtdTamanho[t - 1];
+        for (uint32_t b = hp->baldes; b-- > 0;)
+            porTamanho[--qtdTamanho[maior - (inicio[b + 1] - inicio[b])]] = b;
+        free(qtdTamanho);
 
-        atual = dest;
-        printf("Você entrou em: %s\n", atual->nome);
-
-        if (strlen(atual->pista) > 0)
+        ok = 1;
+        for (uint32_t k = 0; k < hp->baldes && ok; ++k)
         {
-            printf("Pista visível: %s\n", atual->pista);
+            uint32_t b = porTamanho[k];
+            uint32_t ini = inicio[b], fim = inicio[b + 1];
+            hp->deslocamento[b] = 0;
+            if (ini == fim)
+                continue;
 
-            // verificar se já coletamos esta pista (BST)
-            if (!buscarBST(*pistasBST, atual->pista))
+            // repetidas caem no mesmo balde com o mesmo hash: ficam fora (posição -1)
+            uint32_t qtd = 0;
+            for (uint32_t i = ini; i < fim; ++i)
             {
-                *pistasBST = inserirBST(*pistasBST, atual->pista);
+                uint32_t chave = ordem[i];
+                int repetida = 0;
+                for (uint32_t j = ini; j < i && !repetida; ++j)
+                    repetida = h[ordem[j]] == h[chave] && posicao[ordem[j]] != -1 && strcmp(chaves[ordem[j]], chaves[chave]) == 0;
+                posicao[chave] = repetida ? -1 : 0;
+                if (!repetida)
+                    ordem[ini + qtd++] = chave;
+            }
+            // ordem[ini..ini+qtd) agora só tem chaves distintas; o resto é descartado
+            for (uint32_t i = ini + qtd; i < fim; ++i)
+                ordem[i] = UINT32_MAX;
 
-                // Determinar suspeito de forma determinística, usando a base
-                const char *suspeito = "Desconhecido";
-                for (int i = 0; i < totalBase; ++i)
-                    if (strcmp(base[i].pista, atual->pista) == 0)
-                    {
-                        suspeito = base[i].suspeito;
+            uint32_t d = 0;
+            for (; d <= UINT16_MAX; ++d)
+            {
+                uint32_t colocadas = 0;
+                for (; colocadas < qtd; ++colocadas)
+                {
+                    uint32_t p = posicaoIntermediaria(hp, h[ordem[ini + colocadas]], d);
+                    if (hp->ocupado[p >> 6] & (1ull << (p & 63)))
                         break;
-                    }
-
-                // Inserir na hash a associação pista -> suspeito
-                inserirHashPista(hash, atual->pista, suspeito);
-
-                printf("Pista registrada. Suspeito associado: %s\n", suspeito);
+                    hp->ocupado[p >> 6] |= 1ull << (p & 63);
+                    posTmp[colocadas] = p;
+                }
+                if (colocadas == qtd)
+                    break;
+                for (uint32_t i = 0; i < colocadas; ++i) // desfaz a tentativa
+                    hp->ocupado[posTmp[i] >> 6] &= ~(1ull << (posTmp[i] & 63));
             }
+            if (d > UINT16_MAX)
+                ok = 0;
             else
-            {
-                printf("Você já registrou essa pista antes.\n");
-            }
+                hp->deslocamento[b] = (uint16_t)d;
         }
-        else
+    }
+
+    if (ok)
+    {
+        // rank: 1s antes de cada bloco de 8 palavras
+        uint32_t acumulado = 0;
+        for (size_t w = 0; w < palavras; ++w)
         {
-            printf("Sem pista visível aqui.\n");
+            if ((w & 7) == 0)
+                hp->rank[w >> 3] = acumulado;
+            acumulado += (uint32_t)__builtin_popcountll(hp->ocupado[w]);
         }
+        hp->n = acumulado;
+        for (uint32_t i = 0; i < n; ++i)
+            if (posicao[i] != -1)
+                posicao[i] = (int32_t)rankOcupado(hp, posicaoIntermediaria(hp, h[i], hp->deslocamento[baldeDaChave(hp, h[i])]));
     }
+
+    free(h);
+    free(inicio);
+    free(cursor);
+    free(ordem);
+    free(porTamanho);
+    free(posTmp);
+    if (!ok)
+        liberarHashPerfeito(hp);
+    return ok ? 0 : 1;
 }
 
-// ---------------------------------
-// Menu final: análises e acusação
-// ---------------------------------
-void menuFinal(HashPistas *hash, char *suspeitos[], int totalSuspeitos)
+// Posição (0..n-1) de uma chave: uma sondagem, sem laço nem desvio de colisão.
+// Para chaves fora do conjunto devolve uma posição qualquer; confira a chave guardada.
+uint32_t posicaoHashPerfeito(const HashPerfeito *hp, const char *chave)
 {
-    char entrada[80];
+    uint64_t h = hash64Semente(chave, hp->semente);
+    uint32_t p = posicaoIntermediaria(hp, h, hp->deslocamento[baldeDaChave(hp, h)]);
+    if (!(hp->ocupado[p >> 6] & (1ull << (p & 63))))
+        return 0; // posição livre: a chave certamente não está no conjunto
+    return rankOcupado(hp, p);
+}
 
-    while (1)
-    {
-        printf("\n===== MENU FINAL =====\n");
-        printf("1 - Ver suspeito(s) mais associado(s)\n");
-        printf("2 - Mostrar pistas por suspeito\n");
-        printf("3 - Acusar um suspeito\n");
-        printf("4 - Sair\n");
-        printf("======================\n");
-        printf("Escolha: ");
-        if (fgets(entrada, sizeof(entrada), stdin) == NULL)
-            break;
-        trim_newline(entrada);
-        if (strlen(entrada) == 0)
-            continue;
+// Tamanho do índice em bits (sem contar as chaves)
+size_t bitsHashPerfeito(const HashPerfeito *hp)
+{
+    size_t palavras = (size_t)hp->m / 64 + 1;
+    return (size_t)hp->baldes * 16 + palavras * 64 + (palavras / 8 + 1) * 32;
+}
+
+void liberarHashPerfeito(HashPerfeito *hp)
+{
+    size_t palavras = (size_t)hp->m / 64 + 1;
+    liberarContado(MEM_CHD, hp->deslocamento, 1, (size_t)hp->baldes * sizeof(*hp->deslocamento));
+    liberarContado(MEM_CHD, hp->ocupado, 1, palavras * sizeof(*hp->ocupado));
+    liberarContado(MEM_CHD, hp->rank, 1, (palavras / 8 + 1) * sizeof(*hp->rank));
+    memset(hp, 0, sizeof(*hp));
+}
 
-        if (entrada[0] == '1')
+// Tabela pista -> suspeito para bases fixas (casos só leitura). As strings
+// continuam na base, que precisa viver enquanto a tabela for usada.
+int construirHashPistasPerfeito(HashPistasPerfeito *t, LigacaoPistaSuspeito base[], int totalBase)
+{
+    const char **chaves = malloc((size_t)totalBase * sizeof(*chaves) + 1);
+    int32_t *posicao = malloc((size_t)totalBase * sizeof(*posicao) + 1);
+    if (chaves == NULL || posicao == NULL)
+    {
+        printf("Erro ao alocar memória para o hash perfeito.\n");
+        exit(1);
+    }
+    for (int i = 0; i < totalBase; ++i)
+        chaves[i] = base[i].pista;
+    int erro = construirHashPerfeito(&t->indice, chaves, (uint32_t)totalBase, posicao);
+    t->pista = NULL;
+    t->suspeito = NULL;
+    if (!erro)
+    {
+        t->pista = malloc((size_t)t->indice.n * sizeof(*t->pista) + 1);
+        t->suspeito = malloc((size_t)t->indice.n * sizeof(*t->suspeito) + 1);
+        if (t->pista == NULL || t->suspeito == NULL)
         {
-            // calcular contagens para cada suspeito da lista fornecida
-            int contagens[MAX_SUSPEITOS] = {0};
-            int totalRelevantes = 0;
-            for (int i = 0; i < totalSuspeitos; ++i)
+            printf("Erro ao alocar memória para o hash perfeito.\n");
+            exit(1);
+        }
+        for (int i = 0; i < totalBase; ++i)
+            if (posicao[i] >= 0)
             {
-                contagens[i] = contarPistasPorSuspeito(hash, suspeitos[i]);
-                if (contagens[i] > 0)
-                    totalRelevantes++;
+                t->pista[posicao[i]] = base[i].pista;
+                t->suspeito[posicao[i]] = base[i].suspeito;
             }
+    }
+    free(chaves);
+    free(posicao);
+    return erro;
+}
 
-            if (totalRelevantes == 0)
-            {
-                printf("Nenhuma pista coletada. Ninguém associado ainda.\n");
-                continue;
-            }
+// Suspeito da pista ou NULL; exatamente uma sondagem e um strcmp
+const char *buscarHashPistasPerfeito(const HashPistasPerfeito *t, const char *pista)
+{
+    if (t->indice.n == 0)
+        return NULL;
+    uint32_t p = posicaoHashPerfeito(&t->indice, pista);
+    return strcmp(t->pista[p], pista) == 0 ? t->suspeito[p] : NULL;
+}
 
-            // encontra maior contagem
-            int maior = 0;
-            for (int i = 1; i < totalSuspeitos; ++i)
-                if (contagens[i] > contagens[maior])
-                    maior = i;
+void liberarHashPistasPerfeito(HashPistasPerfeito *t)
+{
+    liberarHashPerfeito(&t->indice);
+    free(t->pista);
+    free(t->suspeito);
+    t->pista = NULL;
+    t->suspeito = NULL;
+}
 
-            // se há empate, mostramos todos com o mesmo valor
-            int maxVal = contagens[maior];
-            printf("\nSuspeito(s) mais associado(s) com %d pista(s):\n", maxVal);
-            for (int i = 0; i < totalSuspeitos; ++i)
-            {
-                if (contagens[i] == maxVal && maxVal > 0)
-                    printf(" - %s\n", suspeitos[i]);
-            }
-        }
-        else if (entrada[0] == '2')
-        {
-            // listar nomes para escolha
-            printf("\nEscolha um suspeito para ver suas pistas:\n");
-            for (int i = 0; i < totalSuspeitos; ++i)
-                printf(" %d) %s\n", i + 1, suspeitos[i]);
-            printf("Escolha (numero): ");
-            if (fgets(entrada, sizeof(entrada), stdin) == NULL)
-                break;
-            int escolha = atoi(entrada);
-            if (escolha >= 1 && escolha <= totalSuspeitos)
-            {
-                listarPistasPorSuspeito(hash, suspeitos[escolha - 1]);
-            }
-            else
-            {
-                printf("Escolha inválida.\n");
-            }
-        }
-        else if (entrada[0] == '3')
-        {
-            // mostrar lista de suspeitos
-            printf("\nLista de suspeitos:\n");
-            for (int i = 0; i < totalSuspeitos; ++i)
-                printf(" %d) %s\n", i + 1, suspeitos[i]);
+// ---------------------------------
+// Tabelas geradas (cenário padrão)
+// ---------------------------------
+// FNV-1a de 32 bits com semente
+uint32_t hashSemente(const char *s, uint32_t semente)
+{
+    uint32_t h = 2166136261u ^ semente;
+    for (; *s; ++s)
+    {
+        h ^= (unsigned char)*s;
+        h *= 16777619u;
+    }
+    return h;
+}
 
-            printf("Escolha um suspeito para acusar (numero): ");
-            if (fgets(entrada, sizeof(entrada), stdin) == NULL)
-                break;
-            int escolha = atoi(entrada);
-            if (escolha >= 1 && escolha <= totalSuspeitos)
-            {
-                const char *selecionado = suspeitos[escolha - 1];
-                int cont = contarPistasPorSuspeito(hash, selecionado);
+// FNV-1a de 64 bits acumulado; o '\0' entra para "ab"+"c" não valer "a"+"bc"
+static uint64_t acumularImpressao(uint64_t h, const char *s)
+{
+    do
+    {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ull;
+    } while (*s++);
+    return h;
+}
 
-                printf("\nVocê acusou: %s\n", selecionado);
-                printf("Pistas associadas a esse suspeito: %d\n", cont);
+// Índice de um cômodo no vetor todos[], ou -1 para NULL
+static int indiceComodo(Comodo *todos[], int qtd, const Comodo *c)
+{
+    for (int i = 0; i < qtd; ++i)
+        if (todos[i] == c)
+            return i;
+    return -1;
+}
 
-                if (cont >= 2)
-                {
-                    printf("Resultado: ACERTOU! Esse suspeito tem %d pistas associadas.\n", cont);
-                }
-                else
-                {
-                    printf("Resultado: ERROU. Esse suspeito não possui 2+ pistas associadas.\n");
-                }
-            }
-            else
-            {
-                printf("Escolha inválida.\n");
-            }
-        }
-        else if (entrada[0] == '4')
-        {
-            printf("Saindo do menu final.\n");
-            return;
-        }
+// Impressão digital de tudo que mestre_tabelas.h copia das fontes: nome e
+// filhos de cada cômodo de montarMansao (na ordem de criação), pista e
+// suspeito de cada ligação de basePadrao, as evidências secundárias com seus
+// pesos e a lista de suspeitos. gerar-tabelas
+// grava o valor no cabeçalho; conferir-tabelas refaz a conta (monta a mansão
+// com malloc, por isso não roda no início da partida).
+uint64_t impressaoCenarioPadrao(void)
+{
+    Comodo *todos[MAX_COMODOS];
+    int qtdComodos = 0;
+    Comodo *raiz = montarMansao(todos, &qtdComodos);
+    char num[32];
+    uint64_t h = 1469598103934665603ull;
+    for (int i = 0; i < qtdComodos; ++i)
+    {
+        snprintf(num, sizeof(num), "%d %d", indiceComodo(todos, qtdComodos, todos[i]->esquerda),
+                 indiceComodo(todos, qtdComodos, todos[i]->direita));
+        h = acumularImpressao(acumularImpressao(h, lerTexto(&todos[i]->nome)), num);
+    }
+    liberarArvore(raiz);
+    for (int i = 0; i < TOTAL_BASE_PADRAO; ++i)
+        h = acumularImpressao(acumularImpressao(h, basePadrao[i].pista), basePadrao[i].suspeito);
+    for (int i = 0; i < TOTAL_EXTRAS_PADRAO; ++i)
+    {
+        snprintf(num, sizeof(num), "%a", evidenciasExtrasPadrao[i].peso);
+        h = acumularImpressao(acumularImpressao(h, evidenciasExtrasPadrao[i].pista), evidenciasExtrasPadrao[i].suspeito);
+        h = acumularImpressao(h, num);
+    }
+    for (int k = 0; k < TOTAL_SUSPEITOS_PADRAO; ++k)
+        h = acumularImpressao(h, suspeitosPadrao[k]);
+    return h;
+}
+
+// 1 se mestre_tabelas.h corresponde às fontes: mesma impressão digital e o CHD
+// gerado acha cada pista no id gravado (pega uma mudança em hash64Semente ou
+// misturar64). Sem as tabelas não há o que conferir.
+int conferirTabelasGeradas(void)
+{
+#ifdef TABELAS_GERADAS
+    if (impressaoCenarioPadrao() != IMPRESSAO_CENARIO_GERADO)
+        return 0;
+    for (int i = 0; i < TOTAL_BASE_PADRAO; ++i)
+        if (idPistaDaBaseGerada[i] < 0 || idPistaRelacao(&relacaoGerada, basePadrao[i].pista) != idPistaDaBaseGerada[i])
+            return 0;
+    for (int i = 0; i < TOTAL_EXTRAS_PADRAO; ++i)
+        if (idPistaRelacao(&relacaoGerada, evidenciasExtrasPadrao[i].pista) < 0)
+            return 0;
+#endif
+    return 1;
+}
+
+#ifdef TABELAS_GERADAS
+// O sorteio de distribuirPistas (mesma sequência de rand(), cômodos na ordem de
+// montarMansao), gravado em pistaDe como id na relação: a mansão fica intocada
+void sortearPistasGeradas(int16_t pistaDe[])
+{
+    for (int i = 0; i < TOTAL_COMODOS_GERADOS; ++i)
+    {
+        int16_t p = -1;
+        if ((rand() % 100) < 90)
+            p = idPistaDaBaseGerada[rand() % TOTAL_BASE_GERADA];
+        pistaDe[ordemMontagemGerada[i]] = p;
+    }
+}
+#endif
+
+// Cenário padrão para uma partida (ou para o servidor). Com sobDemanda a
+// mansão é ela; senão é a do cenário, com as pistas sorteadas agora por rand().
+// O MundoJogo aponta para dentro de c: c não pode ser copiado.
+void montarCenarioPadrao(CenarioPadrao *c, MansaoSobDemanda *sobDemanda)
+{
+    memset(c, 0, sizeof(*c));
+#ifdef TABELAS_GERADAS
+    c->mundo.rel = &relacaoGerada;
+#else
+    // Pontuação: ligações da base (peso 1) + evidências secundárias
+    c->ligacoes = montarLigacoesPonderadas(basePadrao, TOTAL_BASE_PADRAO, evidenciasExtrasPadrao, TOTAL_EXTRAS_PADRAO);
+    construirRelacao(&c->relacao, c->ligacoes, TOTAL_BASE_PADRAO + TOTAL_EXTRAS_PADRAO, suspeitosPadrao, TOTAL_SUSPEITOS_PADRAO);
+    c->mundo.rel = &c->relacao;
+#endif
+    c->mundo.suspeitos = suspeitosPadrao;
+    c->mundo.totalSuspeitos = TOTAL_SUSPEITOS_PADRAO;
+    c->mundo.sobDemanda = sobDemanda;
+    if (sobDemanda != NULL)
+    {
+        c->mundo.raiz = &sobDemanda->hall->comodo;
+        return;
+    }
+#ifdef TABELAS_GERADAS
+    // estática, só leitura e já emitida em ordem vEB: nenhum malloc
+    sortearPistasGeradas(c->pistaDe);
+    c->mundo.raiz = c->mundo.comodos = &mansaoGerada[0];
+    c->mundo.pistaDe = c->pistaDe;
+#else
+    Comodo *todos[MAX_COMODOS];
+    int qtdComodos = 0;
+    Comodo *raiz = montarMansao(todos, &qtdComodos);
+    distribuirPistas(todos, qtdComodos, basePadrao, TOTAL_BASE_PADRAO);
+    // Daqui em diante a árvore só é lida: fica a cópia contígua em ordem vEB
+    c->congelada = congelarMansao(raiz, ORDEM_VEB);
+    liberarArvore(raiz);
+    c->mundo.raiz = c->congelada->comodos;
+#endif
+}
+
+void liberarCenarioPadrao(CenarioPadrao *c)
+{
+    liberarMansaoCongelada(c->congelada);
+    liberarRelacao(&c->relacao);
+    free(c->ligacoes);
+    memset(c, 0, sizeof(*c));
+}
+
+// Escreve uma string C entre aspas, escapando o necessário
+static void emitirTexto(FILE *saida, const char *s)
+{
+    fputc('"', saida);
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+            fputc('\\', saida);
+        fputc(*s, saida);
+    }
+    fputc('"', saida);
+}
+
+// Os n primeiros bytes de s como literal; bytes fora do ASCII em octal para
+// não partir um caractere UTF-8 entre dois literais
+static void emitirBytes(FILE *saida, const char *s, size_t n)
+{
+    fputc('"', saida);
+    for (size_t i = 0; i < n; ++i)
+    {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\')
+            fprintf(saida, "\\%c", c);
+        else if (c < 0x20 || c >= 0x80)
+            fprintf(saida, "\\%03o", c);
         else
-        {
-            printf("Opção inválida.\n");
-        }
+            fputc(c, saida);
     }
+    fputc('"', saida);
+}
+
+// Inicializador de um Texto: inline até TAM_TEXTO_CURTO, senão apontando para o literal
+static void emitirTextoCompacto(FILE *saida, const char *s)
+{
+    size_t tam = strlen(s);
+    fprintf(saida, "{%zu, ", tam);
+    emitirBytes(saida, s, tam < 4 ? tam : 4);
+    if (tam <= TAM_TEXTO_CURTO)
+    {
+        fprintf(saida, ", {.resto = ");
+        emitirBytes(saida, s + (tam < 4 ? tam : 4), tam < 4 ? 0 : tam - 4);
+    }
+    else
+    {
+        fprintf(saida, ", {.longo = ");
+        emitirTexto(saida, s);
+    }
+    fprintf(saida, "}}");
+}
+
+// Posição na cópia congelada c de cada cômodo de todos[], andando nas duas árvores juntas
+static void posicoesCongeladas(const Comodo *o, const Comodo *c, const Comodo *inicio, Comodo *todos[], int qtd, int posicao[])
+{
+    if (o == NULL)
+        return;
+    for (int i = 0; i < qtd; ++i)
+        if (todos[i] == o)
+            posicao[i] = (int)(c - inicio);
+    posicoesCongeladas(o->esquerda, c->esquerda, inicio, todos, qtd, posicao);
+    posicoesCongeladas(o->direita, c->direita, inicio, todos, qtd, posicao);
+}
+
+// Vetor estático "decl = {...}" com n itens formatados por item(i); vazio vira {0}
+static void emitirVetor(FILE *saida, const char *decl, size_t n, void (*item)(FILE *, const void *, size_t), const void *v)
+{
+    fprintf(saida, "%s = {", decl);
+    for (size_t i = 0; i < n; ++i)
+    {
+        fputs(i % 8 ? ", " : (i ? ",\n    " : "\n    "), saida);
+        item(saida, v, i);
+    }
+    fprintf(saida, "%s};\n\n", n ? "" : "0");
+}
+
+static void emitirInt(FILE *saida, const void *v, size_t i)
+{
+    fprintf(saida, "%d", ((const int *)v)[i]);
+}
+
+static void emitirU16(FILE *saida, const void *v, size_t i)
+{
+    fprintf(saida, "%u", (unsigned)((const uint16_t *)v)[i]);
+}
+
+static void emitirU32(FILE *saida, const void *v, size_t i)
+{
+    fprintf(saida, "%uu", (unsigned)((const uint32_t *)v)[i]);
+}
+
+static void emitirU64(FILE *saida, const void *v, size_t i)
+{
+    fprintf(saida, "0x%016llxull", (unsigned long long)((const uint64_t *)v)[i]);
+}
+
+// %a: o peso volta exatamente o mesmo double
+static void emitirDouble(FILE *saida, const void *v, size_t i)
+{
+    fprintf(saida, "%a", ((const double *)v)[i]);
+}
+
+// Gera mestre_tabelas.h a partir de montarMansao() e do cenário padrão:
+// cômodos estáticos e só de leitura, já ligados e em ordem vEB; a relação
+// pista <-> suspeito inteira (CHD das pistas e os dois CSR com pesos), como
+// construirRelacao a deixaria; e o id na relação de cada pista da base, que é
+// o que o sorteio das pistas grava por cômodo.
+int gerarTabelas(FILE *saida)
+{
+    Comodo *todos[MAX_COMODOS];
+    int qtdComodos = 0;
+    Comodo *raiz = montarMansao(todos, &qtdComodos);
+    for (int i = 0; i < TOTAL_BASE_PADRAO; ++i)
+    {
+        int achou = 0;
+        for (int k = 0; k < TOTAL_SUSPEITOS_PADRAO && !achou; ++k)
+            achou = strcmp(suspeitosPadrao[k], basePadrao[i].suspeito) == 0;
+        if (!achou)
+        {
+            fprintf(stderr, "Suspeito fora da lista: %s\n", basePadrao[i].suspeito);
+            liberarArvore(raiz);
+            return 1;
+        }
+    }
+
+    LigacaoPonderada *ligacoes = montarLigacoesPonderadas(basePadrao, TOTAL_BASE_PADRAO, evidenciasExtrasPadrao, TOTAL_EXTRAS_PADRAO);
+    RelacaoPistaSuspeito rel;
+    construirRelacao(&rel, ligacoes, TOTAL_BASE_PADRAO + TOTAL_EXTRAS_PADRAO, suspeitosPadrao, TOTAL_SUSPEITOS_PADRAO);
+    if (qtdComodos > 255 || rel.totalPistas > INT16_MAX)
+    {
+        fprintf(stderr, "Cenário grande demais para as tabelas geradas.\n");
+        liberarRelacao(&rel);
+        free(ligacoes);
+        liberarArvore(raiz);
+        return 1;
+    }
+
+    fprintf(saida, "// Gerado por \"./mestre gerar-tabelas\" - não editar à mão.\n");
+    fprintf(saida, "// Cenário padrão: mansão estática e relação pista <-> suspeito (CHD + CSR), só leitura.\n");
+    fprintf(saida, "#ifndef MESTRE_TABELAS_H\n#define MESTRE_TABELAS_H\n\n");
+    fprintf(saida, "#define TABELAS_GERADAS 1\n");
+    fprintf(saida, "#define TOTAL_COMODOS_GERADOS %d\n", qtdComodos);
+    fprintf(saida, "#define TOTAL_BASE_GERADA %d\n", TOTAL_BASE_PADRAO);
+    fprintf(saida, "#define TOTAL_SUSPEITOS_GERADOS %d\n", TOTAL_SUSPEITOS_PADRAO);
+    fprintf(saida, "// impressaoCenarioPadrao() das fontes que geraram este arquivo\n");
+    fprintf(saida, "#define IMPRESSAO_CENARIO_GERADO 0x%016llxull\n\n", (unsigned long long)impressaoCenarioPadrao());
+
+    // mesma ordem vEB que o jogo usaria ao congelar a árvore de malloc (Hall no índice 0)
+    MansaoCongelada *congelada = congelarMansao(raiz, ORDEM_VEB);
+    fprintf(saida, "// em ordem van Emde Boas, como congelarMansao(raiz, ORDEM_VEB); sem pistas (ver pistaDe).\n");
+    fprintf(saida, "// Os casts só atendem ao tipo de Comodo: nada escreve nestes cômodos.\n");
+    fprintf(saida, "static const Comodo mansaoGerada[TOTAL_COMODOS_GERADOS] = {\n");
+    for (size_t i = 0; i < congelada->total; ++i)
+    {
+        const Comodo *c = &congelada->comodos[i];
+        fprintf(saida, "    {");
+        emitirTextoCompacto(saida, lerTexto(&c->nome));
+        fprintf(saida, ", {0}, ");
+        if (c->esquerda)
+            fprintf(saida, "(Comodo *)&mansaoGerada[%td], ", c->esquerda - congelada->comodos);
+        else
+            fprintf(saida, "NULL, ");
+        if (c->direita)
+            fprintf(saida, "(Comodo *)&mansaoGerada[%td]}", c->direita - congelada->comodos);
+        else
+            fprintf(saida, "NULL}");
+        fprintf(saida, "%s\n", i + 1 < congelada->total ? "," : "");
+    }
+    fprintf(saida, "};\n\n");
+
+    // o sorteio percorre os cômodos na ordem de montarMansao, para sair igual nos dois builds
+    int posicao[MAX_COMODOS];
+    posicoesCongeladas(raiz, congelada->comodos, congelada->comodos, todos, qtdComodos, posicao);
+    fprintf(saida, "// cômodo de mansaoGerada[] na ordem de criação de montarMansao\n");
+    emitirVetor(saida, "static const unsigned char ordemMontagemGerada[TOTAL_COMODOS_GERADOS]", (size_t)qtdComodos, emitirInt, posicao);
+    liberarMansaoCongelada(congelada);
+
+    int idDaBase[TOTAL_BASE_PADRAO];
+    for (int i = 0; i < TOTAL_BASE_PADRAO; ++i)
+        idDaBase[i] = idPistaRelacao(&rel, basePadrao[i].pista);
+    fprintf(saida, "// id na relação de cada pista de basePadrao\n");
+    emitirVetor(saida, "static const int16_t idPistaDaBaseGerada[TOTAL_BASE_GERADA]", TOTAL_BASE_PADRAO, emitirInt, idDaBase);
+
+    fprintf(saida, "// texto de cada id de pista\n");
+    fprintf(saida, "static const char *const pistasGeradas[] = {\n");
+    for (int p = 0; p < rel.totalPistas; ++p)
+    {
+        fprintf(saida, "    ");
+        emitirTexto(saida, rel.pistas[p]);
+        fprintf(saida, "%s\n", p + 1 < rel.totalPistas ? "," : "");
+    }
+    fprintf(saida, "};\n\n");
+
+    const HashPerfeito *hp = &rel.indicePistas;
+    size_t palavras = (size_t)hp->m / 64 + 1;
+    fprintf(saida, "// CHD das pistas (ver construirHashPerfeito)\n");
+    emitirVetor(saida, "static const uint16_t deslocamentoGerado[]", hp->baldes, emitirU16, hp->deslocamento);
+    emitirVetor(saida, "static const uint64_t ocupadoGerado[]", palavras, emitirU64, hp->ocupado);
+    emitirVetor(saida, "static const uint32_t rankGerado[]", palavras / 8 + 1, emitirU32, hp->rank);
+
+    fprintf(saida, "// CSR pista -> suspeitos e suspeito -> pistas (ver construirRelacao)\n");
+    size_t ligados = (size_t)rel.totalLigacoes;
+    emitirVetor(saida, "static const int inicioPistaGerado[]", (size_t)rel.totalPistas + 1, emitirInt, rel.inicioPista);
+    emitirVetor(saida, "static const int suspeitoDeGerado[]", ligados, emitirInt, rel.suspeitoDe);
+    emitirVetor(saida, "static const double pesoPistaGerado[]", ligados, emitirDouble, rel.pesoPista);
+    emitirVetor(saida, "static const int inicioSuspeitoGerado[]", (size_t)rel.totalSuspeitos + 1, emitirInt, rel.inicioSuspeito);
+    emitirVetor(saida, "static const int pistaDeGerado[]", ligados, emitirInt, rel.pistaDe);
+    emitirVetor(saida, "static const double pesoSuspeitoGerado[]", ligados, emitirDouble, rel.pesoSuspeito);
+
+    fprintf(saida, "// Os casts só atendem aos tipos de RelacaoPistaSuspeito; nunca passe para liberarRelacao.\n");
+    fprintf(saida, "#define RELACAO_GERADA 1\n");
+    fprintf(saida, "static const RelacaoPistaSuspeito relacaoGerada = {\n");
+    fprintf(saida, "    .indicePistas = {.n = %uu, .m = %uu, .baldes = %uu, .semente = 0x%016llxull,\n", hp->n, hp->m, hp->baldes,
+            (unsigned long long)hp->semente);
+    fprintf(saida, "                     .deslocamento = (uint16_t *)deslocamentoGerado, .ocupado = (uint64_t *)ocupadoGerado,\n");
+    fprintf(saida, "                     .rank = (uint32_t *)rankGerado},\n");
+    fprintf(saida, "    .pistas = (const char **)pistasGeradas,\n");
+    fprintf(saida, "    .totalPistas = %d,\n    .totalSuspeitos = %d,\n    .totalLigacoes = %d,\n", rel.totalPistas,
+            rel.totalSuspeitos, rel.totalLigacoes);
+    fprintf(saida, "    .inicioPista = (int *)inicioPistaGerado,\n    .suspeitoDe = (int *)suspeitoDeGerado,\n");
+    fprintf(saida, "    .pesoPista = (double *)pesoPistaGerado,\n    .inicioSuspeito = (int *)inicioSuspeitoGerado,\n");
+    fprintf(saida, "    .pistaDe = (int *)pistaDeGerado,\n    .pesoSuspeito = (double *)pesoSuspeitoGerado};\n\n#endif\n");
+
+    liberarRelacao(&rel);
+    free(ligacoes);
+    liberarArvore(raiz);
+    return 0;
+}
+
+// ---------------------------------
+// Inserção em lote (importação de caso / replay de sessão)
+// ---------------------------------
+// Número de threads de trabalho (núcleos online, limitado a 64)
+int numeroThreads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1)
+        return 1;
+    return n > 64 ? 64 : (int)n;
+}
+
+static int compararTextos(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+typedef struct
+{
+    const char **v;
+    size_t n;
+} FatiaOrdenacao;
+
+typedef struct
+{
+    const char **a, **b, **destino;
+    size_t na, nb;
+} TarefaIntercalacao;
+
+static void *ordenarFatia(void *arg)
+{
+    FatiaOrdenacao *f = arg;
+    qsort(f->v, f->n, sizeof(*f->v), compararTextos);
+    consolidarEstatisticas();
+    return NULL;
+}
+
+static void *intercalarFatias(void *arg)
+{
+    TarefaIntercalacao *t = arg;
+    size_t i = 0, j = 0, k = 0;
+    while (i < t->na && j < t->nb)
+        t->destino[k++] = strcmp(t->a[i], t->b[j]) <= 0 ? t->a[i++] : t->b[j++];
+    while (i < t->na)
+        t->destino[k++] = t->a[i++];
+    while (j < t->nb)
+        t->destino[k++] = t->b[j++];
+    consolidarEstatisticas();
+    return NULL;
+}
+
+// Ordena um vetor de strings. Lotes grandes são divididos entre as threads
+// (qsort por fatia) e intercalados em passadas paralelas, par a par.
+void ordenarTextos(const char **v, size_t n)
+{
+    int nt = numeroThreads();
+    if (n < LIMIAR_ORDENACAO_PARALELA || nt == 1)
+    {
+        qsort(v, n, sizeof(*v), compararTextos);
+        return;
+    }
+
+    pthread_t threads[64];
+    FatiaOrdenacao fatias[64];
+    size_t inicio[65];
+    for (int t = 0; t <= nt; ++t)
+        inicio[t] = n * (size_t)t / (size_t)nt;
+    for (int t = 0; t < nt; ++t)
+    {
+        fatias[t].v = v + inicio[t];
+        fatias[t].n = inicio[t + 1] - inicio[t];
+        pthread_create(&threads[t], NULL, ordenarFatia, &fatias[t]);
+    }
+    for (int t = 0; t < nt; ++t)
+        pthread_join(threads[t], NULL);
+
+    const char **tmp = malloc(n * sizeof(*tmp));
+    if (tmp == NULL)
+    {
+        printf("Erro ao alocar memória para ordenação.\n");
+        exit(1);
+    }
+    const char **origem = v, **destino = tmp;
+    int qtdFatias = nt;
+    while (qtdFatias > 1)
+    {
+        TarefaIntercalacao tarefas[32];
+        int qtdTarefas = 0, novas = 0;
+        for (int f = 0; f < qtdFatias; f += 2, ++novas)
+        {
+            size_t ini = inicio[f];
+            size_t meio = inicio[f + 1];
+            size_t fim = f + 1 < qtdFatias ? inicio[f + 2] : meio;
+            tarefas[qtdTarefas] = (TarefaIntercalacao){origem + ini, origem + meio, destino + ini, meio - ini, fim - meio};
+            pthread_create(&threads[qtdTarefas], NULL, intercalarFatias, &tarefas[qtdTarefas]);
+            qtdTarefas++;
+            inicio[novas] = ini;
+        }
+        inicio[novas] = n;
+        for (int t = 0; t < qtdTarefas; ++t)
+            pthread_join(threads[t], NULL);
+        qtdFatias = novas;
+        const char **troca = origem;
+        origem = destino;
+        destino = troca;
+    }
+    if (origem != v)
+        memcpy(v, origem, n * sizeof(*v));
+    free(tmp);
+}
+
+// Percorre a BST em ordem (sem recursão) e anexa os nós em *nos
+static void achatarBST(NoBST *raiz, NoBST ***nos, size_t *qtd, size_t *cap)
+{
+    size_t capPilha = 64, topo = 0;
+    NoBST **pilha = malloc(capPilha * sizeof(*pilha));
+    if (pilha == NULL)
+    {
+        printf("Erro ao alocar memória para percurso da BST.\n");
+        exit(1);
+    }
+    NoBST *atual = raiz;
+    while (atual != NULL || topo > 0)
+    {
+        while (atual != NULL)
+        {
+            if (topo == capPilha)
+            {
+                capPilha *= 2;
+                pilha = realloc(pilha, capPilha * sizeof(*pilha));
+                if (pilha == NULL)
+                {
+                    printf("Erro ao alocar memória para percurso da BST.\n");
+                    exit(1);
+                }
+            }
+            pilha[topo++] = atual;
+            atual = atual->esquerda;
+        }
+        atual = pilha[--topo];
+        if (*qtd == *cap)
+        {
+            *cap = *cap ? *cap * 2 : 64;
+            *nos = realloc(*nos, *cap * sizeof(**nos));
+            if (*nos == NULL)
+            {
+                printf("Erro ao alocar memória para percurso da BST.\n");
+                exit(1);
+            }
+        }
+        (*nos)[(*qtd)++] = atual;
+        atual = atual->direita;
+    }
+    free(pilha);
+}
+
+// Liga nos[ini..fim) como árvore balanceada; cada nó é visitado uma vez (O(n))
+static NoBST *ligarBalanceada(NoBST **nos, size_t ini, size_t fim)
+{
+    if (ini >= fim)
+        return NULL;
+    size_t meio = ini + (fim - ini) / 2;
+    NoBST *raiz = nos[meio];
+    raiz->esquerda = ligarBalanceada(nos, ini, meio);
+    raiz->direita = ligarBalanceada(nos, meio + 1, fim);
+    return raiz;
+}
+
+// Base normalizada para a busca binária do lote; empates mantêm a ordem
+// original, assim a busca devolve a primeira ligação, como a varredura do menu
+typedef struct
+{
+    ChavePista chave;
+    const char *suspeito;
+    int ordem;
+} LigacaoNormalizada;
+
+static int compararLigacoesNormalizadas(const void *a, const void *b)
+{
+    const LigacaoNormalizada *la = a, *lb = b;
+    int cmp = compararChaves(&la->chave, &lb->chave);
+    if (cmp != 0)
+        return cmp;
+    return (la->ordem > lb->ordem) - (la->ordem < lb->ordem);
+}
+
+// Busca binária na base normalizada (primeira ocorrência)
+static const char *suspeitoNaBaseOrdenada(const LigacaoNormalizada *base, int total, const ChavePista *pista)
+{
+    int ini = 0, fim = total - 1, achado = -1;
+    while (ini <= fim)
+    {
+        int meio = ini + (fim - ini) / 2;
+        int cmp = compararChaves(pista, &base[meio].chave);
+        if (cmp <= 0)
+        {
+            if (cmp == 0)
+                achado = meio;
+            fim = meio - 1;
+        }
+        else
+            ini = meio + 1;
+    }
+    return achado >= 0 ? base[achado].suspeito : "Desconhecido";
+}
+
+// Cada texto normalizado do lote vem logo depois do índice (4 bytes) da pista original
+static uint32_t indiceOriginal(const char *normalizada)
+{
+    uint32_t id;
+    memcpy(&id, normalizada - sizeof(id), sizeof(id));
+    return id;
+}
+
+// Insere um lote de pistas de uma vez: normaliza, ordena e remove duplicatas,
+// intercala com as pistas já presentes na BST, religa tudo como árvore
+// balanceada em O(n) e registra só as pistas novas na hash. Equivale a chamar,
+// para cada pista, buscarBST + inserirBST + varredura de base[] + inserirHashPista.
+// Retorna quantas pistas novas foram registradas.
+int inserirPistasEmLote(NoBST **pistasBST, HashPistas *hash, const char *pistas[], int qtd, LigacaoPistaSuspeito base[], int totalBase)
+{
+    if (qtd <= 0)
+        return 0;
+
+    // 1) normalizar (uma vez), ordenar e deduplicar o lote; entre equivalentes
+    //    fica o texto da primeira ocorrência
+    size_t bytes = 0;
+    for (int i = 0; i < qtd; ++i)
+        if (pistas[i] != NULL)
+            bytes += sizeof(uint32_t) + strlen(pistas[i]) + 1;
+    char *normalizadas = malloc(bytes + 1);
+    const char **lote = malloc((size_t)qtd * sizeof(*lote));
+    if (normalizadas == NULL || lote == NULL)
+    {
+        printf("Erro ao alocar memória para inserção em lote.\n");
+        exit(1);
+    }
+    size_t n = 0, usado = 0;
+    for (int i = 0; i < qtd; ++i)
+    {
+        if (pistas[i] == NULL || pistas[i][0] == '\0')
+            continue;
+        uint32_t id = (uint32_t)i;
+        memcpy(normalizadas + usado, &id, sizeof(id));
+        char *texto = normalizadas + usado + sizeof(id);
+        size_t tam = normalizarPista(pistas[i], strlen(pistas[i]), texto);
+        if (tam == 0)
+            continue;
+        lote[n++] = texto;
+        usado += sizeof(id) + tam + 1;
+    }
+    ordenarTextos(lote, n);
+    size_t unicos = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (unicos == 0 || strcmp(lote[i], lote[unicos - 1]) != 0)
+            lote[unicos++] = lote[i];
+        else if (indiceOriginal(lote[i]) < indiceOriginal(lote[unicos - 1]))
+            lote[unicos - 1] = lote[i];
+    }
+
+    // 2) intercalar com os nós existentes, criando nós só para as pistas novas
+    NoBST **existentes = NULL;
+    size_t qtdExistentes = 0, capExistentes = 0;
+    achatarBST(*pistasBST, &existentes, &qtdExistentes, &capExistentes);
+
+    NoBST **todos = malloc((qtdExistentes + unicos) * sizeof(*todos));
+    const char **novas = malloc(unicos * sizeof(*novas) + 1);
+    ChavePista *chavesNovas = malloc(unicos * sizeof(*chavesNovas) + 1);
+    if (todos == NULL || novas == NULL || chavesNovas == NULL)
+    {
+        printf("Erro ao alocar memória para inserção em lote.\n");
+        exit(1);
+    }
+    size_t i = 0, j = 0, total = 0, qtdNovas = 0;
+    ChavePista chave = {0, NULL, 0};
+    if (unicos > 0)
+        chave = montarChave(lote[0], strlen(lote[0]));
+    while (i < qtdExistentes || j < unicos)
+    {
+        int cmp;
+        if (i == qtdExistentes)
+            cmp = 1;
+        else if (j == unicos)
+            cmp = -1;
+        else
+            cmp = -compararChaveNo(&chave, existentes[i]);
+
+        if (cmp < 0)
+            todos[total++] = existentes[i++];
+        else
+        {
+            if (cmp == 0)
+                todos[total++] = existentes[i++];
+            else
+            {
+                NoBST *novo = criarNoBSTChave(pistas[indiceOriginal(lote[j])], &chave);
+                todos[total++] = novo;
+                chavesNovas[qtdNovas] = chave;
+                novas[qtdNovas++] = lerTexto(&novo->pista);
+            }
+            if (++j < unicos)
+                chave = montarChave(lote[j], strlen(lote[j]));
+        }
+    }
+    *pistasBST = ligarBalanceada(todos, 0, total);
+
+    // 3) suspeitos via busca binária numa cópia normalizada e ordenada da base
+    size_t bytesBase = 0;
+    for (int k = 0; k < totalBase; ++k)
+        bytesBase += strlen(base[k].pista) + 1;
+    LigacaoNormalizada *baseOrdenada = malloc((size_t)totalBase * sizeof(*baseOrdenada) + 1);
+    char *textosBase = malloc(bytesBase + 1);
+    if (baseOrdenada == NULL || textosBase == NULL)
+    {
+        printf("Erro ao alocar memória para inserção em lote.\n");
+        exit(1);
+    }
+    usado = 0;
+    for (int k = 0; k < totalBase; ++k)
+    {
+        char *texto = textosBase + usado;
+        size_t tam = normalizarPista(base[k].pista, strlen(base[k].pista), texto);
+        baseOrdenada[k] = (LigacaoNormalizada){montarChave(texto, tam), base[k].suspeito, k};
+        usado += tam + 1;
+    }
+    qsort(baseOrdenada, (size_t)totalBase, sizeof(*baseOrdenada), compararLigacoesNormalizadas);
+
+    // 4) índices da hash calculados antes, com prefetch do balde alguns passos à frente
+    int *idx = malloc(qtdNovas * sizeof(*idx) + 1);
+    if (idx == NULL)
+    {
+        printf("Erro ao alocar memória para inserção em lote.\n");
+        exit(1);
+    }
+    for (size_t k = 0; k < qtdNovas; ++k)
+        idx[k] = funcao_hash(novas[k]);
+    for (size_t k = 0; k < qtdNovas; ++k)
+    {
+        if (k + DISTANCIA_PREFETCH < qtdNovas)
+            __builtin_prefetch(&hash->tabela[idx[k + DISTANCIA_PREFETCH]], 1);
+        inserirHashPistaIdx(hash, idx[k], novas[k], suspeitoNaBaseOrdenada(baseOrdenada, totalBase, &chavesNovas[k]));
+    }
+
+    free(idx);
+    free(textosBase);
+    free(baseOrdenada);
+    free(chavesNovas);
+    free(novas);
+    free(todos);
+    free(existentes);
+    free(lote);
+    free(normalizadas);
+    return (int)qtdNovas;
+}
+
+// ---------------------------------
+// Índice radix (trie comprimida) das pistas
+// ---------------------------------
+// Cada aresta guarda um trecho de texto; filhos ordenados pelo primeiro byte
+// (sem sinal), então o percurso sai na mesma ordem de strcmp/mostrarPistasBST.
+// O rótulo fica no fim da alocação do nó; quando a aresta é dividida o rótulo
+// só avança dentro dela, então o tamanho alocado continua dedutível.
+
+static size_t tamanhoNoRadix(const NoRadix *n)
+{
+    return sizeof(NoRadix) + (size_t)(n->rotulo - (const char *)(n + 1)) + (size_t)n->tamRotulo + 1;
+}
+
+NoRadix *criarNoRadix(const char *rotulo, int tam)
+{
+    NoRadix *n = alocarContado(MEM_RADIX, 1, sizeof(NoRadix) + (size_t)tam + 1);
+    if (n == NULL)
+    {
+        printf("Erro ao alocar memória para nó do índice.\n");
+        exit(1);
+    }
+    n->rotulo = (char *)(n + 1);
+    memcpy(n->rotulo, rotulo, (size_t)tam);
+    n->rotulo[tam] = '\0';
+    n->tamRotulo = tam;
+    n->terminal = 0;
+    n->qtdFilhos = n->capFilhos = 0;
+    n->filhos = NULL;
+    return n;
+}
+
+// Posição do filho cujo rótulo começa com c (ou onde ele deveria entrar)
+static int posicaoFilhoRadix(NoRadix *no, unsigned char c, int *achou)
+{
+    int ini = 0, fim = no->qtdFilhos;
+    while (ini < fim)
+    {
+        int meio = (ini + fim) / 2;
+        unsigned char m = (unsigned char)no->filhos[meio]->rotulo[0];
+        if (m < c)
+            ini = meio + 1;
+        else
+            fim = meio;
+    }
+    *achou = ini < no->qtdFilhos && (unsigned char)no->filhos[ini]->rotulo[0] == c;
+    return ini;
+}
+
+static void colocarFilhoRadix(NoRadix *no, int pos, NoRadix *filho)
+{
+    if (no->qtdFilhos == no->capFilhos)
+    {
+        size_t antes = (size_t)no->capFilhos * sizeof(*no->filhos);
+        no->capFilhos = no->capFilhos ? no->capFilhos * 2 : 2;
+        no->filhos = realocarContado(MEM_RADIX, no->filhos, antes, (size_t)no->capFilhos * sizeof(*no->filhos));
+        if (no->filhos == NULL)
+        {
+            printf("Erro ao alocar memória para nó do índice.\n");
+            exit(1);
+        }
+    }
+    memmove(&no->filhos[pos + 1], &no->filhos[pos], (size_t)(no->qtdFilhos - pos) * sizeof(*no->filhos));
+    no->filhos[pos] = filho;
+    no->qtdFilhos++;
+}
+
+// Insere uma pista (duplicatas são ignoradas)
+void inserirRadix(NoRadix *raiz, const char *pista)
+{
+    NoRadix *no = raiz;
+    const char *s = pista;
+    while (*s != '\0')
+    {
+        int achou;
+        int pos = posicaoFilhoRadix(no, (unsigned char)*s, &achou);
+        if (!achou)
+        {
+            NoRadix *folha = criarNoRadix(s, (int)strlen(s));
+            folha->terminal = 1;
+            colocarFilhoRadix(no, pos, folha);
+            return;
+        }
+        NoRadix *filho = no->filhos[pos];
+        int comum = 0;
+        while (comum < filho->tamRotulo && s[comum] == filho->rotulo[comum])
+            comum++;
+        if (comum < filho->tamRotulo)
+        {
+            // divide a aresta: meio fica com o trecho comum, o filho com o resto
+            NoRadix *meio = criarNoRadix(filho->rotulo, comum);
+            filho->rotulo += comum;
+            filho->tamRotulo -= comum;
+            colocarFilhoRadix(meio, 0, filho);
+            no->filhos[pos] = meio;
+            filho = meio;
+        }
+        no = filho;
+        s += comum;
+    }
+    no->terminal = 1;
+}
+
+// Monta o índice a partir da BST de pistas coletadas (sobre as chaves normalizadas)
+NoRadix *construirIndicePistas(NoBST *raiz)
+{
+    NoRadix *indice = criarNoRadix("", 0);
+    NoBST **nos = NULL;
+    size_t qtd = 0, cap = 0;
+    achatarBST(raiz, &nos, &qtd, &cap);
+    for (size_t i = 0; i < qtd; ++i)
+        inserirRadix(indice, lerTexto(&nos[i]->normalizada));
+    free(nos);
+    return indice;
+}
+
+// Texto do caminho atual da raiz até o nó (cresce conforme a descida)
+typedef struct
+{
+    char *dados;
+    size_t tam, cap;
+} Caminho;
+
+static void empilharCaminho(Caminho *c, const char *trecho, size_t tam)
+{
+    if (c->tam + tam + 1 > c->cap)
+    {
+        c->cap = (c->tam + tam + 1) * 2;
+        c->dados = realloc(c->dados, c->cap);
+        if (c->dados == NULL)
+        {
+            printf("Erro ao alocar memória para busca no índice.\n");
+            exit(1);
+        }
+    }
+    memcpy(c->dados + c->tam, trecho, tam);
+    c->tam += tam;
+    c->dados[c->tam] = '\0';
+}
+
+static int percorrerRadixRec(NoRadix *no, Caminho *c, VisitaPista visitar, void *ctx)
+{
+    size_t tamAntes = c->tam;
+    empilharCaminho(c, no->rotulo, (size_t)no->tamRotulo);
+    int total = 0;
+    if (no->terminal)
+    {
+        visitar(c->dados, 0, ctx);
+        total++;
+    }
+    for (int i = 0; i < no->qtdFilhos; ++i)
+        total += percorrerRadixRec(no->filhos[i], c, visitar, ctx);
+    c->tam = tamAntes;
+    c->dados[c->tam] = '\0';
+    return total;
+}
+
+// Visita todas as pistas em ordem; retorna quantas
+int percorrerRadix(NoRadix *raiz, VisitaPista visitar, void *ctx)
+{
+    if (raiz == NULL)
+        return 0;
+    Caminho c = {NULL, 0, 0};
+    int total = percorrerRadixRec(raiz, &c, visitar, ctx);
+    free(c.dados);
+    return total;
+}
+
+// Visita, em ordem, as pistas que começam com prefixo; só desce pelo caminho do prefixo
+int buscarPrefixoRadix(NoRadix *raiz, const char *prefixo, VisitaPista visitar, void *ctx)
+{
+    EST_INC(buscasRadix);
+    if (raiz == NULL)
+        return 0;
+    Caminho c = {NULL, 0, 0};
+    NoRadix *no = raiz;
+    const char *s = prefixo;
+    while (*s != '\0')
+    {
+        int achou;
+        int pos = posicaoFilhoRadix(no, (unsigned char)*s, &achou);
+        if (!achou)
+        {
+            free(c.dados);
+            return 0;
+        }
+        NoRadix *filho = no->filhos[pos];
+        int comum = 0;
+        while (comum < filho->tamRotulo && s[comum] != '\0' && s[comum] == filho->rotulo[comum])
+            comum++;
+        if (s[comum] != '\0' && comum < filho->tamRotulo)
+        {
+            free(c.dados);
+            return 0; // divergiu no meio da aresta
+        }
+        s += comum;
+        if (*s != '\0')
+            empilharCaminho(&c, filho->rotulo, (size_t)filho->tamRotulo);
+        no = filho;
+    }
+    int total = percorrerRadixRec(no, &c, visitar, ctx);
+    free(c.dados);
+    return total;
+}
+
+// Busca aproximada (Levenshtein por byte): cada caractere das arestas gera uma
+// linha da tabela de distâncias a partir da linha do pai; a subárvore é podada
+// assim que o menor valor da linha passa de maxDist.
+typedef struct
+{
+    const char *termo;
+    int colunas; // strlen(termo) + 1
+    int maxDist;
+    VisitaPista visitar;
+    void *ctx;
+    Caminho caminho;
+    int encontradas;
+} BuscaAproximada;
+
+static void aproximadoRec(NoRadix *no, const int *linhaPai, BuscaAproximada *b)
+{
+    int colunas = b->colunas;
+    int *linhas = malloc(((size_t)no->tamRotulo + 1) * (size_t)colunas * sizeof(int));
+    if (linhas == NULL)
+    {
+        printf("Erro ao alocar memória para busca no índice.\n");
+        exit(1);
+    }
+    memcpy(linhas, linhaPai, (size_t)colunas * sizeof(int));
+    int menor = 0;
+    for (int k = 0; k < no->tamRotulo; ++k)
+    {
+        const int *ant = linhas + (size_t)k * colunas;
+        int *nova = linhas + (size_t)(k + 1) * colunas;
+        nova[0] = ant[0] + 1;
+        menor = nova[0];
+        for (int j = 1; j < colunas; ++j)
+        {
+            int custo = b->termo[j - 1] == no->rotulo[k] ? 0 : 1;
+            int v = ant[j - 1] + custo;
+            if (ant[j] + 1 < v)
+                v = ant[j] + 1;
+            if (nova[j - 1] + 1 < v)
+                v = nova[j - 1] + 1;
+            nova[j] = v;
+            if (v < menor)
+                menor = v;
+        }
+        if (menor > b->maxDist)
+        {
+            free(linhas);
+            return;
+        }
+    }
+
+    size_t tamAntes = b->caminho.tam;
+    empilharCaminho(&b->caminho, no->rotulo, (size_t)no->tamRotulo);
+    const int *ultima = linhas + (size_t)no->tamRotulo * colunas;
+    if (no->terminal && ultima[colunas - 1] <= b->maxDist)
+    {
+        b->visitar(b->caminho.dados, ultima[colunas - 1], b->ctx);
+        b->encontradas++;
+    }
+    for (int i = 0; i < no->qtdFilhos; ++i)
+        aproximadoRec(no->filhos[i], ultima, b);
+    b->caminho.tam = tamAntes;
+    b->caminho.dados[tamAntes] = '\0';
+    free(linhas);
+}
+
+// Visita, em ordem, as pistas a no máximo maxDist edições de termo
+int buscarAproximadoRadix(NoRadix *raiz, const char *termo, int maxDist, VisitaPista visitar, void *ctx)
+{
+    EST_INC(buscasRadix);
+    if (raiz == NULL)
+        return 0;
+    BuscaAproximada b = {termo, (int)strlen(termo) + 1, maxDist, visitar, ctx, {NULL, 0, 0}, 0};
+    int *linha0 = malloc((size_t)b.colunas * sizeof(int));
+    if (linha0 == NULL)
+    {
+        printf("Erro ao alocar memória para busca no índice.\n");
+        exit(1);
+    }
+    for (int j = 0; j < b.colunas; ++j)
+        linha0[j] = j;
+    aproximadoRec(raiz, linha0, &b);
+    free(linha0);
+    free(b.caminho.dados);
+    return b.encontradas;
+}
+
+static void imprimirPistaVisitada(const char *pista, int distancia, void *ctx)
+{
+    (void)ctx;
+    if (distancia > 0)
+        printf(" - %s (distância %d)\n", pista, distancia);
+    else
+        printf(" - %s\n", pista);
+}
+
+// Mesmo formato de mostrarPistasBST
+void mostrarPistasRadix(NoRadix *raiz)
+{
+    percorrerRadix(raiz, imprimirPistaVisitada, NULL);
+}
+
+// Libera memória do índice
+void liberarRadix(NoRadix *raiz)
+{
+    if (raiz == NULL)
+        return;
+    for (int i = 0; i < raiz->qtdFilhos; ++i)
+        liberarRadix(raiz->filhos[i]);
+    liberarContado(MEM_RADIX, raiz->filhos, 1, (size_t)raiz->capFilhos * sizeof(*raiz->filhos));
+    liberarContado(MEM_RADIX, raiz, 1, tamanhoNoRadix(raiz));
+}
+
+// ---------------------------------
+// Gerador procedural de mansões
+// ---------------------------------
+// Os filhos de cada cômodo saem de fórmulas sobre o índice, então cada thread
+// preenche sua faixa do vetor sem conversar com as outras, e o resultado é o
+// mesmo com qualquer número de threads. Nome e pista de cada cômodo dependem
+// só de (semente, índice).
+
+static const char *tiposComodo[] = {
+    "Sala", "Quarto", "Galeria", "Corredor", "Adega", "Sotao", "Capela", "Estufa",
+    "Biblioteca", "Escritorio", "Despensa", "Salao", "Closet", "Lavanderia", "Varanda", "Torre"};
+static const char *alasComodo[] = {"Norte", "Sul", "Leste", "Oeste"};
+static const char *nomesSuspeito[] = {
+    "Mordomo", "Jardineiro", "Cozinheira", "Bibliotecario", "Visitante", "Motorista", "Governanta", "Herdeiro"};
+
+static const char *formasMansao[] = {"balanceada", "enviesada", "corredores"};
+
+int lerFormaMansao(const char *nome, FormaMansao *forma)
+{
+    for (int i = 0; i < 3; ++i)
+        if (strcmp(nome, formasMansao[i]) == 0)
+        {
+            *forma = (FormaMansao)i;
+            return 1;
+        }
+    return 0;
+}
+
+const char *nomeFormaMansao(FormaMansao forma)
+{
+    return formasMansao[forma];
+}
+
+// Índices dos filhos do cômodo i (SIZE_MAX = sem filho)
+static void filhosProcedurais(FormaMansao forma, size_t i, size_t total, size_t *esq, size_t *dir)
+{
+    *esq = *dir = SIZE_MAX;
+    switch (forma)
+    {
+    case FORMA_BALANCEADA:
+        *esq = 2 * i + 1;
+        *dir = 2 * i + 2;
+        break;
+    case FORMA_ENVIESADA:
+        if (i % 2 == 0) // espinha: folha à esquerda, continua à direita
+        {
+            *esq = i + 1;
+            *dir = i + 2;
+        }
+        break;
+    case FORMA_CORREDORES:
+    {
+        size_t bloco = i / TAM_CORREDOR, pos = i % TAM_CORREDOR;
+        if (pos + 1 < TAM_CORREDOR)
+            *esq = i + 1; // segue o corredor
+        else
+        {
+            *esq = (2 * bloco + 1) * TAM_CORREDOR;
+            *dir = (2 * bloco + 2) * TAM_CORREDOR;
+        }
+        break;
+    }
+    }
+    if (*esq >= total)
+        *esq = SIZE_MAX;
+    if (*dir >= total)
+        *dir = SIZE_MAX;
+}
+
+// Copia s para destino e devolve o ponteiro para o fim (sem snprintf: é o laço quente)
+static char *copiarTexto(char *destino, const char *s)
+{
+    while (*s)
+        *destino++ = *s++;
+    return destino;
+}
+
+static char *escreverIndice(char *destino, uint64_t v)
+{
+    char tmp[24];
+    int k = 0;
+    do
+    {
+        tmp[k++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (k > 0)
+        *destino++ = tmp[--k];
+    return destino;
+}
+
+typedef struct
+{
+    MansaoProcedural *m;
+    size_t inicio, fim;
+    Arena textos; // da faixa; juntada à da mansão no fim
+} FaixaGerador;
+
+static void *gerarFaixa(void *arg)
+{
+    FaixaGerador *f = arg;
+    MansaoProcedural *m = f->m;
+    for (size_t i = f->inicio; i < f->fim; ++i)
+    {
+        Comodo *c = &m->comodos[i];
+        uint64_t h = misturar64(m->semente ^ (i * 0x9E3779B97F4A7C15ull));
+
+        // nome: "<tipo> <ala> <índice>"; o Hall mantém o nome de sempre
+        if (i == 0)
+            c->nome = referenciarTexto("Hall de Entrada");
+        else
+        {
+            char nome[64];
+            char *p = copiarTexto(nome, tiposComodo[h & 15]);
+            *p++ = ' ';
+            p = copiarTexto(p, alasComodo[(h >> 4) & 3]);
+            *p++ = ' ';
+            p = escreverIndice(p, i);
+            size_t tam = (size_t)(p - nome);
+            c->nome = montarTexto(nome, tam, extraTexto(tam) ? reservarArena(&f->textos, tam + 1, 1) : NULL);
+        }
+
+        // 90% de chance de ter pista, como em distribuirPistas
+        if (m->totalBase > 0 && (h >> 8) % 100 < 90)
+            c->pista = referenciarTexto(m->base[(h >> 16) % (uint64_t)m->totalBase].pista);
+        else
+            c->pista = referenciarTexto("");
+
+        size_t e, d;
+        filhosProcedurais(m->forma, i, m->total, &e, &d);
+        c->esquerda = e != SIZE_MAX ? &m->comodos[e] : NULL;
+        c->direita = d != SIZE_MAX ? &m->comodos[d] : NULL;
+    }
+    consolidarEstatisticas();
+    return NULL;
+}
+
+// Gera uma mansão com total cômodos num único vetor, mais um corpus sintético
+// de totalSuspeitos suspeitos e totalPistas pistas. threads <= 0 usa todos os núcleos.
+MansaoProcedural *gerarMansao(size_t total, FormaMansao forma, uint64_t semente, int totalSuspeitos, int totalPistas, int threads)
+{
+    if (total < 1)
+        total = 1;
+    if (totalSuspeitos < 1)
+        totalSuspeitos = 1;
+    MansaoProcedural *m = calloc(1, sizeof(*m));
+    if (m == NULL)
+    {
+        printf("Erro ao alocar memória para a mansão gerada.\n");
+        exit(1);
+    }
+    m->total = total;
+    m->forma = forma;
+    m->semente = semente;
+    m->totalSuspeitos = totalSuspeitos;
+    m->totalBase = totalPistas > 0 ? totalPistas : 0;
+    m->comodos = alocarContado(MEM_COMODOS, total, total * sizeof(*m->comodos));
+    m->suspeitos = malloc((size_t)totalSuspeitos * sizeof(*m->suspeitos));
+    m->base = malloc((size_t)m->totalBase * sizeof(*m->base) + 1);
+    if (m->comodos == NULL || m->suspeitos == NULL || m->base == NULL)
+    {
+        printf("Erro ao alocar memória para a mansão gerada.\n");
+        exit(1);
+    }
+
+    // corpus: suspeitos "<nome> <n>" e pistas ligadas a um suspeito sorteado
+    uint64_t estado = semente ^ 0xC0FFEEull;
+    for (int k = 0; k < totalSuspeitos; ++k)
+    {
+        char nome[50];
+        snprintf(nome, sizeof(nome), "%s %d", nomesSuspeito[k % 8], k / 8 + 1);
+        m->suspeitos[k] = strdup(nome);
+        if (m->suspeitos[k] == NULL)
+        {
+            printf("Erro ao alocar memória para a mansão gerada.\n");
+            exit(1);
+        }
+    }
+    for (int k = 0; k < m->totalBase; ++k)
+    {
+        uint64_t h = aleatorio64(&estado);
+        char pista[128];
+        snprintf(pista, sizeof(pista), "%s suspeito na %s %s (%d).", k % 2 ? "Rastro" : "Objeto", tiposComodo[h & 15],
+                 alasComodo[(h >> 4) & 3], k);
+        m->base[k].pista = guardarString(&m->textosBase, pista);
+        m->base[k].suspeito = m->suspeitos[(h >> 8) % (uint64_t)totalSuspeitos];
+    }
+
+    if (threads <= 0)
+        threads = numeroThreads();
+    if (threads > 64)
+        threads = 64;
+    if ((size_t)threads > total)
+        threads = (int)total;
+    pthread_t ids[64];
+    FaixaGerador faixas[64];
+    for (int t = 0; t < threads; ++t)
+    {
+        faixas[t] = (FaixaGerador){m, total * (size_t)t / (size_t)threads, total * (size_t)(t + 1) / (size_t)threads, {NULL, 0}};
+        if (threads == 1)
+            gerarFaixa(&faixas[t]);
+        else
+            pthread_create(&ids[t], NULL, gerarFaixa, &faixas[t]);
+    }
+    for (int t = 0; threads > 1 && t < threads; ++t)
+        pthread_join(ids[t], NULL);
+    for (int t = 0; t < threads; ++t)
+        juntarArena(&m->textos, &faixas[t].textos);
+    return m;
+}
+
+// Altura da árvore de cômodos (iterativa; mansões geradas podem ser muito fundas)
+size_t alturaMansao(Comodo *raiz)
+{
+    typedef struct
+    {
+        Comodo *c;
+        size_t prof;
+    } Item;
+    size_t cap = 64, topo = 0, altura = 0;
+    Item *pilha = malloc(cap * sizeof(*pilha));
+    if (pilha == NULL)
+        return 0;
+    if (raiz != NULL)
+        pilha[topo++] = (Item){raiz, 1};
+    while (topo > 0)
+    {
+        Item it = pilha[--topo];
+        if (it.prof > altura)
+            altura = it.prof;
+        if (topo + 2 > cap)
+        {
+            cap *= 2;
+            Item *maior = realloc(pilha, cap * sizeof(*pilha));
+            if (maior == NULL)
+                break;
+            pilha = maior;
+        }
+        if (it.c->esquerda)
+            pilha[topo++] = (Item){it.c->esquerda, it.prof + 1};
+        if (it.c->direita)
+            pilha[topo++] = (Item){it.c->direita, it.prof + 1};
+    }
+    free(pilha);
+    return altura;
+}
+
+// Libera a mansão gerada (um free para todos os cômodos, não liberarArvore)
+void liberarMansaoProcedural(MansaoProcedural *m)
+{
+    if (m == NULL)
+        return;
+    for (int k = 0; k < m->totalSuspeitos; ++k)
+        free(m->suspeitos[k]);
+    free(m->suspeitos);
+    free(m->base);
+    liberarContado(MEM_COMODOS, m->comodos, m->total, m->total * sizeof(*m->comodos));
+    liberarArena(&m->textos);
+    liberarArena(&m->textosBase);
+    free(m);
+}
+
+// ---------------------------------
+// Mansão congelada (layout van Emde Boas)
+// ---------------------------------
+// Depois de montada, a árvore de cômodos não muda mais, mas fica na ordem em
+// que o malloc entregou os nós. congelarMansao copia a árvore para um vetor
+// só. Na ordem vEB a árvore de altura h é cortada na altura h/2: a parte de
+// cima vem primeiro e cada subárvore de baixo vem inteira depois, com a
+// mesma regra aplicada dentro de cada pedaço. Um caminho do Hall até uma
+// folha passa então por O(log_B n) linhas de cache, qualquer que seja o
+// tamanho B da linha. A cópia continua feita de Comodo com ponteiros, então
+// menu, motor de jogo e rota andam nela sem mudança.
+
+typedef struct
+{
+    const Comodo **original; // cômodo de cada índice BFS
+    uint32_t *esq, *dir;     // filhos por índice BFS (UINT32_MAX = nenhum)
+    size_t total;
+    uint32_t altura;
+} NumeracaoBFS;
+
+typedef struct
+{
+    uint32_t *v;
+    size_t n, cap;
+} PilhaVeb;
+
+static void empilharVeb(PilhaVeb *p, uint32_t x)
+{
+    if (p->n == p->cap)
+    {
+        p->cap = p->cap ? 2 * p->cap : 1024;
+        uint32_t *maior = realloc(p->v, p->cap * sizeof(*p->v));
+        if (maior == NULL)
+        {
+            printf("Erro ao alocar memória para congelar a mansão.\n");
+            exit(1);
+        }
+        p->v = maior;
+    }
+    p->v[p->n++] = x;
+}
+
+typedef struct
+{
+    const uint32_t *esq, *dir; // filhos por índice BFS (UINT32_MAX = nenhum)
+    uint32_t *posicao;         // índice BFS -> posição no vetor congelado
+    uint32_t proxima;
+    PilhaVeb pilha; // raízes das subárvores de baixo de cada nível da recursão
+} LayoutVeb;
+
+// Dispõe a subárvore de r cortada na altura h (h >= altura real dela)
+static void disporVeb(LayoutVeb *l, uint32_t r, uint32_t h)
+{
+    if (h == 1)
+    {
+        l->posicao[r] = l->proxima++;
+        return;
+    }
+    uint32_t topo = h / 2;
+    disporVeb(l, r, topo);
+
+    // raízes de baixo: os nós na profundidade topo, da esquerda para a direita.
+    // Ficam na pilha por índice, porque as chamadas de baixo também empilham.
+    size_t base = l->pilha.n;
+    empilharVeb(&l->pilha, r);
+    for (uint32_t d = 0; d < topo && l->pilha.n > base; ++d)
+    {
+        size_t fim = l->pilha.n;
+        for (size_t k = base; k < fim; ++k)
+        {
+            uint32_t v = l->pilha.v[k];
+            if (l->esq[v] != UINT32_MAX)
+                empilharVeb(&l->pilha, l->esq[v]);
+            if (l->dir[v] != UINT32_MAX)
+                empilharVeb(&l->pilha, l->dir[v]);
+        }
+        memmove(l->pilha.v + base, l->pilha.v + fim, (l->pilha.n - fim) * sizeof(*l->pilha.v));
+        l->pilha.n -= fim - base;
+    }
+    size_t raizes = l->pilha.n - base;
+    for (size_t k = 0; k < raizes; ++k)
+        disporVeb(l, l->pilha.v[base + k], h - topo);
+    l->pilha.n = base;
+}
+
+// Numera a árvore em BFS (Hall = 0) com os filhos por índice; o chamador libera os três vetores
+static void numerarBFS(const Comodo *raiz, NumeracaoBFS *b)
+{
+    size_t cap = 1024, total = 1;
+    const Comodo **original = malloc(cap * sizeof(*original));
+    uint32_t *esq = malloc(cap * sizeof(*esq)), *dir = malloc(cap * sizeof(*dir));
+    uint32_t altura = 0;
+    if (original == NULL || esq == NULL || dir == NULL)
+    {
+        printf("Erro ao alocar memória para numerar a mansão.\n");
+        exit(1);
+    }
+    // a fila é o próprio vetor de originais
+    original[0] = raiz;
+    for (size_t i = 0, fimNivel = 1; i < total; ++i)
+    {
+        if (total + 2 > cap)
+        {
+            cap *= 2;
+            original = realloc(original, cap * sizeof(*original));
+            esq = realloc(esq, cap * sizeof(*esq));
+            dir = realloc(dir, cap * sizeof(*dir));
+            if (original == NULL || esq == NULL || dir == NULL || cap >= UINT32_MAX)
+            {
+                printf("Erro ao alocar memória para numerar a mansão.\n");
+                exit(1);
+            }
+        }
+        const Comodo *c = original[i];
+        esq[i] = dir[i] = UINT32_MAX;
+        if (c->esquerda)
+        {
+            esq[i] = (uint32_t)total;
+            original[total++] = c->esquerda;
+        }
+        if (c->direita)
+        {
+            dir[i] = (uint32_t)total;
+            original[total++] = c->direita;
+        }
+        if (i + 1 == fimNivel)
+        {
+            altura++;
+            fimNivel = total;
+        }
+    }
+    b->original = original;
+    b->esq = esq;
+    b->dir = dir;
+    b->total = total;
+    b->altura = altura;
+}
+
+MansaoCongelada *congelarMansao(const Comodo *raiz, OrdemCongelada ordem)
+{
+    MansaoCongelada *m = calloc(1, sizeof(*m));
+    if (m == NULL)
+    {
+        printf("Erro ao alocar memória para congelar a mansão.\n");
+        exit(1);
+    }
+    m->ordem = ordem;
+    if (raiz == NULL)
+        return m;
+
+    NumeracaoBFS bfs;
+    numerarBFS(raiz, &bfs);
+    size_t total = bfs.total;
+    const Comodo **original = bfs.original;
+    uint32_t *esq = bfs.esq, *dir = bfs.dir;
+
+    // posição final de cada nó; em BFS é o próprio índice
+    uint32_t *posicao = malloc(total * sizeof(*posicao));
+    uint32_t *dePosicao = malloc(total * sizeof(*dePosicao));
+    if (posicao == NULL || dePosicao == NULL)
+    {
+        printf("Erro ao alocar memória para congelar a mansão.\n");
+        exit(1);
+    }
+    if (ordem == ORDEM_VEB)
+    {
+        LayoutVeb l = {esq, dir, posicao, 0, {NULL, 0, 0}};
+        disporVeb(&l, 0, bfs.altura);
+        free(l.pilha.v);
+    }
+    else
+        for (size_t i = 0; i < total; ++i)
+            posicao[i] = (uint32_t)i;
+    for (size_t i = 0; i < total; ++i)
+        dePosicao[posicao[i]] = (uint32_t)i;
+
+    // cópia na ordem final, para os nomes longos também saírem nessa ordem na arena
+    m->total = total;
+    m->comodos = alocarContado(MEM_COMODOS, total, total * sizeof(*m->comodos));
+    if (m->comodos == NULL)
+    {
+        printf("Erro ao alocar memória para congelar a mansão.\n");
+        exit(1);
+    }
+    for (size_t p = 0; p < total; ++p)
+    {
+        uint32_t i = dePosicao[p];
+        const Comodo *o = original[i];
+        Comodo *c = &m->comodos[p];
+        c->nome = extraTexto(o->nome.tam) ? montarTexto(o->nome.longo, o->nome.tam, reservarArena(&m->textos, o->nome.tam + 1, 1))
+                                          : o->nome;
+        c->pista = o->pista;
+        c->esquerda = esq[i] != UINT32_MAX ? &m->comodos[posicao[esq[i]]] : NULL;
+        c->direita = dir[i] != UINT32_MAX ? &m->comodos[posicao[dir[i]]] : NULL;
+    }
+    free(dePosicao);
+    free(posicao);
+    free(dir);
+    free(esq);
+    free(original);
+    return m;
+}
+
+void liberarMansaoCongelada(MansaoCongelada *m)
+{
+    if (m == NULL)
+        return;
+    if (m->comodos != NULL)
+        liberarContado(MEM_COMODOS, m->comodos, m->total, m->total * sizeof(*m->comodos));
+    liberarArena(&m->textos);
+    free(m);
+}
+
+// ---------------------------------
+// Mansão sucinta (LOUDS binário)
+// ---------------------------------
+// Com os cômodos numerados em BFS, a forma da árvore cabe em 2 bits por
+// cômodo: bit 2i diz se i tem filho à esquerda e 2i+1 se tem à direita. Os
+// filhos aparecem na BFS na mesma ordem dos seus bits 1, então o filho do
+// bit p é o cômodo rank(p) + 1, e o pai de j sai do bit do j-ésimo 1:
+// select(j - 1) / 2. rank usa um contador por bloco de 8 palavras (como o
+// hash perfeito): O(1), no máximo 8 popcounts. select parte do diretório de
+// amostras (o bloco do 1 de número 512k) e faz busca binária nos contadores
+// dos blocos entre duas amostras: O(log b), com b os blocos entre elas (b = 1
+// ou 2 quando os uns são densos; uma fileira longa de folhas na BFS, só zeros,
+// alarga b, mas nunca vira varredura), depois até 8 palavras e um select
+// dentro da palavra em até 16 passos. Nomes e pistas ficam em
+// blocos de texto contínuos, com as pistas repetidas guardadas uma vez só.
+// Tudo mora num bloco sem ponteiros, que vai para um arquivo com um write e
+// volta com um mmap.
+
+#define MAGICA_SUCINTA "DQSUC01"
+#define GRUPO_NOMES 256 // cômodos por entrada de baseNome
+#define AMOSTRA_SELECT 512
+
+static size_t alinhar8(size_t n)
+{
+    return (n + 7) & ~(size_t)7;
+}
+
+// Aponta as seções de m para dentro do bloco c e devolve o tamanho total do bloco
+static size_t secoesSucinta(const CabecalhoSucinta *c, MansaoSucinta *m)
+{
+    size_t palavras = (2 * c->total + 63) / 64 + 1;
+    size_t tam[] = {
+        palavras * sizeof(uint64_t),
+        (palavras / 8 + 2) * sizeof(uint32_t),
+        (c->totalUns / AMOSTRA_SELECT + 2) * sizeof(uint32_t),
+        (c->total / GRUPO_NOMES + 1) * sizeof(uint64_t),
+        c->total * sizeof(uint32_t),
+        c->total * sizeof(uint32_t),
+        c->totalPistas * sizeof(uint32_t),
+        c->bytesNomes,
+        c->bytesPistas,
+    };
+    char *p = (char *)c;
+    size_t off[sizeof(tam) / sizeof(tam[0])], fim = alinhar8(sizeof(*c));
+    for (size_t k = 0; k < sizeof(tam) / sizeof(tam[0]); ++k)
+    {
+        off[k] = fim;
+        fim += alinhar8(tam[k]);
+    }
+    m->bits = (const uint64_t *)(p + off[0]);
+    m->rank = (const uint32_t *)(p + off[1]);
+    m->amostras = (const uint32_t *)(p + off[2]);
+    m->baseNome = (const uint64_t *)(p + off[3]);
+    m->offNome = (const uint32_t *)(p + off[4]);
+    m->pistaDe = (const uint32_t *)(p + off[5]);
+    m->offPista = (const uint32_t *)(p + off[6]);
+    m->nomes = p + off[7];
+    m->pistas = p + off[8];
+    m->total = c->total;
+    m->totalPistas = c->totalPistas;
+    m->totalUns = c->totalUns;
+    return fim;
+}
+
+// Pista -> id, por endereçamento aberto sobre o texto (ids na ordem de chegada)
+typedef struct
+{
+    const char **texto; // por id
+    uint32_t *vaga;     // id + 1 (0 = livre)
+    size_t total, mascara, bytes;
+} IdsPistaSucinta;
+
+static uint32_t idPistaSucinta(IdsPistaSucinta *t, const char *pista)
+{
+    if (2 * (t->total + 1) > t->mascara)
+    {
+        size_t cap = t->mascara ? 2 * (t->mascara + 1) : 1024;
+        uint32_t *vaga = calloc(cap, sizeof(*vaga));
+        const char **texto = realloc(t->texto, cap / 2 * sizeof(*texto));
+        if (vaga == NULL || texto == NULL)
+        {
+            printf("Erro ao alocar memória para a mansão sucinta.\n");
+            exit(1);
+        }
+        for (size_t id = 0; id < t->total; ++id)
+        {
+            size_t h = hashSemente(texto[id], 7) & (cap - 1);
+            while (vaga[h])
+                h = (h + 1) & (cap - 1);
+            vaga[h] = (uint32_t)id + 1;
+        }
+        free(t->vaga);
+        t->vaga = vaga;
+        t->texto = texto;
+        t->mascara = cap - 1;
+    }
+    size_t h = hashSemente(pista, 7) & t->mascara;
+    for (; t->vaga[h]; h = (h + 1) & t->mascara)
+        if (strcmp(t->texto[t->vaga[h] - 1], pista) == 0)
+            return t->vaga[h] - 1;
+    t->texto[t->total] = pista;
+    t->vaga[h] = (uint32_t)++t->total;
+    t->bytes += strlen(pista) + 1;
+    return (uint32_t)t->total - 1;
+}
+
+MansaoSucinta *sucintarMansao(const Comodo *raiz)
+{
+    NumeracaoBFS bfs;
+    numerarBFS(raiz, &bfs);
+    size_t n = bfs.total;
+
+    // pistas distintas (id 0 é a pista vazia) e tamanho dos nomes
+    CabecalhoSucinta cab;
+    memset(&cab, 0, sizeof(cab));
+    IdsPistaSucinta ids;
+    memset(&ids, 0, sizeof(ids));
+    uint32_t *pistaDe = malloc(n * sizeof(*pistaDe));
+    if (pistaDe == NULL)
+    {
+        printf("Erro ao alocar memória para a mansão sucinta.\n");
+        exit(1);
+    }
+    idPistaSucinta(&ids, "");
+    for (size_t i = 0; i < n; ++i)
+    {
+        pistaDe[i] = idPistaSucinta(&ids, lerTexto(&bfs.original[i]->pista));
+        cab.bytesNomes += bfs.original[i]->nome.tam + 1;
+        cab.totalUns += (bfs.esq[i] != UINT32_MAX) + (bfs.dir[i] != UINT32_MAX);
+    }
+    memcpy(cab.magica, MAGICA_SUCINTA, sizeof(cab.magica));
+    cab.total = n;
+    cab.totalPistas = ids.total;
+    cab.bytesPistas = ids.bytes;
+
+    MansaoSucinta *m = calloc(1, sizeof(*m));
+    MansaoSucinta tmp;
+    cab.tamBloco = secoesSucinta(&cab, &tmp);
+    CabecalhoSucinta *bloco = m ? alocarContado(MEM_COMODOS, n, cab.tamBloco) : NULL;
+    if (bloco == NULL)
+    {
+        printf("Erro ao alocar memória para a mansão sucinta.\n");
+        exit(1);
+    }
+    memset(bloco, 0, cab.tamBloco);
+    *bloco = cab;
+    m->bloco = bloco;
+    secoesSucinta(bloco, m);
+    // as seções são só leitura para quem navega; aqui é quem as preenche
+    uint64_t *bits = (uint64_t *)m->bits;
+    uint32_t *rank = (uint32_t *)m->rank, *amostras = (uint32_t *)m->amostras;
+    uint64_t *baseNome = (uint64_t *)m->baseNome;
+    uint32_t *offNome = (uint32_t *)m->offNome, *offPista = (uint32_t *)m->offPista;
+    char *nomes = (char *)m->nomes, *pistas = (char *)m->pistas;
+
+    size_t palavras = (2 * n + 63) / 64 + 1, uns = 0, proximaAmostra = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (bfs.esq[i] != UINT32_MAX)
+            bits[(2 * i) >> 6] |= 1ull << ((2 * i) & 63);
+        if (bfs.dir[i] != UINT32_MAX)
+            bits[(2 * i + 1) >> 6] |= 1ull << ((2 * i + 1) & 63);
+    }
+    for (size_t w = 0; w < palavras; ++w)
+    {
+        if ((w & 7) == 0)
+            rank[w >> 3] = (uint32_t)uns;
+        size_t c = (size_t)__builtin_popcountll(bits[w]);
+        for (; proximaAmostra * AMOSTRA_SELECT < uns + c; ++proximaAmostra)
+            amostras[proximaAmostra] = (uint32_t)(w >> 3);
+        uns += c;
+    }
+    for (size_t b = (palavras + 7) / 8; b < palavras / 8 + 2; ++b)
+        rank[b] = (uint32_t)uns;
+    for (; proximaAmostra < uns / AMOSTRA_SELECT + 2; ++proximaAmostra)
+        amostras[proximaAmostra] = (uint32_t)(palavras / 8);
+
+    size_t off = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i % GRUPO_NOMES == 0)
+            baseNome[i / GRUPO_NOMES] = off;
+        offNome[i] = (uint32_t)(off - baseNome[i / GRUPO_NOMES]);
+        memcpy(nomes + off, lerTexto(&bfs.original[i]->nome), bfs.original[i]->nome.tam + 1);
+        off += bfs.original[i]->nome.tam + 1;
+    }
+    memcpy((uint32_t *)m->pistaDe, pistaDe, n * sizeof(*pistaDe));
+    off = 0;
+    for (size_t id = 0; id < ids.total; ++id)
+    {
+        size_t tam = strlen(ids.texto[id]) + 1;
+        offPista[id] = (uint32_t)off;
+        memcpy(pistas + off, ids.texto[id], tam);
+        off += tam;
+    }
+
+    free(ids.texto);
+    free(ids.vaga);
+    free(pistaDe);
+    free(bfs.original);
+    free(bfs.esq);
+    free(bfs.dir);
+    return m;
+}
+
+// 1s nas posições [0, pos)
+static inline size_t rankSucinto(const MansaoSucinta *m, size_t pos)
+{
+    size_t palavra = pos >> 6;
+    size_t r = m->rank[palavra >> 3];
+    for (size_t w = palavra & ~(size_t)7; w < palavra; ++w)
+        r += (size_t)__builtin_popcountll(m->bits[w]);
+    return r + (size_t)__builtin_popcountll(m->bits[palavra] & ((1ull << (pos & 63)) - 1));
+}
+
+// Posição do 1 de número r (a partir de 0) na palavra x, r < popcount(x): as
+// contagens por byte somadas por multiplicação acham o byte, e o bit sai em
+// no máximo 8 passos dentro dele
+static inline size_t selectPalavra(uint64_t x, size_t r)
+{
+    uint64_t c = x - ((x >> 1) & 0x5555555555555555ull);
+    c = (c & 0x3333333333333333ull) + ((c >> 2) & 0x3333333333333333ull);
+    c = (c + (c >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    uint64_t acumulado = c * 0x0101010101010101ull; // byte i: uns nos bytes 0..i
+    size_t byte = 0;
+    while (((acumulado >> (byte * 8)) & 0xFF) <= r)
+        byte++;
+    if (byte > 0)
+        r -= (acumulado >> (byte * 8 - 8)) & 0xFF;
+    unsigned bits = (unsigned)(x >> (byte * 8)) & 0xFF;
+    for (; r > 0; --r)
+        bits &= bits - 1;
+    return byte * 8 + (size_t)__builtin_ctz(bits);
+}
+
+// Posição do 1 que tem r uns antes dele (r < totalUns)
+static size_t selectSucinto(const MansaoSucinta *m, size_t r)
+{
+    // último bloco com rank <= r, entre as duas amostras vizinhas
+    size_t lo = m->amostras[r / AMOSTRA_SELECT], hi = m->amostras[r / AMOSTRA_SELECT + 1];
+    while (lo < hi)
+    {
+        size_t meio = lo + (hi - lo + 1) / 2;
+        if (m->rank[meio] <= r)
+            lo = meio;
+        else
+            hi = meio - 1;
+    }
+    size_t w = lo * 8;
+    r -= m->rank[lo];
+    for (;; ++w)
+    {
+        size_t c = (size_t)__builtin_popcountll(m->bits[w]);
+        if (r < c)
+            break;
+        r -= c;
+    }
+    return w * 64 + selectPalavra(m->bits[w], r);
+}
+
+// Filho do cômodo i do lado (0 = esquerda, 1 = direita); SIZE_MAX se não há
+size_t filhoSucinto(const MansaoSucinta *m, size_t i, int lado)
+{
+    size_t p = 2 * i + (size_t)lado;
+    if (!((m->bits[p >> 6] >> (p & 63)) & 1))
+        return SIZE_MAX;
+    return rankSucinto(m, p) + 1;
+}
+
+// Pai do cômodo i; SIZE_MAX para o Hall. Custa um selectSucinto (ver o
+// comentário do formato): busca binária entre amostras, não varredura.
+size_t paiSucinto(const MansaoSucinta *m, size_t i)
+{
+    if (i == 0 || i >= m->total)
+        return SIZE_MAX;
+    return selectSucinto(m, i - 1) / 2;
+}
+
+const char *nomeSucinto(const MansaoSucinta *m, size_t i)
+{
+    return m->nomes + m->baseNome[i / GRUPO_NOMES] + m->offNome[i];
+}
+
+const char *pistaSucinta(const MansaoSucinta *m, size_t i)
+{
+    return m->pistas + m->offPista[m->pistaDe[i]];
+}
+
+// Grava o bloco inteiro em fd; 0 em sucesso
+int gravarMansaoSucinta(const MansaoSucinta *m, int fd)
+{
+    const char *p = (const char *)m->bloco;
+    size_t falta = m->bloco->tamBloco;
+    while (falta > 0)
+    {
+        ssize_t n = write(fd, p, falta);
+        if (n <= 0)
+            return -1;
+        p += n;
+        falta -= (size_t)n;
+    }
+    return 0;
+}
+
+// Confere uma vez, depois de mapear, tudo o que a navegação usa como índice:
+// a forma (uns, filhos depois do pai na BFS), rank, amostras, deslocamentos
+// de nomes e pistas e ids de pista. Com isso um arquivo corrompido é recusado
+// em vez de levar a leituras fora do bloco.
+static int validarMansaoSucinta(const MansaoSucinta *m, const CabecalhoSucinta *c)
+{
+    size_t palavras = (2 * m->total + 63) / 64 + 1, uns = 0, proximaAmostra = 0;
+    if (m->totalUns != (m->total ? m->total - 1 : 0))
+        return 0;
+    for (size_t w = 0; w < palavras; ++w)
+    {
+        if ((w & 7) == 0 && m->rank[w >> 3] != uns)
+            return 0;
+        uint64_t x = m->bits[w];
+        if (w * 64 + 64 > 2 * m->total && x >> (2 * m->total > w * 64 ? 2 * m->total - w * 64 : 0) != 0)
+            return 0; // bits além do último cômodo
+        for (uint64_t resto = x; resto; resto &= resto - 1)
+        {
+            size_t pos = w * 64 + (size_t)__builtin_ctzll(resto);
+            size_t filho = uns + (size_t)__builtin_popcountll(x & ((1ull << (pos & 63)) - 1)) + 1;
+            if (filho <= pos / 2 || filho >= m->total)
+                return 0;
+        }
+        size_t cont = (size_t)__builtin_popcountll(x);
+        for (; proximaAmostra * AMOSTRA_SELECT < uns + cont; ++proximaAmostra)
+            if (m->amostras[proximaAmostra] != (uint32_t)(w >> 3))
+                return 0;
+        uns += cont;
+    }
+    for (size_t b = (palavras + 7) / 8; b < palavras / 8 + 2; ++b)
+        if (m->rank[b] != uns)
+            return 0;
+    for (; proximaAmostra < uns / AMOSTRA_SELECT + 2; ++proximaAmostra)
+        if (m->amostras[proximaAmostra] != (uint32_t)(palavras / 8))
+            return 0;
+
+    // textos terminam dentro das suas seções, então qualquer deslocamento válido dá uma string
+    if ((m->total > 0 && (c->bytesNomes == 0 || m->nomes[c->bytesNomes - 1] != '\0')) || c->bytesPistas == 0 ||
+        m->pistas[c->bytesPistas - 1] != '\0')
+        return 0;
+    for (size_t i = 0; i < m->total; ++i)
+        if (m->baseNome[i / GRUPO_NOMES] >= c->bytesNomes || m->offNome[i] >= c->bytesNomes - m->baseNome[i / GRUPO_NOMES] ||
+            m->pistaDe[i] >= m->totalPistas)
+            return 0;
+    for (size_t id = 0; id < m->totalPistas; ++id)
+        if (m->offPista[id] >= c->bytesPistas)
+            return 0;
+    return 1;
+}
+
+// Mapeia (só leitura) uma mansão gravada por gravarMansaoSucinta; NULL se fd
+// não contém uma íntegra (cabeçalho, tamanhos e índices conferidos antes do uso)
+MansaoSucinta *mapearMansaoSucinta(int fd)
+{
+    CabecalhoSucinta cab;
+    if (pread(fd, &cab, sizeof(cab), 0) != (ssize_t)sizeof(cab) || memcmp(cab.magica, MAGICA_SUCINTA, sizeof(cab.magica)) != 0)
+        return NULL;
+    // limites antes de somar tamanhos: ids e contadores são de 32 bits e os
+    // textos cabem no arquivo, então secoesSucinta não estoura
+    off_t tamArquivo = lseek(fd, 0, SEEK_END);
+    if (tamArquivo < 0 || cab.total > UINT32_MAX || cab.totalPistas == 0 || cab.totalPistas > UINT32_MAX ||
+        cab.totalUns > 2 * cab.total || cab.bytesNomes > (uint64_t)tamArquivo || cab.bytesPistas > (uint64_t)tamArquivo ||
+        cab.bytesPistas > (uint64_t)UINT32_MAX + 1 || cab.tamBloco > (uint64_t)tamArquivo)
+        return NULL;
+    MansaoSucinta conferir;
+    if (secoesSucinta(&cab, &conferir) != cab.tamBloco)
+        return NULL;
+    void *bloco = mmap(NULL, cab.tamBloco, PROT_READ, MAP_SHARED, fd, 0);
+    MansaoSucinta *m = bloco != MAP_FAILED ? calloc(1, sizeof(*m)) : NULL;
+    if (m == NULL)
+    {
+        if (bloco != MAP_FAILED)
+            munmap(bloco, cab.tamBloco);
+        return NULL;
+    }
+    m->bloco = bloco;
+    m->mapeada = 1;
+    secoesSucinta(m->bloco, m);
+    // o cabeçalho conferido é a cópia lida antes; o do mapa é o mesmo arquivo
+    if (memcmp(m->bloco, &cab, sizeof(cab)) != 0 || !validarMansaoSucinta(m, &cab))
+    {
+        munmap(bloco, cab.tamBloco);
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+void liberarMansaoSucinta(MansaoSucinta *m)
+{
+    if (m == NULL)
+        return;
+    if (m->mapeada)
+        munmap(m->bloco, m->bloco->tamBloco);
+    else
+        liberarContado(MEM_COMODOS, m->bloco, m->total, m->bloco->tamBloco);
+    free(m);
+}
+
+// ---------------------------------
+// Mansão sob demanda
+// ---------------------------------
+// Cada cômodo é criado só quando o jogador chega ao pai dele. A semente de um
+// filho sai da semente do pai e do lado escolhido, então o mesmo caminho dá
+// sempre o mesmo cômodo (nome, pista e filhos), mesmo depois de despejado e
+// recriado. Os ponteiros da árvore são o próprio índice: não há tabela por
+// semente. Uma lista LRU limita os cômodos vivos; ao despejar, o ponteiro do
+// pai volta a NULL e o cômodo é refeito quando o pai for preparado de novo.
+
+#define CHANCE_FILHO_SOB_DEMANDA 85 // % de cada lado existir (abaixo do Hall)
+
+static ComodoSobDemanda *criarComodoSobDemanda(MansaoSobDemanda *m, ComodoSobDemanda *pai, uint64_t semente, uint64_t indice,
+                                               uint32_t profundidade)
+{
+    char nome[64];
+    size_t tam;
+    uint64_t h = misturar64(semente);
+    if (pai == NULL)
+        tam = (size_t)(copiarTexto(nome, "Hall de Entrada") - nome);
+    else
+    {
+        // "<tipo> <ala> <índice>", como no gerador (índice de heap do caminho)
+        char *p = copiarTexto(nome, tiposComodo[h & 15]);
+        *p++ = ' ';
+        p = copiarTexto(p, alasComodo[(h >> 4) & 3]);
+        *p++ = ' ';
+        p = escreverIndice(p, indice);
+        tam = (size_t)(p - nome);
+    }
+    ComodoSobDemanda *c = alocarContado(MEM_COMODOS, 1, sizeof(ComodoSobDemanda) + extraTexto(tam));
+    if (c == NULL)
+    {
+        printf("Erro ao alocar memória para cômodo.\n");
+        exit(1);
+    }
+    c->comodo.nome = montarTexto(nome, tam, (char *)(c + 1));
+    // 90% de chance de ter pista, como em distribuirPistas
+    if (m->totalBase > 0 && (h >> 8) % 100 < 90)
+        c->comodo.pista = referenciarTexto(m->base[(h >> 16) % (uint64_t)m->totalBase].pista);
+    else
+        c->comodo.pista = referenciarTexto("");
+    c->comodo.esquerda = c->comodo.direita = NULL;
+    c->semente = semente;
+    c->indice = indice;
+    c->profundidade = profundidade;
+    c->filhosProntos = 0;
+    c->pai = pai;
+    c->anterior = c->proximo = NULL;
+    m->criados++;
+    m->vivos++;
+    return c;
+}
+
+// Semente do filho do lado (0 = esquerda, 1 = direita); 0 se não existe
+static uint64_t sementeFilho(const MansaoSobDemanda *m, const ComodoSobDemanda *c, int lado)
+{
+    if (c->profundidade >= m->profundidadeMaxima)
+        return 0;
+    uint64_t s = misturar64(c->semente ^ (0x9E3779B97F4A7C15ull * (uint64_t)(lado + 1)));
+    if (c != m->hall && (s >> 32) % 100 >= CHANCE_FILHO_SOB_DEMANDA) // o Hall tem sempre os dois lados
+        return 0;
+    return s | 1; // nunca 0
+}
+
+static void tirarDaLRU(MansaoSobDemanda *m, ComodoSobDemanda *c)
+{
+    if (c->anterior)
+        c->anterior->proximo = c->proximo;
+    else if (m->maisRecente == c)
+        m->maisRecente = c->proximo;
+    if (c->proximo)
+        c->proximo->anterior = c->anterior;
+    else if (m->menosRecente == c)
+        m->menosRecente = c->anterior;
+    c->anterior = c->proximo = NULL;
+}
+
+// Põe na frente da LRU (o Hall fica fora: nunca é despejado)
+static void tocarComodo(MansaoSobDemanda *m, ComodoSobDemanda *c)
+{
+    if (c == m->hall)
+        return;
+    tirarDaLRU(m, c);
+    c->proximo = m->maisRecente;
+    if (m->maisRecente)
+        m->maisRecente->anterior = c;
+    m->maisRecente = c;
+    if (m->menosRecente == NULL)
+        m->menosRecente = c;
+}
+
+static void despejarComodo(MansaoSobDemanda *m, ComodoSobDemanda *c)
+{
+    tirarDaLRU(m, c);
+    if (c->pai != NULL)
+    {
+        if (c->pai->comodo.esquerda == &c->comodo)
+            c->pai->comodo.esquerda = NULL;
+        else
+            c->pai->comodo.direita = NULL;
+        c->pai->filhosProntos = 0;
+    }
+    // filhos vivos perdem o pai; continuam na LRU e saem quando chegar a vez
+    ComodoSobDemanda *filhos[2] = {(ComodoSobDemanda *)c->comodo.esquerda, (ComodoSobDemanda *)c->comodo.direita};
+    for (int lado = 0; lado < 2; ++lado)
+        if (filhos[lado] != NULL)
+            filhos[lado]->pai = NULL;
+    liberarContado(MEM_COMODOS, c, 1, sizeof(ComodoSobDemanda) + extraTexto(c->comodo.nome.tam));
+    m->vivos--;
+    m->despejados++;
+}
+
+MansaoSobDemanda *criarMansaoSobDemanda(uint64_t semente, size_t capacidade, uint32_t profundidadeMaxima,
+                                        LigacaoPistaSuspeito *base, int totalBase)
+{
+    MansaoSobDemanda *m = calloc(1, sizeof(*m));
+    if (m == NULL)
+    {
+        printf("Erro ao alocar memória para a mansão sob demanda.\n");
+        exit(1);
+    }
+    // o cômodo atual e os dois filhos precisam caber ao mesmo tempo
+    m->capacidade = capacidade < 3 ? 3 : capacidade;
+    // índices de heap cabem em 64 bits até a profundidade 62
+    m->profundidadeMaxima = profundidadeMaxima > 62 ? 62 : profundidadeMaxima;
+    m->semente = semente;
+    m->base = base;
+    m->totalBase = totalBase;
+    m->hall = criarComodoSobDemanda(m, NULL, misturar64(semente) | 1, 0, 0);
+    m->vivos = 0; // a capacidade conta só os cômodos despejáveis
+    return m;
+}
+
+// Garante os filhos de c (um cômodo vivo desta mansão) e o marca como recente;
+// depois despeja pela LRU até caber na capacidade. c e seus filhos não saem.
+void prepararComodo(MansaoSobDemanda *m, const Comodo *atual)
+{
+    ComodoSobDemanda *c = (ComodoSobDemanda *)atual;
+    if (!c->filhosProntos)
+    {
+        for (int lado = 0; lado < 2; ++lado)
+        {
+            Comodo **destino = lado == 0 ? &c->comodo.esquerda : &c->comodo.direita;
+            uint64_t s = sementeFilho(m, c, lado);
+            if (s == 0 || *destino != NULL)
+                continue;
+            ComodoSobDemanda *filho = criarComodoSobDemanda(m, c, s, 2 * c->indice + 1 + (uint64_t)lado, c->profundidade + 1);
+            *destino = &filho->comodo;
+            tocarComodo(m, filho);
+        }
+        c->filhosProntos = 1;
+    }
+    for (int lado = 0; lado < 2; ++lado)
+    {
+        Comodo *f = lado == 0 ? c->comodo.esquerda : c->comodo.direita;
+        if (f != NULL)
+            tocarComodo(m, (ComodoSobDemanda *)f);
+    }
+    tocarComodo(m, c);
+    while (m->vivos > m->capacidade && m->menosRecente != NULL)
+        despejarComodo(m, m->menosRecente);
+    if (m->vivos > m->picoVivos)
+        m->picoVivos = m->vivos;
+}
+
+void liberarMansaoSobDemanda(MansaoSobDemanda *m)
+{
+    if (m == NULL)
+        return;
+    while (m->menosRecente != NULL)
+        despejarComodo(m, m->menosRecente);
+    liberarContado(MEM_COMODOS, m->hall, 1, sizeof(ComodoSobDemanda) + extraTexto(m->hall->comodo.nome.tam));
+    free(m);
+}
+
+// ---------------------------------
+// Pontuação por evidências ponderadas
+// ---------------------------------
+// A pontuação de cada suspeito é a soma dos pesos das ligações das pistas já
+// coletadas. Ela é mantida a cada coleta (um passo de produto matriz-vetor
+// esparso só na coluna da pista nova), em vez de recontar tudo no fim.
+
+// Junta base (peso 1) e extras num vetor só; o chamador libera com free()
+LigacaoPonderada *montarLigacoesPonderadas(LigacaoPistaSuspeito base[], int totalBase, LigacaoPonderada extras[], int totalExtras)
+{
+    LigacaoPonderada *lig = malloc((size_t)(totalBase + totalExtras) * sizeof(*lig) + 1);
+    if (lig == NULL)
+    {
+        printf("Erro ao alocar memória para ligações ponderadas.\n");
+        exit(1);
+    }
+    for (int i = 0; i < totalBase; ++i)
+        lig[i] = (LigacaoPonderada){base[i].pista, base[i].suspeito, 1.0};
+    for (int i = 0; i < totalExtras; ++i)
+        lig[totalBase + i] = extras[i];
+    return lig;
+}
+
+// ---------------------------------
+// Relação pista <-> suspeito (CSR nos dois sentidos)
+// ---------------------------------
+// Nome -> posição em suspeitos[], por hash perfeito (uma sonda e um strcmp)
+static void construirIndiceSuspeitos(IndiceSuspeitos *is, char *suspeitos[], int total)
+{
+    int32_t *pos = malloc((size_t)total * sizeof(*pos) + 1);
+    is->id = malloc((size_t)total * sizeof(*is->id) + 1);
+    is->nomes = suspeitos;
+    is->total = total;
+    if (pos == NULL || is->id == NULL)
+    {
+        printf("Erro ao alocar memória para o índice de suspeitos.\n");
+        exit(1);
+    }
+    if (construirHashPerfeito(&is->hp, (const char *const *)suspeitos, (uint32_t)total, pos) != 0)
+    {
+        printf("Erro ao montar o índice de suspeitos.\n");
+        exit(1);
+    }
+    for (int k = 0; k < total; ++k)
+        if (pos[k] >= 0)
+            is->id[pos[k]] = k;
+    free(pos);
+}
+
+// Posição do suspeito, ou -1 se o nome não está na lista
+static int idSuspeito(const IndiceSuspeitos *is, const char *nome)
+{
+    if (is->total == 0)
+        return -1;
+    int k = is->id[posicaoHashPerfeito(&is->hp, nome)];
+    return strcmp(is->nomes[k], nome) == 0 ? k : -1;
+}
+
+static void liberarIndiceSuspeitos(IndiceSuspeitos *is)
+{
+    liberarHashPerfeito(&is->hp);
+    free(is->id);
+}
+
+typedef enum
+{
+    VETOR_PISTAS,
+    VETOR_INICIO_PISTA,
+    VETOR_INICIO_SUSPEITO,
+    VETOR_IDS_LIGACAO,  // suspeitoDe e pistaDe
+    VETOR_PESOS_LIGACAO // pesoPista e pesoSuspeito
+} VetorRelacao;
+
+// Bytes de um vetor da relação, deduzidos dos totais (alocação e liberação contadas)
+static size_t tamanhoVetorRelacao(const RelacaoPistaSuspeito *rel, VetorRelacao vetor)
+{
+    size_t ligacoes = (size_t)rel->totalLigacoes;
+    switch (vetor)
+    {
+    case VETOR_PISTAS:
+        return (size_t)rel->totalPistas * sizeof(*rel->pistas) + 1;
+    case VETOR_INICIO_PISTA:
+        return ((size_t)rel->totalPistas + 1) * sizeof(*rel->inicioPista);
+    case VETOR_INICIO_SUSPEITO:
+        return ((size_t)rel->totalSuspeitos + 1) * sizeof(*rel->inicioSuspeito);
+    case VETOR_IDS_LIGACAO:
+        return ligacoes * sizeof(*rel->suspeitoDe) + 1;
+    default:
+        return ligacoes * sizeof(*rel->pesoPista) + 1;
+    }
+}
+
+// Montagem: ids de suspeito e de pista por hash perfeito, uma passada que conta
+// o grau de cada pista e de cada suspeito ao mesmo tempo, soma de prefixos e
+// uma passada de preenchimento. Ligações para suspeitos fora da lista são
+// ignoradas; a ordem das ligações da base é mantida dentro de cada lista.
+void construirRelacao(RelacaoPistaSuspeito *rel, const LigacaoPonderada lig[], int totalLig, char *suspeitos[], int totalSuspeitos)
+{
+    memset(rel, 0, sizeof(*rel));
+    rel->totalSuspeitos = totalSuspeitos;
+
+    IndiceSuspeitos nomes;
+    construirIndiceSuspeitos(&nomes, suspeitos, totalSuspeitos);
+    const char **chavesLig = malloc((size_t)totalLig * sizeof(*chavesLig) + 1);
+    int32_t *posLig = malloc((size_t)totalLig * sizeof(*posLig) + 1);
+    int *suspeitoLig = malloc((size_t)totalLig * sizeof(*suspeitoLig) + 1);
+    if (!chavesLig || !posLig || !suspeitoLig)
+    {
+        printf("Erro ao alocar memória para a relação pista-suspeito.\n");
+        exit(1);
+    }
+    for (int i = 0; i < totalLig; ++i)
+    {
+        chavesLig[i] = lig[i].pista;
+        suspeitoLig[i] = idSuspeito(&nomes, lig[i].suspeito);
+    }
+    liberarIndiceSuspeitos(&nomes);
+
+    // vocabulário de pistas (repetidas recebem posição -1 e herdam a da primeira)
+    if (construirHashPerfeito(&rel->indicePistas, chavesLig, (uint32_t)totalLig, posLig) != 0)
+    {
+        printf("Erro ao montar a relação pista-suspeito.\n");
+        exit(1);
+    }
+    rel->totalPistas = (int)rel->indicePistas.n;
+    rel->pistas = alocarContado(MEM_RELACAO, 1, tamanhoVetorRelacao(rel, VETOR_PISTAS));
+    rel->inicioPista = alocarContado(MEM_RELACAO, 1, tamanhoVetorRelacao(rel, VETOR_INICIO_PISTA));
+    rel->inicioSuspeito = alocarContado(MEM_RELACAO, 1, tamanhoVetorRelacao(rel, VETOR_INICIO_SUSPEITO));
+    if (!rel->pistas || !rel->inicioPista || !rel->inicioSuspeito)
+    {
+        printf("Erro ao alocar memória para a relação pista-suspeito.\n");
+        exit(1);
+    }
+    memset(rel->inicioPista, 0, tamanhoVetorRelacao(rel, VETOR_INICIO_PISTA));
+    memset(rel->inicioSuspeito, 0, tamanhoVetorRelacao(rel, VETOR_INICIO_SUSPEITO));
+
+    // uma passada: texto de cada pista e grau nos dois sentidos
+    for (int i = 0; i < totalLig; ++i)
+    {
+        if (posLig[i] < 0)
+            posLig[i] = (int32_t)posicaoHashPerfeito(&rel->indicePistas, lig[i].pista);
+        else
+            rel->pistas[posLig[i]] = lig[i].pista;
+        if (suspeitoLig[i] >= 0)
+        {
+            rel->inicioPista[posLig[i] + 1]++;
+            rel->inicioSuspeito[suspeitoLig[i] + 1]++;
+            rel->totalLigacoes++;
+        }
+    }
+    for (int p = 0; p < rel->totalPistas; ++p)
+        rel->inicioPista[p + 1] += rel->inicioPista[p];
+    for (int k = 0; k < totalSuspeitos; ++k)
+        rel->inicioSuspeito[k + 1] += rel->inicioSuspeito[k];
+
+    rel->suspeitoDe = alocarContado(MEM_RELACAO, 1, tamanhoVetorRelacao(rel, VETOR_IDS_LIGACAO));
+    rel->pesoPista = alocarContado(MEM_RELACAO, 1, tamanhoVetorRelacao(rel, VETOR_PESOS_LIGACAO));
+    rel->pistaDe = alocarContado(MEM_RELACAO, 1, tamanhoVetorRelacao(rel, VETOR_IDS_LIGACAO));
+    rel->pesoSuspeito = alocarContado(MEM_RELACAO, 1, tamanhoVetorRelacao(rel, VETOR_PESOS_LIGACAO));
+    int *cursorPista = malloc(((size_t)rel->totalPistas + 1) * sizeof(*cursorPista));
+    int *cursorSuspeito = malloc(((size_t)totalSuspeitos + 1) * sizeof(*cursorSuspeito));
+    if (!rel->suspeitoDe || !rel->pesoPista || !rel->pistaDe || !rel->pesoSuspeito || !cursorPista || !cursorSuspeito)
+    {
+        printf("Erro ao alocar memória para a relação pista-suspeito.\n");
+        exit(1);
+    }
+    memcpy(cursorPista, rel->inicioPista, ((size_t)rel->totalPistas + 1) * sizeof(*cursorPista));
+    memcpy(cursorSuspeito, rel->inicioSuspeito, ((size_t)totalSuspeitos + 1) * sizeof(*cursorSuspeito));
+    for (int i = 0; i < totalLig; ++i)
+    {
+        if (suspeitoLig[i] < 0)
+            continue;
+        int k = cursorPista[posLig[i]]++;
+        rel->suspeitoDe[k] = suspeitoLig[i];
+        rel->pesoPista[k] = lig[i].peso;
+        k = cursorSuspeito[suspeitoLig[i]]++;
+        rel->pistaDe[k] = posLig[i];
+        rel->pesoSuspeito[k] = lig[i].peso;
+    }
+
+    free(cursorPista);
+    free(cursorSuspeito);
+    free(chavesLig);
+    free(posLig);
+    free(suspeitoLig);
+}
+
+// Id da pista na relação, ou -1
+int idPistaRelacao(const RelacaoPistaSuspeito *rel, const char *pista)
+{
+    EST_INC(consultasRelacao);
+    if (rel->totalPistas == 0)
+        return -1;
+    int p = (int)posicaoHashPerfeito(&rel->indicePistas, pista);
+    return strcmp(rel->pistas[p], pista) == 0 ? p : -1;
+}
+
+// Suspeitos ligados a uma pista (vetor contíguo, *qtd elementos); pesos em pesoPista
+const int *suspeitosDaPista(const RelacaoPistaSuspeito *rel, int pista, int *qtd)
+{
+    *qtd = rel->inicioPista[pista + 1] - rel->inicioPista[pista];
+    return rel->suspeitoDe + rel->inicioPista[pista];
+}
+
+// Pistas ligadas a um suspeito (vetor contíguo, *qtd elementos); pesos em pesoSuspeito
+const int *pistasDoSuspeito(const RelacaoPistaSuspeito *rel, int suspeito, int *qtd)
+{
+    *qtd = rel->inicioSuspeito[suspeito + 1] - rel->inicioSuspeito[suspeito];
+    return rel->pistaDe + rel->inicioSuspeito[suspeito];
+}
+
+void liberarRelacao(RelacaoPistaSuspeito *rel)
+{
+    liberarHashPerfeito(&rel->indicePistas);
+    liberarContado(MEM_RELACAO, rel->pistas, 1, tamanhoVetorRelacao(rel, VETOR_PISTAS));
+    liberarContado(MEM_RELACAO, rel->inicioPista, 1, tamanhoVetorRelacao(rel, VETOR_INICIO_PISTA));
+    liberarContado(MEM_RELACAO, rel->suspeitoDe, 1, tamanhoVetorRelacao(rel, VETOR_IDS_LIGACAO));
+    liberarContado(MEM_RELACAO, rel->pesoPista, 1, tamanhoVetorRelacao(rel, VETOR_PESOS_LIGACAO));
+    liberarContado(MEM_RELACAO, rel->inicioSuspeito, 1, tamanhoVetorRelacao(rel, VETOR_INICIO_SUSPEITO));
+    liberarContado(MEM_RELACAO, rel->pistaDe, 1, tamanhoVetorRelacao(rel, VETOR_IDS_LIGACAO));
+    liberarContado(MEM_RELACAO, rel->pesoSuspeito, 1, tamanhoVetorRelacao(rel, VETOR_PESOS_LIGACAO));
+    memset(rel, 0, sizeof(*rel));
+}
+
+// Prepara o motor sobre uma relação já montada (que deve viver mais que ele)
+void iniciarMotorPontuacao(MotorPontuacao *mp, const RelacaoPistaSuspeito *rel)
+{
+    mp->rel = rel;
+    mp->pontuacao = calloc((size_t)rel->totalSuspeitos + 1, sizeof(*mp->pontuacao));
+    mp->coletada = calloc((size_t)rel->totalPistas / 64 + 1, sizeof(*mp->coletada));
+    mp->totalColetadas = 0;
+    if (!mp->pontuacao || !mp->coletada)
+    {
+        printf("Erro ao alocar memória para o motor de pontuação.\n");
+        exit(1);
+    }
+}
+
+// Volta ao estado sem pistas, reaproveitando os vetores
+void zerarMotorPontuacao(MotorPontuacao *mp)
+{
+    memset(mp->pontuacao, 0, (size_t)mp->rel->totalSuspeitos * sizeof(*mp->pontuacao));
+    memset(mp->coletada, 0, ((size_t)mp->rel->totalPistas / 64 + 1) * sizeof(*mp->coletada));
+    mp->totalColetadas = 0;
+}
+
+static inline int pistaColetadaMotor(const MotorPontuacao *mp, int p)
+{
+    return (int)(mp->coletada[p >> 6] >> (p & 63) & 1);
+}
+
+// Id da pista no vocabulário do motor, ou -1
+int idPistaMotor(const MotorPontuacao *mp, const char *pista)
+{
+    return idPistaRelacao(mp->rel, pista);
+}
+
+// Soma as ligações da pista p nas pontuações; O(grau). Retorna 1 se a pista era nova.
+int coletarPistaMotor(MotorPontuacao *mp, int p)
+{
+    if (pistaColetadaMotor(mp, p))
+        return 0;
+    mp->coletada[p >> 6] |= 1ull << (p & 63);
+    mp->totalColetadas++;
+    const RelacaoPistaSuspeito *rel = mp->rel;
+    for (int k = rel->inicioPista[p]; k < rel->inicioPista[p + 1]; ++k)
+        mp->pontuacao[rel->suspeitoDe[k]] += rel->pesoPista[k];
+    return 1;
+}
+
+// Como coletarPistaMotor, pelo texto da pista; fora da relação não conta
+int registrarPistaMotor(MotorPontuacao *mp, const char *pista)
+{
+    int p = idPistaMotor(mp, pista);
+    return p >= 0 ? coletarPistaMotor(mp, p) : 0;
+}
+
+// Ids das pistas coletadas, em ordem crescente; ids[] tem totalColetadas posições
+int pistasColetadasMotor(const MotorPontuacao *mp, int ids[])
+{
+    int qtd = 0;
+    for (int w = 0; w <= mp->rel->totalPistas / 64; ++w)
+        for (uint64_t resto = mp->coletada[w]; resto; resto &= resto - 1)
+            ids[qtd++] = w * 64 + __builtin_ctzll(resto);
+    return qtd;
+}
+
+// Quantas pistas já coletadas apontam para o suspeito (percorre só as dele)
+int contarPistasColetadasSuspeito(const MotorPontuacao *mp, int suspeito)
+{
+    int qtd, cont = 0;
+    const int *pistas = pistasDoSuspeito(mp->rel, suspeito, &qtd);
+    for (int i = 0; i < qtd; ++i)
+        cont += pistaColetadaMotor(mp, pistas[i]);
+    return cont;
+}
+
+// Lista as pistas coletadas que apontam para o suspeito, com o peso de cada uma
+void listarPistasColetadasSuspeito(const MotorPontuacao *mp, char *suspeitos[], int suspeito)
+{
+    int qtd, encontrou = 0;
+    const int *pistas = pistasDoSuspeito(mp->rel, suspeito, &qtd);
+    const double *pesos = mp->rel->pesoSuspeito + mp->rel->inicioSuspeito[suspeito];
+    for (int i = 0; i < qtd; ++i)
+    {
+        if (!pistaColetadaMotor(mp, pistas[i]))
+            continue;
+        if (encontrou == 0)
+        {
+            printf("\nPistas associadas a %s:\n", suspeitos[suspeito]);
+            encontrou = 1;
+        }
+        printf(" - %s (peso %.2f)\n", mp->rel->pistas[pistas[i]], pesos[i]);
+    }
+    if (encontrou == 0)
+        printf("Nenhuma pista associada a %s.\n", suspeitos[suspeito]);
+}
+
+typedef struct
+{
+    double pontuacao;
+    int id;
+} ItemRanking;
+
+static int compararRanking(const void *a, const void *b)
+{
+    const ItemRanking *x = a, *y = b;
+    if (x->pontuacao != y->pontuacao) // valores exatos: com tolerância a ordem deixa de ser transitiva
+        return x->pontuacao > y->pontuacao ? -1 : 1;
+    return (x->id > y->id) - (x->id < y->id); // empate: ordem da lista
+}
+
+// Preenche ordem[] com os suspeitos da maior para a menor pontuação.
+// Retorna quantos têm pontuação positiva.
+int rankingMotor(const MotorPontuacao *mp, int ordem[])
+{
+    ItemRanking *itens = malloc((size_t)mp->rel->totalSuspeitos * sizeof(*itens) + 1);
+    if (itens == NULL)
+    {
+        printf("Erro ao alocar memória para o ranking.\n");
+        exit(1);
+    }
+    int positivos = 0;
+    for (int k = 0; k < mp->rel->totalSuspeitos; ++k)
+    {
+        itens[k] = (ItemRanking){mp->pontuacao[k], k};
+        if (mp->pontuacao[k] > EPSILON_PONTUACAO)
+            positivos++;
+    }
+    qsort(itens, (size_t)mp->rel->totalSuspeitos, sizeof(*itens), compararRanking);
+    for (int k = 0; k < mp->rel->totalSuspeitos; ++k)
+        ordem[k] = itens[k].id;
+    free(itens);
+    return positivos;
+}
+
+// Acusação vale se o suspeito atinge LIMIAR_ACUSACAO e ninguém pontua mais que ele
+int acusacaoCorreta(const MotorPontuacao *mp, int suspeito)
+{
+    double p = mp->pontuacao[suspeito];
+    if (p + EPSILON_PONTUACAO < LIMIAR_ACUSACAO)
+        return 0;
+    for (int k = 0; k < mp->rel->totalSuspeitos; ++k)
+        if (mp->pontuacao[k] > p + EPSILON_PONTUACAO)
+            return 0;
+    return 1;
+}
+
+// Libera só o estado da partida; a relação é de quem a montou
+void liberarMotorPontuacao(MotorPontuacao *mp)
+{
+    free(mp->pontuacao);
+    free(mp->coletada);
+    memset(mp, 0, sizeof(*mp));
+}
+
+// ---------------------------------
+// Relatório final (agregação paralela por suspeito)
+// ---------------------------------
+// Mesma fonte das pontuações e da opção "pistas de um suspeito": as ligações
+// da relação CSR das pistas coletadas, inclusive as de suspeitos secundários.
+// As pistas coletadas são divididas em faixas contíguas. Cada thread conta as
+// ligações de cada suspeito na sua faixa (parcial local); a intercalação soma
+// as parciais e dá a cada thread o ponto de escrita de cada suspeito, e a
+// segunda passada preenche as listas sem trava. O texto é formatado em
+// paralelo por faixas do ranking e concatenado na ordem, então sai igual com
+// 1 ou N threads.
+
+// Acrescenta texto formatado ao buffer do relatório
+static void anexarTexto(TextoRelatorio *t, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(t->dados ? t->dados + t->tam : NULL, t->dados ? t->cap - t->tam : 0, fmt, args);
+    va_end(args);
+    if (n < 0)
+        return;
+    if (t->dados == NULL || t->tam + (size_t)n + 1 > t->cap)
+    {
+        size_t cap = t->cap ? t->cap : 256;
+        while (cap < t->tam + (size_t)n + 1)
+            cap *= 2;
+        char *novo = realloc(t->dados, cap);
+        if (novo == NULL)
+        {
+            printf("Erro ao alocar memória para o relatório.\n");
+            exit(1);
+        }
+        t->dados = novo;
+        t->cap = cap;
+        va_start(args, fmt);
+        vsnprintf(t->dados + t->tam, t->cap - t->tam, fmt, args);
+        va_end(args);
+    }
+    t->tam += (size_t)n;
+}
+
+typedef struct
+{
+    RelatorioFinal *r;
+    const RelacaoPistaSuspeito *rel;
+    const int *coletadas;
+    const double *pontuacao;
+    char **suspeitos;
+    int ini, fim;         // faixa das pistas coletadas
+    int *parcial;         // contagem local, depois cursor de escrita
+    int rankIni, rankFim; // faixa do ranking que esta thread formata
+    TextoRelatorio texto;
+} TrabalhoRelatorio;
+
+static void *contarFaixaRelatorio(void *arg)
+{
+    TrabalhoRelatorio *w = arg;
+    const RelacaoPistaSuspeito *rel = w->rel;
+    for (int i = w->ini; i < w->fim; ++i)
+    {
+        int p = w->coletadas[i];
+        for (int k = rel->inicioPista[p]; k < rel->inicioPista[p + 1]; ++k)
+            w->parcial[rel->suspeitoDe[k]]++;
+    }
+    consolidarEstatisticas();
+    return NULL;
+}
+
+static void *preencherFaixaRelatorio(void *arg)
+{
+    TrabalhoRelatorio *w = arg;
+    const RelacaoPistaSuspeito *rel = w->rel;
+    for (int i = w->ini; i < w->fim; ++i)
+    {
+        int p = w->coletadas[i];
+        for (int k = rel->inicioPista[p]; k < rel->inicioPista[p + 1]; ++k)
+            w->r->pistas[w->parcial[rel->suspeitoDe[k]]++] = rel->pistas[p];
+    }
+    consolidarEstatisticas();
+    return NULL;
+}
+
+static void *formatarFaixaRelatorio(void *arg)
+{
+    TrabalhoRelatorio *w = arg;
+    const RelatorioFinal *r = w->r;
+    for (int j = w->rankIni; j < w->rankFim; ++j)
+    {
+        int k = r->ranking[j];
+        if (w->pontuacao)
+            anexarTexto(&w->texto, "%d) %s: %d pista(s), pontuação %.2f\n", j + 1, w->suspeitos[k], r->contagem[k], w->pontuacao[k]);
+        else
+            anexarTexto(&w->texto, "%d) %s: %d pista(s)\n", j + 1, w->suspeitos[k], r->contagem[k]);
+        for (int i = r->inicio[k]; i < r->inicio[k + 1]; ++i)
+            anexarTexto(&w->texto, "   - %s\n", r->pistas[i]);
+    }
+    consolidarEstatisticas();
+    return NULL;
+}
+
+// Roda a mesma fase em todas as threads (na própria thread se houver uma só)
+static void executarFaseRelatorio(TrabalhoRelatorio *w, int threads, void *(*fase)(void *))
+{
+    pthread_t ids[64];
+    if (threads == 1)
+    {
+        fase(&w[0]);
+        return;
+    }
+    for (int t = 0; t < threads; ++t)
+        pthread_create(&ids[t], NULL, fase, &w[t]);
+    for (int t = 0; t < threads; ++t)
+        pthread_join(ids[t], NULL);
+}
+
+// Posição do ranking com as próprias chaves (o qsort não depende de estado global)
+typedef struct
+{
+    double pontuacao;
+    int contagem;
+    int id;
+} ItemRelatorio;
+
+static int compararRelatorio(const void *a, const void *b)
+{
+    const ItemRelatorio *x = a, *y = b;
+    if (x->pontuacao != y->pontuacao)
+        return x->pontuacao > y->pontuacao ? -1 : 1;
+    if (x->contagem != y->contagem)
+        return y->contagem - x->contagem;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+// Agrega as ligações das pistas coletadas (ids da relação) por suspeito e
+// formata o relatório. pontuacao pode ser NULL (ranking só por contagem);
+// threads <= 0 usa todos os núcleos.
+void montarRelatorio(RelatorioFinal *r, const RelacaoPistaSuspeito *rel, const int coletadas[], int qtdColetadas,
+                     const double *pontuacao, char *suspeitos[], int threads)
+{
+    int totalSuspeitos = rel->totalSuspeitos;
+    memset(r, 0, sizeof(*r));
+    r->totalSuspeitos = totalSuspeitos;
+    r->totalColetadas = qtdColetadas;
+
+    if (threads <= 0)
+        threads = numeroThreads();
+    if (threads > 64)
+        threads = 64;
+    if (qtdColetadas < LIMIAR_RELATORIO_PARALELO)
+        threads = 1;
+
+    int *parciais = calloc((size_t)threads * (size_t)totalSuspeitos + 1, sizeof(*parciais));
+    TrabalhoRelatorio *w = calloc((size_t)threads, sizeof(*w));
+    ItemRelatorio *itens = malloc((size_t)totalSuspeitos * sizeof(*itens) + 1);
+    r->contagem = calloc((size_t)totalSuspeitos + 1, sizeof(*r->contagem));
+    r->inicio = calloc((size_t)totalSuspeitos + 1, sizeof(*r->inicio));
+    r->ranking = malloc((size_t)totalSuspeitos * sizeof(*r->ranking) + 1);
+    if (!parciais || !w || !itens || !r->contagem || !r->inicio || !r->ranking)
+    {
+        printf("Erro ao alocar memória para o relatório.\n");
+        exit(1);
+    }
+    for (int t = 0; t < threads; ++t)
+        w[t] = (TrabalhoRelatorio){r, rel, coletadas, pontuacao, suspeitos,
+                                   qtdColetadas * t / threads, qtdColetadas * (t + 1) / threads,
+                                   parciais + (size_t)t * (size_t)totalSuspeitos,
+                                   totalSuspeitos * t / threads, totalSuspeitos * (t + 1) / threads, {NULL, 0, 0}};
+
+    // 1) contagens locais
+    executarFaseRelatorio(w, threads, contarFaixaRelatorio);
+
+    // 2) intercalação: totais, início de cada lista e cursor de cada thread
+    for (int k = 0; k < totalSuspeitos; ++k)
+    {
+        for (int t = 0; t < threads; ++t)
+            r->contagem[k] += w[t].parcial[k];
+        r->inicio[k + 1] = r->inicio[k] + r->contagem[k];
+    }
+    r->totalLigacoes = r->inicio[totalSuspeitos];
+    for (int k = 0; k < totalSuspeitos; ++k)
+    {
+        int cursor = r->inicio[k];
+        for (int t = 0; t < threads; ++t)
+        {
+            int c = w[t].parcial[k];
+            w[t].parcial[k] = cursor;
+            cursor += c;
+        }
+    }
+    r->pistas = malloc((size_t)r->totalLigacoes * sizeof(*r->pistas) + 1);
+    if (r->pistas == NULL)
+    {
+        printf("Erro ao alocar memória para o relatório.\n");
+        exit(1);
+    }
+
+    // 3) listas por suspeito
+    executarFaseRelatorio(w, threads, preencherFaixaRelatorio);
+
+    // 4) ranking (pontuação, depois contagem, depois ordem da lista)
+    for (int k = 0; k < totalSuspeitos; ++k)
+        itens[k] = (ItemRelatorio){pontuacao ? pontuacao[k] : 0.0, r->contagem[k], k};
+    qsort(itens, (size_t)totalSuspeitos, sizeof(*itens), compararRelatorio);
+    for (int k = 0; k < totalSuspeitos; ++k)
+        r->ranking[k] = itens[k].id;
+
+    // 5) texto por faixas do ranking, concatenado na ordem
+    executarFaseRelatorio(w, threads, formatarFaixaRelatorio);
+    anexarTexto(&r->texto, "%d pista(s) coletada(s), %d ligação(ões) com %d suspeito(s)\n", r->totalColetadas,
+                r->totalLigacoes, totalSuspeitos);
+    for (int t = 0; t < threads; ++t)
+    {
+        if (w[t].texto.tam > 0)
+            anexarTexto(&r->texto, "%.*s", (int)w[t].texto.tam, w[t].texto.dados);
+        free(w[t].texto.dados);
+    }
+
+    free(itens);
+    free(w);
+    free(parciais);
+}
+
+// Escreve o relatório inteiro com uma única chamada
+void emitirRelatorio(const RelatorioFinal *r, FILE *saida)
+{
+    fwrite(r->texto.dados, 1, r->texto.tam, saida);
+    fflush(saida);
+}
+
+void liberarRelatorio(RelatorioFinal *r)
+{
+    free(r->contagem);
+    free(r->inicio);
+    free(r->pistas);
+    free(r->ranking);
+    free(r->texto.dados);
+    memset(r, 0, sizeof(*r));
+}
+
+// ---------------------------------
+// Coleção persistente (treap com cópia de caminho + contadores persistentes)
+// ---------------------------------
+// Bifurcar uma sessão é copiar um ColecaoPersistente (três ponteiros e dois
+// ints). Inserir uma pista copia O(log n) nós do treap e log2(suspeitos) nós
+// dos contadores; nada do que outra versão enxerga é alterado.
+static NoPersistente *copiarNoPersistente(Arena *a, const NoPersistente *n)
+{
+    NoPersistente *c = alocarArena(a, sizeof(*c));
+    *c = *n;
+    return c;
+}
+
+// Insere copiando o caminho; *novo = 0 e a mesma raiz se a pista já existe
+static const NoPersistente *inserirPersistente(Arena *a, const NoPersistente *raiz, const char *pista, uint32_t prioridade, int *novo)
+{
+    if (raiz == NULL)
+    {
+        NoPersistente *n = alocarArena(a, sizeof(*n));
+        *n = (NoPersistente){pista, prioridade, NULL, NULL};
+        *novo = 1;
+        return n;
+    }
+    int cmp = strcmp(pista, raiz->pista);
+    if (cmp == 0)
+    {
+        *novo = 0;
+        return raiz;
+    }
+    const NoPersistente *sub = inserirPersistente(a, cmp < 0 ? raiz->esquerda : raiz->direita, pista, prioridade, novo);
+    if (!*novo)
+        return raiz;
+    NoPersistente *c = copiarNoPersistente(a, raiz);
+    if (cmp < 0)
+    {
+        c->esquerda = sub;
+        if (sub->prioridade > c->prioridade) // rotação à direita
+        {
+            NoPersistente *s = copiarNoPersistente(a, sub);
+            c->esquerda = s->direita;
+            s->direita = c;
+            return s;
+        }
+    }
+    else
+    {
+        c->direita = sub;
+        if (sub->prioridade > c->prioridade) // rotação à esquerda
+        {
+            NoPersistente *s = copiarNoPersistente(a, sub);
+            c->direita = s->esquerda;
+            s->esquerda = c;
+            return s;
+        }
+    }
+    return c;
+}
+
+int buscarPersistente(const NoPersistente *raiz, const char *pista)
+{
+    while (raiz)
+    {
+        int cmp = strcmp(pista, raiz->pista);
+        if (cmp == 0)
+            return 1;
+        raiz = cmp < 0 ? raiz->esquerda : raiz->direita;
+    }
+    return 0;
+}
+
+// Soma delta ao contador do suspeito copiando um caminho raiz-folha
+static const NoContagem *somarContagem(Arena *a, const NoContagem *raiz, int niveis, int suspeito, uint32_t delta)
+{
+    NoContagem *c = alocarArena(a, sizeof(*c));
+    if (raiz)
+        *c = *raiz;
+    else
+        memset(c, 0, sizeof(*c));
+    if (niveis == 0)
+    {
+        c->valor += delta;
+        return c;
+    }
+    int lado = suspeito >> (niveis - 1) & 1;
+    c->filho[lado] = somarContagem(a, c->filho[lado], niveis - 1, suspeito, delta);
+    return c;
+}
+
+uint32_t contagemPersistente(const ColecaoPersistente *c, int suspeito)
+{
+    const NoContagem *n = c->contagem;
+    for (int nivel = c->niveis; n && nivel > 0; --nivel)
+        n = n->filho[suspeito >> (nivel - 1) & 1];
+    return n ? n->valor : 0;
+}
+
+// Coleção vazia para totalSuspeitos suspeitos
+ColecaoPersistente colecaoVazia(int totalSuspeitos)
+{
+    ColecaoPersistente c = {NULL, NULL, 0, 0};
+    while ((1 << c.niveis) < totalSuspeitos)
+        c.niveis++;
+    return c;
+}
+
+// Nova versão com a pista (e +1 para o suspeito, se >= 0). c não muda.
+// Retorna 1 se a pista era nova.
+int registrarPistaPersistente(Arena *a, ColecaoPersistente *c, const char *pista, int suspeito)
+{
+    int novo;
+    const NoPersistente *raiz = inserirPersistente(a, c->pistas, pista, hashSemente(pista, 0x7EA9u), &novo);
+    if (!novo)
+        return 0;
+    c->pistas = raiz;
+    c->totalPistas++;
+    if (suspeito >= 0)
+        c->contagem = somarContagem(a, c->contagem, c->niveis, suspeito, 1);
+    return 1;
+}
+
+// ---------------------------------
+// Rota ótima (branch-and-bound sobre a árvore da mansão)
+// ---------------------------------
+// A rota sai do Hall, pode voltar pelo caminho de onde veio e termina em
+// qualquer cômodo. Os cômodos visitados formam uma subárvore S que contém o
+// Hall, e o menor passeio que cobre S custa 2*arestas(S) - profundidade
+// máxima de S: tudo é ida e volta, menos o último ramo.
+//
+// A busca cresce S ligando o caminho até um cômodo com uma pista ainda não
+// coletada do suspeito; pistas de outros suspeitos entram quando o caminho
+// passa por elas. O custo só cresce com S e nunca é menor que a
+// profundidade do cômodo mais fundo, então a melhor rota já achada poda o
+// resto. Duas passadas: a gulosa liga só o cômodo mais próximo abaixo de
+// cada nó de S e acha logo um limite bom; a exata tenta todo cômodo da
+// pista mais raso que esse limite.
+//
+// Os dois tipos de candidato vêm de resumos por pista: os cômodos de cada
+// pista em pré-ordem (uma subárvore é uma faixa contígua) com uma árvore de
+// mínimos de profundidade por cima. O mais próximo custa O(log n) e os
+// rasos saem descendo só pelos ramos cujo mínimo cabe no limite.
+#define NIVEIS_CORTE_ROTA 32      // profundidade máxima do corte em subárvores
+#define TAM_VISTOS_ROTA (1 << 16) // assinaturas de S já examinadas, por thread
+
+typedef struct
+{
+    int32_t total;
+    const Comodo **comodo; // por posição em pré-ordem (o Hall é 0)
+    int32_t *pai;
+    int32_t *fim;          // a subárvore de i ocupa [i, fim[i])
+    int32_t *profundidade;
+    int32_t *pista;        // id na relação; -1 sem pista e no Hall (onde nada é coletado)
+    int32_t *inicioPista;  // cômodos de cada pista em posicoes[inicioPista[p]..inicioPista[p+1])
+    int32_t *posicoes;
+    uint64_t *minimo;      // por pista, 2*qtd entradas: profundidade << 32 | posição
+} ArvoreRota;
+
+typedef struct
+{
+    const Comodo *raiz;
+    int32_t pai, profundidade, inicio, tamanho;
+} SubarvoreRota;
+
+typedef struct
+{
+    const Comodo *c;
+    int32_t pai, profundidade;
+} ItemPilhaRota;
+
+// Corte da mansão em subárvores numeradas por threads diferentes
+typedef struct
+{
+    ArvoreRota *a;
+    const RelacaoPistaSuspeito *rel;
+    SubarvoreRota *sub;
+    int qtdSub;
+    int profCorte;
+    int proxima; // próxima subárvore livre (atômico)
+    int numerar; // 0: só conta os cômodos
+} CorteRota;
+
+static void registrarNoRota(ArvoreRota *a, const RelacaoPistaSuspeito *rel, int32_t pos, const Comodo *c, int32_t pai, int32_t prof)
+{
+    a->comodo[pos] = c;
+    a->pai[pos] = pai;
+    a->profundidade[pos] = prof;
+    a->pista[pos] = pai >= 0 && c->pista.tam ? idPistaRelacao(rel, lerTexto(&c->pista)) : -1;
+}
+
+static void *percorrerSubarvores(void *arg)
+{
+    CorteRota *k = arg;
+    size_t cap = 64;
+    ItemPilhaRota *pilha = malloc(cap * sizeof(*pilha));
+    if (pilha == NULL)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    int i;
+    while ((i = __atomic_fetch_add(&k->proxima, 1, __ATOMIC_RELAXED)) < k->qtdSub)
+    {
+        SubarvoreRota *s = &k->sub[i];
+        int32_t pos = s->inicio;
+        size_t topo = 0;
+        pilha[topo++] = (ItemPilhaRota){s->raiz, s->pai, s->profundidade};
+        while (topo > 0)
+        {
+            ItemPilhaRota it = pilha[--topo];
+            if (k->numerar)
+                registrarNoRota(k->a, k->rel, pos, it.c, it.pai, it.profundidade);
+            if (topo + 2 > cap)
+            {
+                cap *= 2;
+                pilha = realloc(pilha, cap * sizeof(*pilha));
+                if (pilha == NULL)
+                {
+                    printf("Erro ao alocar memória para a rota.\n");
+                    exit(1);
+                }
+            }
+            if (it.c->direita)
+                pilha[topo++] = (ItemPilhaRota){it.c->direita, pos, it.profundidade + 1};
+            if (it.c->esquerda)
+                pilha[topo++] = (ItemPilhaRota){it.c->esquerda, pos, it.profundidade + 1};
+            pos++;
+        }
+        if (!k->numerar)
+        {
+            s->tamanho = pos - s->inicio;
+            continue;
+        }
+        // fim[] de trás para frente: o fim de um nó é o maior fim dos filhos
+        int32_t *fim = k->a->fim, *pai = k->a->pai;
+        for (int32_t j = s->inicio; j < pos; ++j)
+            fim[j] = j + 1;
+        for (int32_t j = pos - 1; j > s->inicio; --j)
+            if (fim[j] > fim[pai[j]])
+                fim[pai[j]] = fim[j];
+    }
+    free(pilha);
+    consolidarEstatisticas();
+    return NULL;
+}
+
+static void executarCorte(CorteRota *k, int threads)
+{
+    pthread_t ids[64];
+    k->proxima = 0;
+    if (threads > k->qtdSub)
+        threads = k->qtdSub;
+    if (threads <= 1)
+    {
+        percorrerSubarvores(k);
+        return;
+    }
+    for (int t = 0; t < threads; ++t)
+        pthread_create(&ids[t], NULL, percorrerSubarvores, k);
+    for (int t = 0; t < threads; ++t)
+        pthread_join(ids[t], NULL);
+}
+
+// Acima do corte: coleta as raízes das subárvores em pré-ordem e conta o topo
+static int32_t cortarTopo(CorteRota *k, const Comodo *c, int prof)
+{
+    if (prof == k->profCorte)
+    {
+        k->sub[k->qtdSub++].raiz = c;
+        return 0;
+    }
+    int32_t n = 1;
+    if (c->esquerda)
+        n += cortarTopo(k, c->esquerda, prof + 1);
+    if (c->direita)
+        n += cortarTopo(k, c->direita, prof + 1);
+    return n;
+}
+
+// Numera o topo na mesma ordem de cortarTopo, reservando a faixa de cada subárvore
+static int32_t posicionarTopo(CorteRota *k, const Comodo *c, int32_t pai, int32_t prof, int32_t pos)
+{
+    if (prof == k->profCorte)
+    {
+        SubarvoreRota *s = &k->sub[k->qtdSub++];
+        s->pai = pai;
+        s->profundidade = prof;
+        s->inicio = pos;
+        return pos + s->tamanho;
+    }
+    registrarNoRota(k->a, k->rel, pos, c, pai, prof);
+    int32_t p = pos + 1;
+    if (c->esquerda)
+        p = posicionarTopo(k, c->esquerda, pos, prof + 1, p);
+    if (c->direita)
+        p = posicionarTopo(k, c->direita, pos, prof + 1, p);
+    k->a->fim[pos] = p;
+    return p;
+}
+
+static void construirArvoreRota(ArvoreRota *a, const Comodo *hall, const RelacaoPistaSuspeito *rel, int threads)
+{
+    // corte: desce nível a nível até haver subárvores para todas as threads
+    int cap = 8 * threads + 2, qtd = 1, prof = 0;
+    const Comodo **nivel = malloc((size_t)cap * sizeof(*nivel));
+    const Comodo **prox = malloc((size_t)cap * sizeof(*prox));
+    if (nivel == NULL || prox == NULL)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    nivel[0] = hall;
+    while (qtd > 0 && qtd < 4 * threads && prof < NIVEIS_CORTE_ROTA)
+    {
+        int n = 0;
+        for (int i = 0; i < qtd; ++i)
+        {
+            if (nivel[i]->esquerda)
+                prox[n++] = nivel[i]->esquerda;
+            if (nivel[i]->direita)
+                prox[n++] = nivel[i]->direita;
+        }
+        const Comodo **t = nivel;
+        nivel = prox;
+        prox = t;
+        qtd = n;
+        prof++;
+    }
+    free(nivel);
+    free(prox);
+
+    CorteRota k = {a, rel, malloc((size_t)qtd * sizeof(SubarvoreRota) + 1), 0, prof, 0, 0};
+    if (k.sub == NULL)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    int32_t total = cortarTopo(&k, hall, 0);
+    executarCorte(&k, threads); // conta
+    for (int i = 0; i < k.qtdSub; ++i)
+        total += k.sub[i].tamanho;
+
+    a->total = total;
+    a->comodo = malloc((size_t)total * sizeof(*a->comodo));
+    a->pai = malloc((size_t)total * sizeof(*a->pai));
+    a->fim = malloc((size_t)total * sizeof(*a->fim));
+    a->profundidade = malloc((size_t)total * sizeof(*a->profundidade));
+    a->pista = malloc((size_t)total * sizeof(*a->pista));
+    a->inicioPista = calloc((size_t)rel->totalPistas + 1, sizeof(*a->inicioPista));
+    if (!a->comodo || !a->pai || !a->fim || !a->profundidade || !a->pista || !a->inicioPista)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    k.qtdSub = 0;
+    posicionarTopo(&k, hall, -1, 0, 0);
+    k.numerar = 1;
+    executarCorte(&k, threads);
+    free(k.sub);
+
+    // resumos por pista: cômodos em pré-ordem e árvore de mínimos
+    for (int32_t i = 0; i < total; ++i)
+        if (a->pista[i] >= 0)
+            a->inicioPista[a->pista[i] + 1]++;
+    for (int p = 0; p < rel->totalPistas; ++p)
+        a->inicioPista[p + 1] += a->inicioPista[p];
+    int32_t ocupadas = a->inicioPista[rel->totalPistas];
+    int32_t *cursor = malloc((size_t)rel->totalPistas * sizeof(*cursor) + 1);
+    a->posicoes = malloc((size_t)ocupadas * sizeof(*a->posicoes) + 1);
+    a->minimo = malloc(2 * (size_t)ocupadas * sizeof(*a->minimo) + 1);
+    if (!cursor || !a->posicoes || !a->minimo)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    memcpy(cursor, a->inicioPista, (size_t)rel->totalPistas * sizeof(*cursor));
+    for (int32_t i = 0; i < total; ++i)
+        if (a->pista[i] >= 0)
+            a->posicoes[cursor[a->pista[i]]++] = i;
+    free(cursor);
+    for (int p = 0; p < rel->totalPistas; ++p)
+    {
+        int32_t q = a->inicioPista[p + 1] - a->inicioPista[p];
+        const int32_t *pos = a->posicoes + a->inicioPista[p];
+        uint64_t *t = a->minimo + 2 * (size_t)a->inicioPista[p];
+        for (int32_t j = 0; j < q; ++j)
+            t[q + j] = (uint64_t)a->profundidade[pos[j]] << 32 | (uint32_t)pos[j];
+        for (int32_t j = q - 1; j >= 1; --j)
+            t[j] = t[2 * j] < t[2 * j + 1] ? t[2 * j] : t[2 * j + 1];
+    }
+}
+
+static void liberarArvoreRota(ArvoreRota *a)
+{
+    free(a->comodo);
+    free(a->pai);
+    free(a->fim);
+    free(a->profundidade);
+    free(a->pista);
+    free(a->inicioPista);
+    free(a->posicoes);
+    free(a->minimo);
+    memset(a, 0, sizeof(*a));
+}
+
+// Primeiro índice de pos[0..q) com valor >= x
+static int32_t primeiraPosicao(const int32_t *pos, int32_t q, int32_t x)
+{
+    int32_t lo = 0, hi = q;
+    while (lo < hi)
+    {
+        int32_t meio = lo + (hi - lo) / 2;
+        if (pos[meio] < x)
+            lo = meio + 1;
+        else
+            hi = meio;
+    }
+    return lo;
+}
+
+// Cômodo mais raso com a pista na subárvore de no, ou -1
+static int32_t maisProximaAbaixo(const ArvoreRota *a, int pista, int32_t no)
+{
+    const int32_t *pos = a->posicoes + a->inicioPista[pista];
+    int32_t q = a->inicioPista[pista + 1] - a->inicioPista[pista];
+    const uint64_t *t = a->minimo + 2 * (size_t)a->inicioPista[pista];
+    int32_t l = primeiraPosicao(pos, q, no) + q, r = primeiraPosicao(pos, q, a->fim[no]) + q;
+    uint64_t m = UINT64_MAX;
+    for (; l < r; l >>= 1, r >>= 1)
+    {
+        if ((l & 1) && t[l] < m)
+            m = t[l];
+        if (l & 1)
+            l++;
+        if (r & 1)
+        {
+            r--;
+            if (t[r] < m)
+                m = t[r];
+        }
+    }
+    return m == UINT64_MAX ? -1 : (int32_t)(uint32_t)m;
+}
+
+typedef struct
+{
+    int suspeito;
+    int pista;      // primeira pista ligada a partir do Hall
+    int32_t comodo; // cômodo mais raso com ela (ordena as tarefas)
+} TarefaRota;
+
+typedef struct
+{
+    const ArvoreRota *a;
+    const RelacaoPistaSuspeito *rel;
+    const TarefaRota *tarefas;
+    int qtdTarefas;
+    int exata;      // 0: passada gulosa
+    int proxima;    // atômico
+    int melhor;     // custo da melhor rota (atômico)
+    int suspeito;
+    int32_t *melhorNos;
+    int qtdMelhor;
+    uint64_t estados;
+    pthread_mutex_t trava; // protege a melhor rota
+} BuscaRotaCompartilhada;
+
+typedef struct
+{
+    BuscaRotaCompartilhada *g;
+    int suspeito;
+    unsigned char *marcado;
+    int32_t *nos; // nós de S na ordem em que entraram
+    int qtdNos, capNos;
+    int arestas, profMax;
+    int *coletada; // cômodos de S com cada pista
+    double *pontuacao;
+    uint64_t assinatura; // xor dos nós de S: não depende da ordem
+    uint64_t *vistos;
+    int qtdVistos;
+    uint64_t estados;
+} BuscaRota;
+
+// Liga destino a S pelo caminho até o primeiro ancestral já marcado
+static void anexarCaminhoRota(BuscaRota *b, int32_t destino)
+{
+    const ArvoreRota *a = b->g->a;
+    const RelacaoPistaSuspeito *rel = b->g->rel;
+    for (int32_t v = destino; !b->marcado[v]; v = a->pai[v])
+    {
+        if (b->qtdNos == b->capNos)
+        {
+            b->capNos *= 2;
+            b->nos = realloc(b->nos, (size_t)b->capNos * sizeof(*b->nos));
+            if (b->nos == NULL)
+            {
+                printf("Erro ao alocar memória para a rota.\n");
+                exit(1);
+            }
+        }
+        b->nos[b->qtdNos++] = v;
+        b->marcado[v] = 1;
+        b->arestas++;
+        b->assinatura ^= misturar64((uint64_t)v + 1);
+        int p = a->pista[v];
+        if (p >= 0 && b->coletada[p]++ == 0)
+            for (int k = rel->inicioPista[p]; k < rel->inicioPista[p + 1]; ++k)
+                b->pontuacao[rel->suspeitoDe[k]] += rel->pesoPista[k];
+    }
+    if (a->profundidade[destino] > b->profMax)
+        b->profMax = a->profundidade[destino];
+}
+
+static void desfazerCaminhoRota(BuscaRota *b, int qtdNos, int profMax)
+{
+    const ArvoreRota *a = b->g->a;
+    const RelacaoPistaSuspeito *rel = b->g->rel;
+    while (b->qtdNos > qtdNos)
+    {
+        int32_t v = b->nos[--b->qtdNos];
+        b->marcado[v] = 0;
+        b->arestas--;
+        b->assinatura ^= misturar64((uint64_t)v + 1);
+        int p = a->pista[v];
+        if (p >= 0 && --b->coletada[p] == 0)
+            for (int k = rel->inicioPista[p]; k < rel->inicioPista[p + 1]; ++k)
+                b->pontuacao[rel->suspeitoDe[k]] -= rel->pesoPista[k];
+    }
+    b->profMax = profMax;
+}
+
+// 1 se S (deste suspeito) já foi examinado; a tabela recomeça ao encher
+static int jaVistoRota(BuscaRota *b)
+{
+    uint64_t h = b->assinatura ^ misturar64(~(uint64_t)b->suspeito);
+    if (h == 0)
+        h = 1;
+    if (b->qtdVistos >= TAM_VISTOS_ROTA / 4 * 3)
+    {
+        memset(b->vistos, 0, TAM_VISTOS_ROTA * sizeof(*b->vistos));
+        b->qtdVistos = 0;
+    }
+    for (uint32_t i = (uint32_t)h & (TAM_VISTOS_ROTA - 1);; i = (i + 1) & (TAM_VISTOS_ROTA - 1))
+    {
+        if (b->vistos[i] == h)
+            return 1;
+        if (b->vistos[i] == 0)
+        {
+            b->vistos[i] = h;
+            b->qtdVistos++;
+            return 0;
+        }
+    }
+}
+
+static void buscarRota(BuscaRota *b);
+
+// Liga r a S, continua a busca e desfaz
+static void ligarCandidatoRota(BuscaRota *b, int32_t r)
+{
+    const ArvoreRota *a = b->g->a;
+    int qtdNos = b->qtdNos, profMax = b->profMax, novas = 0;
+    for (int32_t v = r; !b->marcado[v]; v = a->pai[v])
+        novas++;
+    int prof = a->profundidade[r] > profMax ? a->profundidade[r] : profMax;
+    if (2 * (b->arestas + novas) - prof >= __atomic_load_n(&b->g->melhor, __ATOMIC_RELAXED))
+        return;
+    anexarCaminhoRota(b, r);
+    buscarRota(b);
+    desfazerCaminhoRota(b, qtdNos, profMax);
+}
+
+// Passada exata: todo cômodo da árvore de mínimos t (q folhas) mais raso que o limite
+static void ligarRasosRota(BuscaRota *b, const uint64_t *t, int32_t q, int32_t i)
+{
+    if ((int64_t)(t[i] >> 32) >= __atomic_load_n(&b->g->melhor, __ATOMIC_RELAXED))
+        return;
+    if (i >= q)
+    {
+        ligarCandidatoRota(b, (int32_t)(uint32_t)t[i]);
+        return;
+    }
+    ligarRasosRota(b, t, q, 2 * i);
+    ligarRasosRota(b, t, q, 2 * i + 1);
+}
+
+// Tenta coletar a pista a partir do S atual
+static void expandirRota(BuscaRota *b, int pista)
+{
+    const ArvoreRota *a = b->g->a;
+    if (b->g->exata)
+    {
+        int32_t q = a->inicioPista[pista + 1] - a->inicioPista[pista];
+        if (q > 0)
+            ligarRasosRota(b, a->minimo + 2 * (size_t)a->inicioPista[pista], q, 1);
+        return;
+    }
+    int qtdNos = b->qtdNos;
+    for (int i = 0; i < qtdNos; ++i)
+    {
+        int32_t r = maisProximaAbaixo(a, pista, b->nos[i]);
+        if (r >= 0)
+            ligarCandidatoRota(b, r);
+    }
+}
+
+static void buscarRota(BuscaRota *b)
+{
+    BuscaRotaCompartilhada *g = b->g;
+    const RelacaoPistaSuspeito *rel = g->rel;
+    int custo = 2 * b->arestas - b->profMax;
+    if (custo >= __atomic_load_n(&g->melhor, __ATOMIC_RELAXED) || jaVistoRota(b))
+        return;
+    b->estados++;
+
+    // acusação válida: o suspeito chega ao limiar e ninguém pontua mais
+    int s = b->suspeito, valida = b->pontuacao[s] + EPSILON_PONTUACAO >= LIMIAR_ACUSACAO;
+    for (int k = 0; valida && k < rel->totalSuspeitos; ++k)
+        valida = b->pontuacao[k] <= b->pontuacao[s] + EPSILON_PONTUACAO;
+    if (valida)
+    {
+        pthread_mutex_lock(&g->trava);
+        if (custo < g->melhor)
+        {
+            g->melhorNos = realloc(g->melhorNos, (size_t)b->qtdNos * sizeof(*g->melhorNos));
+            if (g->melhorNos == NULL)
+            {
+                printf("Erro ao alocar memória para a rota.\n");
+                exit(1);
+            }
+            memcpy(g->melhorNos, b->nos, (size_t)b->qtdNos * sizeof(*b->nos));
+            g->qtdMelhor = b->qtdNos;
+            g->suspeito = s;
+            __atomic_store_n(&g->melhor, custo, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&g->trava);
+        return;
+    }
+
+    int qtd;
+    const int *pistas = pistasDoSuspeito(rel, s, &qtd);
+    const double *pesos = rel->pesoSuspeito + rel->inicioSuspeito[s];
+    double falta = LIMIAR_ACUSACAO - b->pontuacao[s];
+    for (int j = 0; j < qtd; ++j)
+        if (!b->coletada[pistas[j]] && pesos[j] > 0)
+            falta -= pesos[j];
+    if (falta > EPSILON_PONTUACAO)
+        return; // nem todas as pistas restantes bastam
+
+    for (int j = 0; j < qtd; ++j)
+        if (!b->coletada[pistas[j]] && pesos[j] > 0)
+            expandirRota(b, pistas[j]);
+}
+
+static void *executarBuscaRota(void *arg)
+{
+    BuscaRotaCompartilhada *g = arg;
+    BuscaRota b = {g, -1, calloc((size_t)g->a->total, 1), malloc(64 * sizeof(int32_t)), 0, 64, 0, 0,
+                   calloc((size_t)g->rel->totalPistas + 1, sizeof(int)),
+                   calloc((size_t)g->rel->totalSuspeitos, sizeof(double)), 0,
+                   calloc(TAM_VISTOS_ROTA, sizeof(uint64_t)), 0, 0};
+    if (!b.marcado || !b.nos || !b.coletada || !b.pontuacao || !b.vistos)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    b.nos[b.qtdNos++] = 0; // o Hall está sempre em S
+    b.marcado[0] = 1;
+    b.assinatura = misturar64(1);
+    int i;
+    while ((i = __atomic_fetch_add(&g->proxima, 1, __ATOMIC_RELAXED)) < g->qtdTarefas)
+    {
+        const TarefaRota *t = &g->tarefas[i];
+        if (g->a->profundidade[t->comodo] >= __atomic_load_n(&g->melhor, __ATOMIC_RELAXED))
+            continue;
+        b.suspeito = t->suspeito;
+        expandirRota(&b, t->pista);
+    }
+    __atomic_fetch_add(&g->estados, b.estados, __ATOMIC_RELAXED);
+    free(b.marcado);
+    free(b.nos);
+    free(b.coletada);
+    free(b.pontuacao);
+    free(b.vistos);
+    consolidarEstatisticas();
+    return NULL;
+}
+
+static const ArvoreRota *arvoreTarefas; // critério do qsort abaixo
+
+static int compararTarefasRota(const void *x, const void *y)
+{
+    const TarefaRota *a = x, *b = y;
+    int32_t pa = arvoreTarefas->profundidade[a->comodo], pb = arvoreTarefas->profundidade[b->comodo];
+    if (pa != pb)
+        return pa < pb ? -1 : 1;
+    return a->suspeito != b->suspeito ? a->suspeito - b->suspeito : a->pista - b->pista;
+}
+
+static int compararInt32(const void *x, const void *y)
+{
+    int32_t a = *(const int32_t *)x, b = *(const int32_t *)y;
+    return (a > b) - (a < b);
+}
+
+// Passeio sobre os nós de S (ordenados em pré-ordem): filhos com o ramo mais
+// fundo por último, e as voltas finais cortadas
+static char *montarPasseioRota(const ArvoreRota *a, const int32_t *nos, int qtd, int *movimentos)
+{
+    int32_t *fundo = malloc((size_t)qtd * sizeof(*fundo));
+    int32_t *filho = malloc(2 * (size_t)qtd * sizeof(*filho));
+    int32_t *pilha = malloc((size_t)qtd * sizeof(*pilha));
+    unsigned char *passo = calloc((size_t)qtd, 1);
+    char *rota = malloc(2 * (size_t)qtd + 1);
+    if (!fundo || !filho || !pilha || !passo || !rota)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    for (int i = 0; i < qtd; ++i)
+    {
+        fundo[i] = a->profundidade[nos[i]];
+        filho[2 * i] = filho[2 * i + 1] = -1;
+    }
+    for (int i = qtd - 1; i > 0; --i)
+    {
+        int p = primeiraPosicao(nos, qtd, a->pai[nos[i]]);
+        if (fundo[i] > fundo[p])
+            fundo[p] = fundo[i];
+        filho[2 * p + (a->comodo[nos[p]]->esquerda != a->comodo[nos[i]])] = i;
+    }
+    int n = 0, topo = 0;
+    pilha[topo++] = 0;
+    while (topo > 0)
+    {
+        int i = pilha[topo - 1];
+        int e = filho[2 * i], d = filho[2 * i + 1];
+        int primeiro = e, segundo = d; // o ramo mais fundo vai por último
+        if (e >= 0 && d >= 0 && fundo[e] > fundo[d])
+        {
+            primeiro = d;
+            segundo = e;
+        }
+        int prox = passo[i] == 0 ? primeiro : passo[i] == 1 ? segundo : -1;
+        if (passo[i] < 2)
+        {
+            passo[i]++;
+            if (prox >= 0)
+            {
+                rota[n++] = prox == e ? 'e' : 'd';
+                pilha[topo++] = prox;
+            }
+            continue;
+        }
+        topo--;
+        if (topo > 0)
+            rota[n++] = 'v';
+    }
+    while (n > 0 && rota[n - 1] == 'v')
+        n--;
+    rota[n] = '\0';
+    *movimentos = n;
+    free(fundo);
+    free(filho);
+    free(pilha);
+    free(passo);
+    return rota;
+}
+
+// Menor rota a partir do Hall que deixa alguma acusação válida (o suspeito
+// chega a LIMIAR_ACUSACAO e ninguém pontua mais). A preparação é dividida
+// entre threads por subárvores e a busca por (suspeito, primeira pista).
+// threads <= 0 usa todos os núcleos.
+void resolverRotaOtima(const Comodo *hall, const RelacaoPistaSuspeito *rel, int threads, RotaOtima *r)
+{
+    if (threads <= 0)
+        threads = numeroThreads();
+    if (threads > 64)
+        threads = 64;
+    memset(r, 0, sizeof(*r));
+    r->suspeito = -1;
+
+    ArvoreRota a;
+    construirArvoreRota(&a, hall, rel, threads);
+
+    // tarefas: (suspeito, primeira pista), as que começam mais rasas primeiro
+    TarefaRota *tarefas = malloc((size_t)rel->totalLigacoes * sizeof(*tarefas) + 1);
+    if (tarefas == NULL)
+    {
+        printf("Erro ao alocar memória para a rota.\n");
+        exit(1);
+    }
+    int qtdTarefas = 0;
+    for (int s = 0; s < rel->totalSuspeitos; ++s)
+        for (int k = rel->inicioSuspeito[s]; k < rel->inicioSuspeito[s + 1]; ++k)
+        {
+            int32_t c = rel->pesoSuspeito[k] > 0 ? maisProximaAbaixo(&a, rel->pistaDe[k], 0) : -1;
+            if (c >= 0)
+                tarefas[qtdTarefas++] = (TarefaRota){s, rel->pistaDe[k], c};
+        }
+    arvoreTarefas = &a;
+    qsort(tarefas, (size_t)qtdTarefas, sizeof(*tarefas), compararTarefasRota);
+
+    BuscaRotaCompartilhada g = {&a, rel, tarefas, qtdTarefas, 0, 0, INT32_MAX, -1, NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER};
+    pthread_t ids[64];
+    int usadas = threads < qtdTarefas ? threads : qtdTarefas;
+    if (usadas < 1)
+        usadas = 1;
+    for (g.exata = 0; g.exata < 2; ++g.exata)
+    {
+        g.proxima = 0;
+        if (usadas == 1)
+            executarBuscaRota(&g);
+        else
+        {
+            for (int t = 0; t < usadas; ++t)
+                pthread_create(&ids[t], NULL, executarBuscaRota, &g);
+            for (int t = 0; t < usadas; ++t)
+                pthread_join(ids[t], NULL);
+        }
+    }
+    r->estados = g.estados;
+
+    if (g.suspeito >= 0)
+    {
+        qsort(g.melhorNos, (size_t)g.qtdMelhor, sizeof(*g.melhorNos), compararInt32);
+        r->suspeito = g.suspeito;
+        r->rota = montarPasseioRota(&a, g.melhorNos, g.qtdMelhor, &r->movimentos);
+        unsigned char *vista = calloc((size_t)rel->totalPistas + 1, 1);
+        if (vista == NULL)
+        {
+            printf("Erro ao alocar memória para a rota.\n");
+            exit(1);
+        }
+        for (int i = 1; i < g.qtdMelhor; ++i)
+        {
+            int p = a.pista[g.melhorNos[i]];
+            if (p < 0 || vista[p])
+                continue;
+            vista[p] = 1;
+            for (int k = rel->inicioPista[p]; k < rel->inicioPista[p + 1]; ++k)
+                if (rel->suspeitoDe[k] == g.suspeito)
+                    r->pontuacao += rel->pesoPista[k];
+        }
+        free(vista);
+    }
+    pthread_mutex_destroy(&g.trava);
+    free(g.melhorNos);
+    free(tarefas);
+    liberarArvoreRota(&a);
+}
+
+void liberarRotaOtima(RotaOtima *r)
+{
+    free(r->rota);
+    memset(r, 0, sizeof(*r));
+    r->suspeito = -1;
+}
+
+// ---------------------------------
+// Registro compartilhado (investigadores cooperativos)
+// ---------------------------------
+// Vários jogadores (threads) registram pistas no mesmo conjunto. Inserção:
+// sonda linear a partir do hash; posição livre é tomada por CAS, e quem
+// perde o CAS compara com a pista que ganhou e segue sondando. Só o vencedor
+// incrementa o contador do suspeito. As pistas registradas precisam viver
+// tanto quanto o registro (o texto não é copiado).
+// Conferência com ThreadSanitizer:
+//   gcc -O1 -g -fsanitize=thread mestre.c -o mestre-tsan && ./mestre-tsan bench registro 20000
+void criarRegistroCompartilhado(RegistroCompartilhado *r, size_t maxPistas, int totalSuspeitos)
+{
+    size_t cap = 16;
+    while (cap < 2 * maxPistas) // carga <= 0.5: sondas curtas mesmo cheio
+        cap *= 2;
+    r->mascara = cap - 1;
+    r->pista = calloc(cap, sizeof(*r->pista));
+    r->suspeito = malloc(cap * sizeof(*r->suspeito));
+    r->contagem = calloc((size_t)totalSuspeitos + 1, sizeof(*r->contagem));
+    r->totalSuspeitos = totalSuspeitos;
+    r->total = 0;
+    if (!r->pista || !r->suspeito || !r->contagem)
+    {
+        printf("Erro ao alocar memória para o registro compartilhado.\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < cap; ++i)
+        r->suspeito[i] = -1;
+}
+
+// Retorna 1 se esta chamada registrou a pista, 0 se ela já estava lá
+// e -1 se o registro está cheio.
+int registrarPistaCompartilhada(RegistroCompartilhado *r, const char *pista, int suspeito)
+{
+    size_t i = (size_t)hash64Semente(pista, 0x5EEDull) & r->mascara;
+    for (size_t sondas = 0; sondas <= r->mascara; ++sondas, i = (i + 1) & r->mascara)
+    {
+        const char *atual = __atomic_load_n(&r->pista[i], __ATOMIC_ACQUIRE);
+        if (atual == NULL)
+        {
+            if (__atomic_compare_exchange_n(&r->pista[i], &atual, pista, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                __atomic_store_n(&r->suspeito[i], suspeito, __ATOMIC_RELEASE);
+                if (suspeito >= 0 && suspeito < r->totalSuspeitos)
+                    __atomic_fetch_add(&r->contagem[suspeito], 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&r->total, 1, __ATOMIC_RELAXED);
+                return 1;
+            }
+            // perdeu o CAS: atual agora é a pista de quem ganhou
+        }
+        if (atual == pista || strcmp(atual, pista) == 0)
+            return 0;
+    }
+    return -1;
+}
+
+int contemPistaCompartilhada(const RegistroCompartilhado *r, const char *pista)
+{
+    size_t i = (size_t)hash64Semente(pista, 0x5EEDull) & r->mascara;
+    for (size_t sondas = 0; sondas <= r->mascara; ++sondas, i = (i + 1) & r->mascara)
+    {
+        const char *atual = __atomic_load_n(&r->pista[i], __ATOMIC_ACQUIRE);
+        if (atual == NULL)
+            return 0;
+        if (atual == pista || strcmp(atual, pista) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+uint64_t contagemCompartilhada(const RegistroCompartilhado *r, int suspeito)
+{
+    return __atomic_load_n(&r->contagem[suspeito], __ATOMIC_RELAXED);
+}
+
+void liberarRegistroCompartilhado(RegistroCompartilhado *r)
+{
+    free(r->pista);
+    free(r->suspeito);
+    free(r->contagem);
+    memset(r, 0, sizeof(*r));
+}
+
+// --- Modo cooperativo: ./mestre coop [jogadores] [cômodos] [semente] ---
+// Cada jogador faz expedições aleatórias do Hall até uma folha numa mansão
+// gerada e registra no registro compartilhado as pistas que encontrar.
+typedef struct
+{
+    const MansaoProcedural *m;
+    const HashPistasPerfeito *pistas;
+    const IndiceSuspeitos *nomes;
+    RegistroCompartilhado *registro;
+    uint64_t semente;
+    int expedicoes;
+    long novas;   // pistas que este jogador registrou primeiro
+    long vistas;  // pistas encontradas (inclui repetidas)
+} Investigador;
+
+static void *investigar(void *arg)
+{
+    Investigador *inv = arg;
+    uint64_t estado = inv->semente;
+    for (int e = 0; e < inv->expedicoes; ++e)
+    {
+        for (const Comodo *c = &inv->m->comodos[0]; c; c = aleatorio64(&estado) & 1 ? c->esquerda : c->direita)
+        {
+            if (c->pista.tam == 0)
+                continue;
+            const char *suspeito = buscarHashPistasPerfeito(inv->pistas, lerTexto(&c->pista));
+            int id = suspeito ? idSuspeito(inv->nomes, suspeito) : -1;
+            inv->vistas++;
+            if (registrarPistaCompartilhada(inv->registro, lerTexto(&c->pista), id) == 1)
+                inv->novas++;
+        }
+    }
+    consolidarEstatisticas();
+    return NULL;
+}
+
+int executarCoop(int argc, char *argv[])
+{
+    int jogadores = argc > 0 ? atoi(argv[0]) : 4;
+    size_t totalComodos = argc > 1 ? (size_t)atoll(argv[1]) : 4096;
+    uint64_t semente = argc > 2 ? (uint64_t)atoll(argv[2]) : (uint64_t)time(NULL);
+    if (jogadores < 1)
+        jogadores = 1;
+    if (jogadores > 64)
+        jogadores = 64;
+    if (totalComodos < 1)
+        totalComodos = 1;
+
+    MansaoProcedural *m = gerarMansao(totalComodos, FORMA_BALANCEADA, semente, 8, 512, 0);
+    HashPistasPerfeito pistas;
+    if (construirHashPistasPerfeito(&pistas, m->base, m->totalBase) != 0)
+    {
+        printf("Erro ao montar o índice de pistas da mansão.\n");
+        liberarMansaoProcedural(m);
+        return 1;
+    }
+    IndiceSuspeitos nomes;
+    construirIndiceSuspeitos(&nomes, m->suspeitos, m->totalSuspeitos);
+    RegistroCompartilhado registro;
+    criarRegistroCompartilhado(&registro, (size_t)m->totalBase, m->totalSuspeitos);
+
+    pthread_t ids[64];
+    Investigador inv[64];
+    for (int j = 0; j < jogadores; ++j)
+    {
+        inv[j] = (Investigador){m, &pistas, &nomes, &registro, misturar64(semente + (uint64_t)j + 1), 64, 0, 0};
+        pthread_create(&ids[j], NULL, investigar, &inv[j]);
+    }
+    long somaNovas = 0;
+    printf("\n===== Investigação cooperativa (%d jogador(es), %zu cômodos) =====\n", jogadores, totalComodos);
+    for (int j = 0; j < jogadores; ++j)
+    {
+        pthread_join(ids[j], NULL);
+        somaNovas += inv[j].novas;
+        printf("Jogador %2d: %6ld pista(s) vista(s), %5ld registrada(s) primeiro\n", j + 1, inv[j].vistas, inv[j].novas);
+    }
+    printf("\nPistas distintas no registro: %llu\n", (unsigned long long)registro.total);
+    for (int k = 0; k < m->totalSuspeitos; ++k)
+        printf(" - %-24s %llu pista(s)\n", m->suspeitos[k], (unsigned long long)contagemCompartilhada(&registro, k));
+    int ok = (uint64_t)somaNovas == registro.total;
+
+    liberarRegistroCompartilhado(&registro);
+    liberarIndiceSuspeitos(&nomes);
+    liberarHashPistasPerfeito(&pistas);
+    liberarMansaoProcedural(m);
+    return ok ? 0 : 1;
+}
+
+// ---------------------------------
+// Trim utility
+// ---------------------------------
+void trim_newline(char *s) // remove \n e \r
+{
+    if (!s)
+        return;
+    s[strcspn(s, "\r\n")] = '\0';
+}
+
+// Finalizador do splitmix64: espalha bem os bits de um inteiro de 64 bits
+uint64_t misturar64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Gerador pseudoaleatório determinístico (splitmix64), independente de rand()
+uint64_t aleatorio64(uint64_t *estado)
+{
+    return misturar64(*estado += 0x9E3779B97F4A7C15ull);
+}
+
+// ---------------------------------
+// Instrumentação
+// ---------------------------------
+// Relógio monotônico em nanossegundos (seguro para uso em handler de sinal)
+uint64_t relogioNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Buffer de saída montado sem printf, para poder ser usado dentro do handler
+typedef struct
+{
+    char dados[8192];
+    size_t n;
+} BufferEst;
+
+static void bufTexto(BufferEst *b, const char *s)
+{
+    while (*s && b->n < sizeof(b->dados))
+        b->dados[b->n++] = *s++;
+}
+static void bufNumero(BufferEst *b, uint64_t v)
+{
+    char tmp[24];
+    int i = 0;
+    do
+    {
+        tmp[i++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (i > 0 && b->n < sizeof(b->dados))
+        b->dados[b->n++] = tmp[--i];
+}
+static void escreverBuffer(int fd, const BufferEst *b)
+{
+    size_t feito = 0;
+    while (feito < b->n)
+    {
+        ssize_t w = write(fd, b->dados + feito, b->n - feito);
+        if (w <= 0)
+            break;
+        feito += (size_t)w;
+    }
+}
+
+#ifdef ESTATISTICAS
+static void bufHistograma(BufferEst *b, const char *titulo, const uint64_t *hist, int log2)
+{
+    bufTexto(b, titulo);
+    bufTexto(b, ":\n");
+    for (int i = 0; i < EST_BALDES; ++i)
+    {
+        if (hist[i] == 0)
+            continue;
+        bufTexto(b, "    ");
+        if (log2)
+        {
+            bufTexto(b, "< ");
+            bufNumero(b, (uint64_t)1 << (i + 1));
+            bufTexto(b, " " EST_UNIDADE);
+        }
+        else
+        {
+            if (i == EST_BALDES - 1)
+                bufTexto(b, ">=");
+            bufNumero(b, (uint64_t)i);
+        }
+        bufTexto(b, ": ");
+        bufNumero(b, hist[i]);
+        bufTexto(b, "\n");
+    }
+}
+// Todos os campos são contadores uint64_t somáveis
+#define CAMPOS_SOMADOS_EST (sizeof(Estatisticas) / sizeof(uint64_t))
+// Soma dois blocos de contadores (campo a campo, tudo é uint64_t)
+static void somarEstatisticas(Estatisticas *dst, const Estatisticas *src)
+{
+    uint64_t *d = (uint64_t *)dst;
+    const uint64_t *o = (const uint64_t *)src;
+    for (size_t i = 0; i < CAMPOS_SOMADOS_EST; ++i)
+        d[i] += o[i];
+}
+static void tratarSinalEstatisticas(int sinal)
+{
+    (void)sinal;
+    imprimirEstatisticas(STDERR_FILENO);
+}
+static void imprimirEstatisticasSaida(void)
+{
+    imprimirEstatisticas(STDERR_FILENO);
+}
+#endif
+
+// Liga o dump dos contadores na saída do programa e no SIGUSR1
+void registrarEstatisticas(void)
+{
+#ifdef ESTATISTICAS
+    atexit(imprimirEstatisticasSaida);
+    signal(SIGUSR1, tratarSinalEstatisticas);
+#endif
+}
+
+// Move os contadores da thread atual para o total global; toda função de
+// thread chama ao sair (rodando na thread principal, só adianta a soma)
+void consolidarEstatisticas(void)
+{
+#ifdef ESTATISTICAS
+    uint64_t *d = (uint64_t *)&estGlobal;
+    uint64_t *o = (uint64_t *)&estLocal;
+    for (size_t i = 0; i < CAMPOS_SOMADOS_EST; ++i)
+    {
+        __atomic_fetch_add(&d[i], o[i], __ATOMIC_RELAXED);
+        o[i] = 0;
+    }
+#endif
+}
+
+// Escreve os contadores (global + thread atual) no descritor indicado.
+// Usa só write(), então pode ser chamada de dentro de um handler de sinal.
+void imprimirEstatisticas(int fd)
+{
+#ifdef ESTATISTICAS
+    Estatisticas e = estGlobal;
+    somarEstatisticas(&e, &estLocal);
+
+    // só as estruturas que este processo usou: a partida, por exemplo, não
+    // chama buscarBST nem a hash encadeada
+    BufferEst b = {.n = 0};
+    bufTexto(&b, "\n===== Estatísticas =====\n");
+    if (e.passos)
+    {
+        // tempo só de passoJogo, prepararComodo e inserirBST; a espera no
+        // fgets e a impressão ficam de fora
+        bufTexto(&b, "jogo: ");
+        bufNumero(&b, e.passos);
+        bufTexto(&b, " passos (");
+        bufNumero(&b, e.movimentos);
+        bufTexto(&b, " movimentos) em ");
+        bufNumero(&b, e.tempoPassosNs / 1000u);
+        bufTexto(&b, " us de processamento, ");
+        bufNumero(&b, e.tempoPassosNs / e.passos);
+        bufTexto(&b, " ns/passo (");
+        bufNumero(&b, e.tempoPassosNs ? e.passos * 1000000000u / e.tempoPassosNs : 0);
+        bufTexto(&b, " passos/s)\n");
+    }
+    if (e.insercoesBST)
+    {
+        bufTexto(&b, "inserirBST: ");
+        bufNumero(&b, e.insercoesBST);
+        bufTexto(&b, " chamadas\n");
+        bufHistograma(&b, "  profundidade", e.profInsercaoBST, 0);
+        bufHistograma(&b, "  latência", e.latInsercaoBST, 1);
+    }
+    if (e.buscasBST)
+    {
+        bufTexto(&b, "buscarBST: ");
+        bufNumero(&b, e.buscasBST);
+        bufTexto(&b, " chamadas\n");
+        bufHistograma(&b, "  profundidade", e.profBuscaBST, 0);
+        bufHistograma(&b, "  latência", e.latBuscaBST, 1);
+    }
+    if (e.buscasRadix)
+    {
+        bufTexto(&b, "índice radix: ");
+        bufNumero(&b, e.buscasRadix);
+        bufTexto(&b, " buscas\n");
+    }
+    if (e.consultasRelacao)
+    {
+        bufTexto(&b, "idPistaRelacao: ");
+        bufNumero(&b, e.consultasRelacao);
+        bufTexto(&b, " consultas\n");
+    }
+    if (e.insercoesHash)
+    {
+        bufTexto(&b, "inserirHashPista: ");
+        bufNumero(&b, e.insercoesHash);
+        bufTexto(&b, " chamadas\n");
+        bufHistograma(&b, "  tamanho da cadeia", e.cadeiaHash, 0);
+    }
+    if (e.chamadasHash)
+    {
+        bufTexto(&b, "funcao_hash: ");
+        bufNumero(&b, e.chamadasHash);
+        bufTexto(&b, " chamadas, custo médio ");
+        bufNumero(&b, e.tempoHash / e.chamadasHash);
+        bufTexto(&b, " " EST_UNIDADE "\n");
+        bufHistograma(&b, "  latência", e.latHash, 1);
+    }
+    bufTexto(&b, "========================\n");
+    escreverBuffer(fd, &b);
+    imprimirMemoria(fd);
+#else
+    (void)fd;
+#endif
+}
+
+// ---------------------------------
+// Contabilidade de memória
+// ---------------------------------
+// Cada alocação de nó passa por alocarContado/liberarContado com a categoria
+// e o tamanho; o tamanho na liberação sai do próprio nó (texto longo no fim).
+// Dois fetch_add por operação, sem trava; o pico é um máximo por CAS.
+static ContadorMemoria contadoresMemoria[TOTAL_CATEGORIAS_MEMORIA];
+static uint64_t inicioMemoriaNs;
+static const char *const nomesMemoria[TOTAL_CATEGORIAS_MEMORIA] = {"cômodos", "pistas", "hash",   "arena",
+                                                                   "radix",   "relação", "hash perfeito"};
+
+static void contarAlocacao(CategoriaMemoria cat, size_t objetos, size_t bytes)
+{
+    ContadorMemoria *c = &contadoresMemoria[cat];
+    __atomic_fetch_add(&c->alocacoes, objetos, __ATOMIC_RELAXED);
+    uint64_t alocados = __atomic_add_fetch(&c->bytesAlocados, bytes, __ATOMIC_RELAXED);
+    uint64_t liberados = __atomic_load_n(&c->bytesLiberados, __ATOMIC_RELAXED);
+    // liberados pode incluir bytes de outra thread ainda fora de alocados
+    uint64_t vivos = alocados > liberados ? alocados - liberados : 0;
+    uint64_t pico = __atomic_load_n(&c->picoBytes, __ATOMIC_RELAXED);
+    while (vivos > pico &&
+           !__atomic_compare_exchange_n(&c->picoBytes, &pico, vivos, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+void *alocarContado(CategoriaMemoria cat, size_t objetos, size_t bytes)
+{
+    void *p = malloc(bytes);
+    if (p != NULL)
+        contarAlocacao(cat, objetos, bytes);
+    return p;
+}
+
+// Vetor que cresce: bytesAntes saem da conta e bytes entram. Com p == NULL
+// é uma alocação nova e conta como um objeto.
+void *realocarContado(CategoriaMemoria cat, void *p, size_t bytesAntes, size_t bytes)
+{
+    void *novo = realloc(p, bytes);
+    if (novo == NULL)
+        return NULL;
+    if (p != NULL)
+        __atomic_fetch_add(&contadoresMemoria[cat].bytesLiberados, bytesAntes, __ATOMIC_RELAXED);
+    contarAlocacao(cat, p == NULL, bytes);
+    return novo;
+}
+
+void liberarContado(CategoriaMemoria cat, void *p, size_t objetos, size_t bytes)
+{
+    if (p == NULL)
+        return;
+    free(p);
+    ContadorMemoria *c = &contadoresMemoria[cat];
+    __atomic_fetch_add(&c->liberacoes, objetos, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&c->bytesLiberados, bytes, __ATOMIC_RELAXED);
+}
+
+void consultarMemoria(CategoriaMemoria cat, ContagemMemoria *c)
+{
+    const ContadorMemoria *o = &contadoresMemoria[cat];
+    uint64_t liberacoes = __atomic_load_n(&o->liberacoes, __ATOMIC_RELAXED);
+    uint64_t bytesLiberados = __atomic_load_n(&o->bytesLiberados, __ATOMIC_RELAXED);
+    c->alocacoes = __atomic_load_n(&o->alocacoes, __ATOMIC_RELAXED);
+    c->bytesAlocados = __atomic_load_n(&o->bytesAlocados, __ATOMIC_RELAXED);
+    c->objetos = c->alocacoes - liberacoes;
+    c->bytes = c->bytesAlocados - bytesLiberados;
+    c->picoBytes = __atomic_load_n(&o->picoBytes, __ATOMIC_RELAXED);
+}
+
+// Tabela por categoria no descritor indicado; só write(), serve em handler de sinal
+void imprimirMemoria(int fd)
+{
+    uint64_t decorrido = inicioMemoriaNs ? relogioNs() - inicioMemoriaNs : 0;
+    BufferEst b = {.n = 0};
+    bufTexto(&b, "\n===== Memória =====\n");
+    for (int cat = 0; cat < TOTAL_CATEGORIAS_MEMORIA; ++cat)
+    {
+        ContagemMemoria c;
+        consultarMemoria((CategoriaMemoria)cat, &c);
+        bufTexto(&b, nomesMemoria[cat]);
+        bufTexto(&b, ": ");
+        bufNumero(&b, c.objetos);
+        bufTexto(&b, " vivos, ");
+        bufNumero(&b, c.bytes);
+        bufTexto(&b, " bytes (pico ");
+        bufNumero(&b, c.picoBytes);
+        bufTexto(&b, "), ");
+        bufNumero(&b, c.alocacoes);
+        bufTexto(&b, " alocações");
+        if (decorrido >= 1000000u)
+        {
+            bufTexto(&b, ", ");
+            bufNumero(&b, c.alocacoes * 1000u / (decorrido / 1000000u));
+            bufTexto(&b, "/s");
+        }
+        bufTexto(&b, "\n");
+    }
+    bufTexto(&b, "====================\n");
+    escreverBuffer(fd, &b);
+}
+
+// Compara com um retrato anterior (vetor com TOTAL_CATEGORIAS_MEMORIA entradas).
+// Relata e conta as categorias que ficaram com objetos ou bytes a mais.
+int conferirVazamentos(const ContagemMemoria antes[], const char *contexto)
+{
+    int vazamentos = 0;
+    for (int cat = 0; cat < TOTAL_CATEGORIAS_MEMORIA; ++cat)
+    {
+        ContagemMemoria c;
+        consultarMemoria((CategoriaMemoria)cat, &c);
+        if (c.objetos == antes[cat].objetos && c.bytes == antes[cat].bytes)
+            continue;
+        fprintf(stderr, "[memoria] vazamento em %s: %s com %lld objetos e %lld bytes a mais\n", contexto,
+                nomesMemoria[cat], (long long)(c.objetos - antes[cat].objetos), (long long)(c.bytes - antes[cat].bytes));
+        vazamentos++;
+    }
+    return vazamentos;
+}
+
+static void tratarSinalMemoria(int sinal)
+{
+    (void)sinal;
+    imprimirMemoria(STDERR_FILENO);
+}
+static void conferirMemoriaSaida(void)
+{
+    static const ContagemMemoria zero[TOTAL_CATEGORIAS_MEMORIA];
+    if (conferirVazamentos(zero, "saída"))
+        imprimirMemoria(STDERR_FILENO);
+}
+
+// Marca o início (para a taxa de alocação), liga o dump no SIGUSR2 e a
+// conferência de vazamentos na saída do programa
+void registrarMemoria(void)
+{
+    inicioMemoriaNs = relogioNs();
+    signal(SIGUSR2, tratarSinalMemoria);
+    atexit(conferirMemoriaSaida);
+}
+
+// ---------------------------------
+// Motor de jogo: regras puras (sem E/S; só iniciarJogo aloca)
+// ---------------------------------
+// Prepara uma partida nova: o motor de pontuação é dimensionado pela relação
+// do mundo, então não há limite de pistas nem de suspeitos.
+void iniciarJogo(const MundoJogo *mundo, EstadoJogo *e)
+{
+    memset(e, 0, sizeof(*e));
+    e->fase = FASE_MAPA;
+    e->atual = mundo->raiz;
+    iniciarMotorPontuacao(&e->motor, mundo->rel);
+}
+
+// Recomeça a partida no mesmo mundo sem realocar o motor
+void reiniciarJogo(const MundoJogo *mundo, EstadoJogo *e)
+{
+    e->fase = FASE_MAPA;
+    e->atual = mundo->raiz;
+    e->termo[0] = '\0';
+    zerarMotorPontuacao(&e->motor);
+}
+
+void liberarJogo(EstadoJogo *e)
+{
+    liberarMotorPontuacao(&e->motor);
+}
+
+// Pista de um cômodo: id na relação (>= 0), -1 sem pista ou -2 se a pista não
+// está na relação. Com pistaDe o id já vem do sorteio; senão uma sondagem no CHD.
+static int pistaNoComodo(const MundoJogo *mundo, const Comodo *c, const char **texto)
+{
+    if (mundo->pistaDe != NULL)
+    {
+        int p = mundo->pistaDe[c - mundo->comodos];
+        *texto = p >= 0 ? mundo->rel->pistas[p] : NULL;
+        return p;
+    }
+    if (c->pista.tam == 0)
+        return -1;
+    *texto = lerTexto(&c->pista);
+    int p = idPistaRelacao(mundo->rel, *texto);
+    return p >= 0 ? p : -2;
+}
+
+// Suspeito principal da pista: o da primeira ligação (as da base vêm antes das extras)
+static const char *suspeitoPrincipal(const MundoJogo *mundo, int p)
+{
+    const RelacaoPistaSuspeito *rel = mundo->rel;
+    return rel->inicioPista[p] < rel->inicioPista[p + 1] ? mundo->suspeitos[rel->suspeitoDe[rel->inicioPista[p]]] : "Desconhecido";
+}
+
+// Um passo da partida. entrada é a linha digitada, já sem o \n; os eventos
+// (no máximo MAX_EVENTOS_PASSO) vão para ev[] e o retorno diz quantos são.
+// Linha vazia no mapa ou no menu final não muda nada.
+int passoJogo(const MundoJogo *mundo, EstadoJogo *e, const char *entrada, EventoJogo ev[])
+{
+    int n = 0;
+    char c = entrada[0];
+    switch (e->fase)
+    {
+    case FASE_MAPA:
+    {
+        if (c == '\0')
+            break;
+        if (c == 's')
+        {
+            ev[n++] = (EventoJogo){.tipo = EVENTO_SAIU_MAPA};
+            e->fase = FASE_FINAL;
+            break;
+        }
+        if (c != 'e' && c != 'd')
+        {
+            ev[n++] = (EventoJogo){.tipo = EVENTO_OPCAO_INVALIDA};
+            break;
+        }
+        const Comodo *dest = c == 'e' ? e->atual->esquerda : e->atual->direita;
+        if (dest == NULL)
+        {
+            ev[n++] = (EventoJogo){.tipo = EVENTO_SEM_CAMINHO};
+            break;
+        }
+        e->atual = dest;
+        ev[n++] = (EventoJogo){.tipo = EVENTO_ENTROU, .comodo = dest};
+        const char *pista = NULL;
+        int p = pistaNoComodo(mundo, dest, &pista);
+        if (p == -1)
+            ev[n++] = (EventoJogo){.tipo = EVENTO_SEM_PISTA, .comodo = dest};
+        else if (p < 0)
+            ev[n++] = (EventoJogo){.tipo = EVENTO_PISTA_SOLTA, .comodo = dest, .pista = pista};
+        else if (!coletarPistaMotor(&e->motor, p))
+            ev[n++] = (EventoJogo){.tipo = EVENTO_PISTA_REPETIDA, .valor = p, .comodo = dest, .pista = pista};
+        else
+            ev[n++] = (EventoJogo){.tipo = EVENTO_PISTA_NOVA, .valor = p, .comodo = dest, .pista = pista,
+                                   .texto = suspeitoPrincipal(mundo, p)};
+        break;
+    }
+    case FASE_FINAL:
+        if (c == '\0')
+            break;
+        if (c == '1')
+            ev[n++] = (EventoJogo){.tipo = EVENTO_RANKING};
+        else if (c == '2')
+            e->fase = FASE_LISTAR;
+        else if (c == '3')
+            e->fase = FASE_ACUSAR;
+        else if (c == '4')
+        {
+            ev[n++] = (EventoJogo){.tipo = EVENTO_FIM};
+            e->fase = FASE_FIM;
+        }
+        else if (c == '5')
+            e->fase = FASE_PREFIXO;
+        else if (c == '6')
+            e->fase = FASE_APROXIMADA;
+        else if (c == '7')
+            ev[n++] = (EventoJogo){.tipo = EVENTO_RELATORIO};
+        else
+            ev[n++] = (EventoJogo){.tipo = EVENTO_OPCAO_INVALIDA};
+        break;
+    case FASE_LISTAR:
+    case FASE_ACUSAR:
+    {
+        int escolha = atoi(entrada);
+        if (escolha < 1 || escolha > mundo->totalSuspeitos)
+            ev[n++] = (EventoJogo){.tipo = EVENTO_ESCOLHA_INVALIDA};
+        else if (e->fase == FASE_LISTAR)
+            ev[n++] = (EventoJogo){.tipo = EVENTO_PISTAS_SUSPEITO, .valor = escolha - 1};
+        else
+            ev[n++] = (EventoJogo){.tipo = EVENTO_ACUSACAO, .valor = escolha - 1,
+                                   .correta = acusacaoCorreta(&e->motor, escolha - 1)};
+        e->fase = FASE_FINAL;
+        break;
+    }
+    case FASE_PREFIXO:
+        ev[n++] = (EventoJogo){.tipo = EVENTO_BUSCA_PREFIXO, .texto = entrada};
+        e->fase = FASE_FINAL;
+        break;
+    case FASE_APROXIMADA:
+        strncpy(e->termo, entrada, sizeof(e->termo) - 1);
+        e->termo[sizeof(e->termo) - 1] = '\0';
+        e->fase = FASE_DISTANCIA;
+        break;
+    case FASE_DISTANCIA:
+    {
+        int maxDist = c != '\0' ? atoi(entrada) : 2;
+        ev[n++] = (EventoJogo){.tipo = EVENTO_BUSCA_APROXIMADA, .valor = maxDist < 0 ? 0 : maxDist, .texto = e->termo};
+        e->fase = FASE_FINAL;
+        break;
+    }
+    default:
+        break;
+    }
+    return n;
+}
+
+// ---------------------------------
+// Terminal: prompts e eventos em texto
+// ---------------------------------
+static void imprimirSuspeitos(const MundoJogo *mundo)
+{
+    for (int i = 0; i < mundo->totalSuspeitos; ++i)
+        printf(" %d) %s\n", i + 1, mundo->suspeitos[i]);
+}
+
+void imprimirPromptJogo(const MundoJogo *mundo, const EstadoJogo *e)
+{
+    switch (e->fase)
+    {
+    case FASE_MAPA:
+        printf("\n===== Mapa da Mansão =====\n");
+        printf("Você está em: %s\n\n", lerTexto(&e->atual->nome));
+        printf("e - Ir para esquerda  [%s]\n", e->atual->esquerda ? lerTexto(&e->atual->esquerda->nome) : "Nenhum");
+        printf("d - Ir para direita   [%s]\n", e->atual->direita ? lerTexto(&e->atual->direita->nome) : "Nenhum");
+        printf("s - Sair do mapa (Ir para o menu de suspeitos)\n");
+        printf("===========================\n");
+        printf("Escolha: ");
+        break;
+    case FASE_FINAL:
+        printf("\n===== MENU FINAL =====\n");
+        printf("1 - Ver suspeito(s) mais associado(s)\n");
+        printf("2 - Mostrar pistas por suspeito\n");
+        printf("3 - Acusar um suspeito\n");
+        printf("4 - Sair\n");
+        printf("5 - Buscar pistas por prefixo\n");
+        printf("6 - Busca aproximada de pista\n");
+        printf("7 - Relatório completo por suspeito\n");
+        printf("======================\n");
+        printf("Escolha: ");
+        break;
+    case FASE_LISTAR:
+        printf("\nEscolha um suspeito para ver suas pistas:\n");
+        imprimirSuspeitos(mundo);
+        printf("Escolha (numero): ");
+        break;
+    case FASE_ACUSAR:
+        printf("\nLista de suspeitos:\n");
+        imprimirSuspeitos(mundo);
+        printf("Escolha um suspeito para acusar (numero): ");
+        break;
+    case FASE_PREFIXO:
+        printf("Prefixo: ");
+        break;
+    case FASE_APROXIMADA:
+        printf("Texto da pista: ");
+        break;
+    case FASE_DISTANCIA:
+        printf("Distância máxima (padrão 2): ");
+        break;
+    default:
+        break;
+    }
+}
+
+// Texto dos eventos que não dependem de estruturas do terminal (BST, hash, índice)
+void imprimirEventoJogo(const MundoJogo *mundo, const EstadoJogo *e, const EventoJogo *ev)
+{
+    switch (ev->tipo)
+    {
+    case EVENTO_ENTROU:
+        printf("Você entrou em: %s\n", lerTexto(&ev->comodo->nome));
+        break;
+    case EVENTO_PISTA_NOVA:
+        printf("Pista visível: %s\n", ev->pista);
+        printf("Pista registrada. Suspeito associado: %s\n", ev->texto);
+        break;
+    case EVENTO_PISTA_REPETIDA:
+        printf("Pista visível: %s\n", ev->pista);
+        printf("Você já registrou essa pista antes.\n");
+        break;
+    case EVENTO_PISTA_SOLTA:
+        printf("Pista visível: %s\n", ev->pista);
+        printf("Nenhum suspeito da lista está ligado a essa pista.\n");
+        break;
+    case EVENTO_SEM_PISTA:
+        printf("Sem pista visível aqui.\n");
+        break;
+    case EVENTO_SEM_CAMINHO:
+        printf("Não existe cômodo nessa direção.\n");
+        break;
+    case EVENTO_OPCAO_INVALIDA:
+        printf("Opção inválida.\n");
+        break;
+    case EVENTO_SAIU_MAPA:
+        printf("Saindo do mapa.\n");
+        break;
+    case EVENTO_RANKING:
+    {
+        const double *pontuacao = e->motor.pontuacao;
+        int *ordem = malloc((size_t)mundo->totalSuspeitos * sizeof(*ordem) + 1);
+        if (ordem == NULL)
+        {
+            printf("Erro ao alocar memória para o ranking.\n");
+            exit(1);
+        }
+        int totalRelevantes = rankingMotor(&e->motor, ordem);
+        if (totalRelevantes == 0)
+        {
+            printf("Nenhuma pista coletada. Ninguém associado ainda.\n");
+            free(ordem);
+            break;
+        }
+        // se há empate, mostramos todos com o mesmo valor
+        double maxVal = pontuacao[ordem[0]];
+        printf("\nSuspeito(s) mais associado(s) com pontuação %.2f:\n", maxVal);
+        for (int i = 0; i < totalRelevantes && pontuacao[ordem[i]] + EPSILON_PONTUACAO >= maxVal; ++i)
+            printf(" - %s\n", mundo->suspeitos[ordem[i]]);
+
+        printf("\nRanking por pontuação:\n");
+        for (int i = 0; i < totalRelevantes && i < 10; ++i)
+            printf(" %2d) %-24s %.2f\n", i + 1, mundo->suspeitos[ordem[i]], pontuacao[ordem[i]]);
+        free(ordem);
+        break;
+    }
+    case EVENTO_PISTAS_SUSPEITO:
+        listarPistasColetadasSuspeito(&e->motor, mundo->suspeitos, ev->valor);
+        break;
+    case EVENTO_ACUSACAO:
+    {
+        double pontos = e->motor.pontuacao[ev->valor];
+        printf("\nVocê acusou: %s\n", mundo->suspeitos[ev->valor]);
+        printf("Pistas associadas a esse suspeito: %d\n", contarPistasColetadasSuspeito(&e->motor, ev->valor));
+        printf("Pontuação das evidências: %.2f\n", pontos);
+        if (ev->correta)
+            printf("Resultado: ACERTOU! Esse suspeito tem a maior pontuação (%.2f).\n", pontos);
+        else
+            printf("Resultado: ERROU. Esse suspeito não tem a maior pontuação ou não chega a %.1f.\n", LIMIAR_ACUSACAO);
+        break;
+    }
+    case EVENTO_ESCOLHA_INVALIDA:
+        printf("Escolha inválida.\n");
+        break;
+    case EVENTO_FIM:
+        printf("Saindo do menu final.\n");
+        break;
+    default:
+        break;
+    }
+}
+
+// ---------------------------------
+// Menu de navegação (coleção de pistas)
+// ---------------------------------
+// Lê linhas até o jogador sair do mapa; pistas novas vão para a BST. Quem
+// pontua e responde "qual suspeito" é o motor da partida, não uma hash à parte.
+void menu(const MundoJogo *mundo, EstadoJogo *jogo, NoBST **pistasBST)
+{
+    char entrada[64];
+    EventoJogo ev[MAX_EVENTOS_PASSO];
+
+    while (jogo->fase == FASE_MAPA)
+    {
+        EST_INICIO_NS(tPreparo);
+        if (mundo->sobDemanda != NULL)
+            prepararComodo(mundo->sobDemanda, jogo->atual);
+        EST_ACUMULAR_NS(tempoPassosNs, tPreparo);
+        imprimirPromptJogo(mundo, jogo);
+        if (fgets(entrada, sizeof(entrada), stdin) == NULL)
+            break;
+        trim_newline(entrada);
+        EST_INICIO_NS(tPasso);
+        int n = passoJogo(mundo, jogo, entrada, ev);
+        EST_INC(passos);
+        for (int i = 0; i < n; ++i)
+            if (ev[i].tipo == EVENTO_PISTA_NOVA)
+                *pistasBST = inserirBST(*pistasBST, ev[i].pista);
+        EST_ACUMULAR_NS(tempoPassosNs, tPasso);
+        for (int i = 0; i < n; ++i)
+        {
+            if (ev[i].tipo == EVENTO_ENTROU)
+                EST_INC(movimentos);
+            imprimirEventoJogo(mundo, jogo, &ev[i]);
+        }
+    }
+}
+
+// ---------------------------------
+// Menu final: análises e acusação
+// ---------------------------------
+// Relatório por suspeito das pistas coletadas na partida
+void montarRelatorioJogo(RelatorioFinal *r, const MundoJogo *mundo, const EstadoJogo *jogo)
+{
+    int *coletadas = malloc((size_t)jogo->motor.totalColetadas * sizeof(*coletadas) + 1);
+    if (coletadas == NULL)
+    {
+        printf("Erro ao alocar memória para o relatório.\n");
+        exit(1);
+    }
+    int qtd = pistasColetadasMotor(&jogo->motor, coletadas);
+    montarRelatorio(r, mundo->rel, coletadas, qtd, jogo->motor.pontuacao, mundo->suspeitos, 0);
+    free(coletadas);
+}
+
+// Buscas usam o índice radix, que fica fora do motor.
+void menuFinal(const MundoJogo *mundo, EstadoJogo *jogo, NoRadix *indice)
+{
+    char entrada[80];
+    EventoJogo ev[MAX_EVENTOS_PASSO];
+
+    if (jogo->fase == FASE_MAPA) // a entrada acabou ainda no mapa
+        jogo->fase = FASE_FINAL;
+    while (jogo->fase != FASE_FIM)
+    {
+        imprimirPromptJogo(mundo, jogo);
+        if (fgets(entrada, sizeof(entrada), stdin) == NULL)
+            break;
+        trim_newline(entrada);
+        EST_INICIO_NS(tPasso);
+        int n = passoJogo(mundo, jogo, entrada, ev);
+        EST_INC(passos);
+        EST_ACUMULAR_NS(tempoPassosNs, tPasso);
+        for (int i = 0; i < n; ++i)
+        {
+            if (ev[i].tipo == EVENTO_BUSCA_PREFIXO || ev[i].tipo == EVENTO_BUSCA_APROXIMADA)
+            {
+                // o índice guarda as pistas normalizadas; o termo passa pela mesma forma
+                char termo[sizeof(entrada)];
+                normalizarPista(ev[i].texto, strlen(ev[i].texto), termo);
+                int achadas;
+                if (ev[i].tipo == EVENTO_BUSCA_PREFIXO)
+                {
+                    printf("\nPistas começando com \"%s\":\n", ev[i].texto);
+                    achadas = buscarPrefixoRadix(indice, termo, imprimirPistaVisitada, NULL);
+                }
+                else
+                {
+                    printf("\nPistas parecidas com \"%s\":\n", ev[i].texto);
+                    achadas = buscarAproximadoRadix(indice, termo, ev[i].valor, imprimirPistaVisitada, NULL);
+                }
+                if (achadas == 0)
+                    printf("Nenhuma pista encontrada.\n");
+            }
+            else if (ev[i].tipo == EVENTO_RELATORIO)
+            {
+                RelatorioFinal relatorio;
+                montarRelatorioJogo(&relatorio, mundo, jogo);
+                printf("\n===== Relatório por suspeito =====\n");
+                emitirRelatorio(&relatorio, stdout);
+                liberarRelatorio(&relatorio);
+            }
+            else
+                imprimirEventoJogo(mundo, jogo, &ev[i]);
+        }
+    }
+}
+
+// ---------------------------------
+// Modo servidor: muitas sessões sobre epoll
+// ---------------------------------
+// ./mestre servidor [porta|caminho] [threads]
+// Cada conexão é uma partida. A mansão, a base e a relação pista <-> suspeito
+// são montadas uma vez e compartilhadas só para leitura; a sessão guarda apenas
+// o EstadoJogo (cômodo e o motor com pistas em bitset e pontuações) e os buffers, e cada
+// linha recebida vira um passoJogo.
+// Protocolo de texto: uma jogada por linha; toda resposta termina com o
+// prompt "\n> ", que é como o gerador de carga sabe que a jogada acabou.
+// Algumas threads rodam laços epoll independentes; o socket de escuta entra
+// em todos com EPOLLEXCLUSIVE, então cada conexão nova acorda só um laço.
+#ifdef __linux__
+
+typedef struct
+{
+    MundoJogo jogo;
+    int escuta;
+} MundoServidor;
+
+typedef struct
+{
+    int fd;
+    unsigned char eventos; // interesse registrado no epoll (1 = leitura, 2 = escrita)
+    uint16_t tamEntrada;
+    uint16_t tamSaida, enviados;
+    EstadoJogo jogo;
+    char entrada[TAM_ENTRADA_SESSAO];
+    char saida[TAM_SAIDA_SESSAO];
+} Sessao;
+
+// Acrescenta à saída da sessão (a folga de MAX_RESPOSTA é garantida antes do passo)
+static void escreverSessao(Sessao *s, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(s->saida + s->tamSaida, sizeof(s->saida) - s->tamSaida, fmt, args);
+    va_end(args);
+    if (n > 0)
+        s->tamSaida = (uint16_t)(s->tamSaida + (size_t)n < sizeof(s->saida) ? s->tamSaida + (size_t)n : sizeof(s->saida) - 1);
+}
+
+static void promptSessao(const MundoJogo *mundo, Sessao *s)
+{
+    const EstadoJogo *e = &s->jogo;
+    if (e->fase == FASE_MAPA)
+        escreverSessao(s, "\nVocê está em: %s\ne - esquerda [%s]\nd - direita [%s]\ns - sair do mapa\n> ",
+                       lerTexto(&e->atual->nome), e->atual->esquerda ? lerTexto(&e->atual->esquerda->nome) : "Nenhum",
+                       e->atual->direita ? lerTexto(&e->atual->direita->nome) : "Nenhum");
+    else if (e->fase == FASE_FINAL)
+        escreverSessao(s, "\n1 - ranking  2 - pistas  3 - acusar  4 - sair\n> ");
+    else if (e->fase == FASE_LISTAR || e->fase == FASE_ACUSAR)
+    {
+        for (int i = 0; i < mundo->totalSuspeitos; ++i)
+            escreverSessao(s, " %d) %s\n", i + 1, mundo->suspeitos[i]);
+        escreverSessao(s, "Suspeito (numero)\n> ");
+    }
+}
+
+// Uma jogada: passo do motor, eventos em texto compacto e o próximo prompt
+static void passoSessao(const MundoJogo *mundo, Sessao *s, const char *linha)
+{
+    EventoJogo ev[MAX_EVENTOS_PASSO];
+    const EstadoJogo *e = &s->jogo;
+    int n;
+    if (e->fase == FASE_FINAL && linha[0] >= '5' && linha[0] <= '7')
+    {
+        // buscas e relatório dependem de estruturas por partida que o servidor não mantém
+        escreverSessao(s, "Opção indisponível no servidor.\n");
+        n = 0;
+    }
+    else
+        n = passoJogo(mundo, &s->jogo, linha, ev);
+    for (int i = 0; i < n; ++i)
+    {
+        switch (ev[i].tipo)
+        {
+        case EVENTO_ENTROU:
+            escreverSessao(s, "Você entrou em: %s\n", lerTexto(&ev[i].comodo->nome));
+            break;
+        case EVENTO_PISTA_NOVA:
+            escreverSessao(s, "Pista visível: %s\nPista registrada. Suspeito associado: %s\n", ev[i].pista, ev[i].texto);
+            break;
+        case EVENTO_PISTA_REPETIDA:
+            escreverSessao(s, "Pista visível: %s\nVocê já registrou essa pista antes.\n", ev[i].pista);
+            break;
+        case EVENTO_PISTA_SOLTA:
+            escreverSessao(s, "Pista visível: %s\n", ev[i].pista);
+            break;
+        case EVENTO_SEM_PISTA:
+            escreverSessao(s, "Sem pista visível aqui.\n");
+            break;
+        case EVENTO_SEM_CAMINHO:
+            escreverSessao(s, "Não existe cômodo nessa direção.\n");
+            break;
+        case EVENTO_OPCAO_INVALIDA:
+            escreverSessao(s, "Opção inválida.\n");
+            break;
+        case EVENTO_SAIU_MAPA:
+            escreverSessao(s, "Saindo do mapa.\n");
+            break;
+        case EVENTO_RANKING:
+        {
+            int *ordem = malloc((size_t)mundo->totalSuspeitos * sizeof(*ordem) + 1);
+            if (ordem == NULL)
+            {
+                escreverSessao(s, "Erro ao montar o ranking.\n");
+                break;
+            }
+            int positivos = rankingMotor(&e->motor, ordem);
+            if (positivos == 0)
+                escreverSessao(s, "Nenhuma pista coletada. Ninguém associado ainda.\n");
+            for (int k = 0; k < positivos && k < MAX_RANKING_SESSAO; ++k)
+                escreverSessao(s, " %2d) %-24s %.2f\n", k + 1, mundo->suspeitos[ordem[k]], e->motor.pontuacao[ordem[k]]);
+            free(ordem);
+            break;
+        }
+        case EVENTO_PISTAS_SUSPEITO:
+        {
+            int qtd;
+            const int *pistas = pistasDoSuspeito(mundo->rel, ev[i].valor, &qtd);
+            escreverSessao(s, "%s: %d pista(s) coletada(s)\n", mundo->suspeitos[ev[i].valor],
+                           contarPistasColetadasSuspeito(&e->motor, ev[i].valor));
+            for (int k = 0; k < qtd; ++k)
+                if (pistaColetadaMotor(&e->motor, pistas[k]))
+                    escreverSessao(s, " - %s\n", mundo->rel->pistas[pistas[k]]);
+            break;
+        }
+        case EVENTO_ACUSACAO:
+            escreverSessao(s, "Você acusou: %s (pontuação %.2f)\nResultado: %s\n", mundo->suspeitos[ev[i].valor],
+                           e->motor.pontuacao[ev[i].valor], ev[i].correta ? "ACERTOU!" : "ERROU.");
+            break;
+        case EVENTO_ESCOLHA_INVALIDA:
+            escreverSessao(s, "Escolha inválida.\n");
+            break;
+        case EVENTO_FIM:
+            escreverSessao(s, "Saindo do menu final.\n");
+            break;
+        default:
+            break;
+        }
+    }
+    promptSessao(mundo, s);
+}
+
+// Envia o que der da saída pendente. Retorna -1 se a conexão caiu.
+static int enviarSessao(Sessao *s)
+{
+    while (s->enviados < s->tamSaida)
+    {
+        ssize_t w = send(s->fd, s->saida + s->enviados, s->tamSaida - s->enviados, MSG_NOSIGNAL);
+        if (w < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        s->enviados = (uint16_t)(s->enviados + w);
+    }
+    s->tamSaida = s->enviados = 0;
+    return 0;
+}
+
+// Consome linhas completas e lê mais enquanto houver espaço para responder.
+// Com saída pendente a sessão para de ler (o cliente sente a contrapressão).
+// Retorna -1 quando a sessão deve ser fechada.
+static int atenderSessao(const MundoServidor *mundo, Sessao *s)
+{
+    for (;;)
+    {
+        char *fim;
+        while (s->jogo.fase != FASE_FIM && s->tamSaida + MAX_RESPOSTA <= TAM_SAIDA_SESSAO &&
+               (fim = memchr(s->entrada, '\n', s->tamEntrada)) != NULL)
+        {
+            *fim = '\0';
+            trim_newline(s->entrada);
+            passoSessao(&mundo->jogo, s, s->entrada);
+            size_t usados = (size_t)(fim - s->entrada) + 1;
+            memmove(s->entrada, fim + 1, s->tamEntrada - usados);
+            s->tamEntrada = (uint16_t)(s->tamEntrada - usados);
+        }
+        if (s->tamEntrada == sizeof(s->entrada)) // linha grande demais: descarta
+            s->tamEntrada = 0;
+        if (enviarSessao(s) < 0)
+            return -1;
+        if (s->tamSaida > 0)
+            return 0;
+        if (s->jogo.fase == FASE_FIM)
+            return -1;
+        if (memchr(s->entrada, '\n', s->tamEntrada) != NULL)
+            continue; // ainda há linhas completas esperando espaço de saída
+        ssize_t r = recv(s->fd, s->entrada + s->tamEntrada, sizeof(s->entrada) - s->tamEntrada, 0);
+        if (r == 0)
+            return -1;
+        if (r < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        s->tamEntrada = (uint16_t)(s->tamEntrada + r);
+    }
+}
+
+static void fecharSessao(int ep, Sessao *s)
+{
+    epoll_ctl(ep, EPOLL_CTL_DEL, s->fd, NULL);
+    close(s->fd);
+    liberarJogo(&s->jogo);
+    free(s);
+}
+
+// Atende a sessão e ajusta o interesse no epoll: com saída pendente espera
+// poder escrever e para de ler; senão volta a esperar entrada.
+static void atualizarSessao(int ep, const MundoServidor *mundo, Sessao *s)
+{
+    if (atenderSessao(mundo, s) < 0)
+    {
+        fecharSessao(ep, s);
+        return;
+    }
+    unsigned char quer = s->tamSaida > 0 ? 2 : 1;
+    if (quer != s->eventos)
+    {
+        struct epoll_event mod = {.events = quer == 2 ? EPOLLOUT : EPOLLIN, .data.ptr = s};
+        epoll_ctl(ep, EPOLL_CTL_MOD, s->fd, &mod);
+        s->eventos = quer;
+    }
+}
+
+static void *lacoEventos(void *arg)
+{
+    const MundoServidor *mundo = arg;
+    int ep = epoll_create1(0);
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = NULL};
+    if (ep < 0 || epoll_ctl(ep, EPOLL_CTL_ADD, mundo->escuta, &ev) < 0)
+    {
+        perror("epoll");
+        return NULL;
+    }
+    struct epoll_event eventos[MAX_EVENTOS];
+    for (;;)
+    {
+        int n = epoll_wait(ep, eventos, MAX_EVENTOS, -1);
+        for (int i = 0; i < n; ++i)
+        {
+            Sessao *s = eventos[i].data.ptr;
+            if (s == NULL)
+            {
+                int fd;
+                while ((fd = accept(mundo->escuta, NULL, NULL)) >= 0)
+                {
+                    int um = 1;
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    fcntl(fd, F_SETFD, FD_CLOEXEC);
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um)); // falha inofensiva em socket Unix
+                    s = calloc(1, sizeof(*s));
+                    if (s == NULL)
+                    {
+                        close(fd);
+                        continue;
+                    }
+                    s->fd = fd;
+                    s->eventos = 1;
+                    iniciarJogo(&mundo->jogo, &s->jogo);
+                    promptSessao(&mundo->jogo, s);
+                    struct epoll_event novo = {.events = EPOLLIN, .data.ptr = s};
+                    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &novo);
+                    atualizarSessao(ep, mundo, s); // envia o prompt inicial
+                }
+                continue;
+            }
+            atualizarSessao(ep, mundo, s);
+        }
+        consolidarEstatisticas(); // o laço não termina: o dump do SIGUSR1 vê cada rodada
+    }
+    return NULL;
+}
+
+// "5555" vira 127.0.0.1:5555; qualquer coisa com '/' é um socket Unix
+static int enderecoServidor(const char *texto, struct sockaddr_storage *end, socklen_t *tam)
+{
+    memset(end, 0, sizeof(*end));
+    if (strchr(texto, '/'))
+    {
+        struct sockaddr_un *un = (struct sockaddr_un *)end;
+        if (strlen(texto) >= sizeof(un->sun_path))
+            return -1;
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, texto);
+        *tam = sizeof(*un);
+        return AF_UNIX;
+    }
+    struct sockaddr_in *in = (struct sockaddr_in *)end;
+    in->sin_family = AF_INET;
+    in->sin_port = htons((uint16_t)atoi(texto));
+    in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    *tam = sizeof(*in);
+    return AF_INET;
+}
+
+int executarServidor(int argc, char *argv[])
+{
+    const char *endereco = argc > 0 ? argv[0] : "5555";
+    int threads = argc > 1 ? atoi(argv[1]) : numeroThreads();
+    if (threads < 1)
+        threads = 1;
+    if (threads > 64)
+        threads = 64;
+
+    // mundo compartilhado: o mesmo cenário do jogo local, pistas sorteadas uma vez
+    srand((unsigned)time(NULL));
+    static CenarioPadrao cenario; // vive até o processo acabar
+    montarCenarioPadrao(&cenario, NULL);
+    MundoServidor mundo = {cenario.mundo, -1};
+    struct sockaddr_storage end;
+    socklen_t tamEnd;
+    int familia = enderecoServidor(endereco, &end, &tamEnd);
+    int escuta = familia < 0 ? -1 : socket(familia, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int um = 1;
+    if (familia == AF_UNIX)
+        unlink(endereco);
+    else if (escuta >= 0)
+        setsockopt(escuta, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+    if (escuta < 0 || bind(escuta, (struct sockaddr *)&end, tamEnd) < 0 || listen(escuta, SOMAXCONN) < 0)
+    {
+        perror("servidor");
+        return 1;
+    }
+
+    mundo.escuta = escuta;
+    printf("Servidor em %s: %d laço(s) epoll, %zu bytes por sessão.\n", endereco, threads, sizeof(Sessao));
+    fflush(stdout);
+    pthread_t ids[64];
+    for (int t = 1; t < threads; ++t)
+        pthread_create(&ids[t], NULL, lacoEventos, &mundo);
+    lacoEventos(&mundo); // só volta em erro
+    return 1;
+}
+
+// --- Gerador de carga: ./mestre carga [porta|caminho] [sessões] [jogadas] ---
+// Abre as sessões de uma vez e as conduz num único laço epoll: manda uma
+// jogada, espera o prompt e mede o tempo. No fim imprime p50/p99 por jogada.
+typedef struct
+{
+    int fd;
+    int fase;      // 0 = prompt inicial, 1 = jogando, 2 = menu final, 3 = saindo
+    int restantes; // jogadas ainda a fazer
+    int casados;   // bytes de "\n> " já vistos no fim do que chegou
+    uint64_t enviadoNs;
+    uint64_t semente;
+} ClienteCarga;
+
+static int compararLatencias(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+int executarCarga(int argc, char *argv[])
+{
+    const char *endereco = argc > 0 ? argv[0] : "5555";
+    int sessoes = argc > 1 ? atoi(argv[1]) : 1000;
+    int jogadas = argc > 2 ? atoi(argv[2]) : 100;
+    if (sessoes < 1)
+        sessoes = 1;
+    if (jogadas < 1)
+        jogadas = 1;
+
+    struct sockaddr_storage end;
+    socklen_t tamEnd;
+    int familia = enderecoServidor(endereco, &end, &tamEnd);
+    ClienteCarga *c = calloc((size_t)sessoes, sizeof(*c));
+    uint64_t *lat = malloc((size_t)sessoes * (size_t)jogadas * sizeof(*lat));
+    int ep = epoll_create1(0);
+    if (familia < 0 || c == NULL || lat == NULL || ep < 0)
+    {
+        printf("Erro ao preparar o gerador de carga.\n");
+        return 1;
+    }
+    for (int i = 0; i < sessoes; ++i)
+    {
+        c[i].fd = socket(familia, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (c[i].fd < 0 || connect(c[i].fd, (struct sockaddr *)&end, tamEnd) < 0)
+        {
+            perror("carga");
+            return 1;
+        }
+        int um = 1;
+        setsockopt(c[i].fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));
+        c[i].restantes = jogadas;
+        c[i].semente = misturar64((uint64_t)i + 1);
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = &c[i]};
+        epoll_ctl(ep, EPOLL_CTL_ADD, c[i].fd, &ev);
+    }
+
+    size_t medidas = 0;
+    int ativas = sessoes, falhas = 0;
+    uint64_t inicio = relogioNs();
+    struct epoll_event eventos[MAX_EVENTOS];
+    char buf[4096];
+    while (ativas > 0)
+    {
+        int n = epoll_wait(ep, eventos, MAX_EVENTOS, 10000);
+        if (n <= 0)
+        {
+            printf("Servidor parou de responder (%d sessões pendentes).\n", ativas);
+            falhas = ativas;
+            break;
+        }
+        for (int e = 0; e < n; ++e)
+        {
+            ClienteCarga *cl = eventos[e].data.ptr;
+            ssize_t r = recv(cl->fd, buf, sizeof(buf), 0);
+            if (r <= 0)
+            {
+                if (cl->fase != 3)
+                    falhas++;
+                epoll_ctl(ep, EPOLL_CTL_DEL, cl->fd, NULL);
+                close(cl->fd);
+                ativas--;
+                continue;
+            }
+            // procura o prompt "\n> " no fim do que chegou (pode vir picado)
+            int fimResposta = 0;
+            for (ssize_t k = 0; k < r; ++k)
+            {
+                char ch = buf[k];
+                cl->casados = ch == "\n> "[cl->casados] ? cl->casados + 1 : (ch == '\n' ? 1 : 0);
+                if (cl->casados == 3)
+                {
+                    fimResposta = k == r - 1;
+                    cl->casados = 0;
+                }
+            }
+            if (!fimResposta)
+                continue;
+            uint64_t agora = relogioNs();
+            if (cl->fase == 1)
+                lat[medidas++] = agora - cl->enviadoNs;
+            const char *jogada;
+            if (cl->fase <= 1 && cl->restantes > 0)
+            {
+                cl->fase = 1;
+                cl->restantes--;
+                jogada = aleatorio64(&cl->semente) & 1 ? "e\n" : "d\n";
+            }
+            else if (cl->fase <= 1)
+            {
+                cl->fase = 2;
+                jogada = "s\n";
+            }
+            else
+            {
+                cl->fase = 3;
+                jogada = "4\n";
+            }
+            cl->enviadoNs = relogioNs();
+            if (send(cl->fd, jogada, 2, MSG_NOSIGNAL) != 2)
+                falhas++;
+        }
+    }
+    uint64_t total = relogioNs() - inicio;
+
+    qsort(lat, medidas, sizeof(*lat), compararLatencias);
+    printf("[carga] %d sessões x %d jogadas em %.2f s: %.0f jogadas/s\n", sessoes, jogadas, total / 1e9,
+           total ? medidas * 1e9 / total : 0.0);
+    if (medidas > 0)
+        printf("  latência por jogada: p50 %.1f us, p99 %.1f us, máx %.1f us\n", lat[medidas / 2] / 1e3,
+               lat[medidas * 99 / 100] / 1e3, lat[medidas - 1] / 1e3);
+    printf("  sessões com falha: %d\n", falhas);
+    close(ep);
+    free(lat);
+    free(c);
+    return falhas == 0 && medidas == (size_t)sessoes * (size_t)jogadas ? 0 : 1;
+}
+
+#else
+
+int executarServidor(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    printf("O modo servidor usa epoll e só está disponível no Linux.\n");
+    return 1;
+}
+
+int executarCarga(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    printf("O gerador de carga usa epoll e só está disponível no Linux.\n");
+    return 1;
+}
+
+#endif
+
+// ---------------------------------
+// Comparação entre níveis
+// ---------------------------------
+// ./mestre comparar [repetições] [nível=executável ...]
+// Roda os mesmos roteiros de entrada em cada motor, um processo por rodada
+// (stdin e stdout em arquivos temporários), e mede tempo e pico de memória.
+// Os três níveis têm em comum a sequência de "Você está em:"; nos roteiros que
+// não saem da mansão do novato ela precisa ser igual em todos. Motores do
+// mesmo nível também precisam concordar entre si: o mestre recebe
+// MESTRE_SEMENTE e sorteia as mesmas pistas, então lista ordenada e ranking
+// têm de bater byte a byte. O aventureiro sorteia pelo relógio; dele só se
+// confere que a lista final é o conjunto das pistas vistas, sem repetição e
+// em ordem. Sem motores na linha de comando: ./novato, ./aventureiro e este
+// executável.
+#ifdef __linux__
+
+typedef enum
+{
+    NIVEL_NOVATO,
+    NIVEL_AVENTUREIRO,
+    NIVEL_MESTRE,
+    TOTAL_NIVEIS
+} NivelMotor;
+
+static const char *nomesNiveis[TOTAL_NIVEIS] = {"novato", "aventureiro", "mestre"};
+
+typedef struct
+{
+    NivelMotor nivel;
+    const char *caminho;
+} MotorComparacao;
+
+// A mansão não tem volta: uma partida coleta no máximo uma pista por cômodo do
+// caminho. O roteiro longo desce coletando pistas (BST, motor de pontuação) e
+// repete o menu final sobre elas: ranking, listas por suspeito, busca no índice
+// radix e acusação. Novato e aventureiro terminam no "s" e não leem o corpo.
+typedef struct
+{
+    const char *nome;
+    const char *entrada; // uma jogada por linha; sem corpo termina saindo do mapa e do menu final
+    int comum;           // não sai da mansão do novato: todos os níveis visitam os mesmos cômodos
+    const char *corpo;   // repetido depois da entrada (roteiros longos), seguido de fim
+    int repeticoes;
+    const char *fim;
+} RoteiroComparacao;
+
+static const RoteiroComparacao roteirosComparacao[] = {
+    {"hall", "s\n4\n", 1, NULL, 0, NULL},
+    {"quarto", "e\ne\nd\ns\n4\n", 1, NULL, 0, NULL},
+    {"escritorio", "e\nd\nd\ns\n4\n", 1, NULL, 0, NULL},
+    {"jardim", "d\ne\ne\nd\ns\n4\n", 1, NULL, 0, NULL},
+    {"banheiro", "d\nd\ne\nd\ne\nd\ns\n4\n", 1, NULL, 0, NULL},
+    {"invalidas", "x\n\nq\nd\nz\nd\n1\ns\n4\n", 1, NULL, 0, NULL},
+    {"closet", "e\ne\ne\ns\n4\n", 0, NULL, 0, NULL},
+    {"estufa", "d\ne\ne\ne\nd\ns\n4\n", 0, NULL, 0, NULL},
+    {"longo", "d\ne\ne\ns\n", 1, "1\n2\n1\n2\n2\n5\nc\n3\n2\n", 5000, "4\n"},
+};
+
+// Jogadas que o motor lê: os outros níveis param no primeiro "s"
+static size_t contarJogadas(const RoteiroComparacao *rot, NivelMotor nivel)
+{
+    size_t jogadas = 0;
+    for (const char *c = rot->entrada; *c; ++c)
+    {
+        int inicioLinha = c == rot->entrada || c[-1] == '\n';
+        if (nivel != NIVEL_MESTRE && inicioLinha && *c == 's')
+            return jogadas + 1;
+        jogadas += *c == '\n';
+    }
+    if (rot->corpo != NULL)
+        for (const char *c = rot->corpo; *c; ++c)
+            jogadas += (size_t)rot->repeticoes * (*c == '\n');
+    if (rot->fim != NULL)
+        for (const char *c = rot->fim; *c; ++c)
+            jogadas += *c == '\n';
+    return jogadas;
+}
+
+typedef struct
+{
+    uint64_t caminho; // hash da sequência de cômodos
+    uint64_t pistas;  // hash da lista final, na ordem impressa
+    uint64_t ranking; // hash do relatório final
+    size_t comodos, totalPistas;
+    int coerente; // lista final == conjunto das pistas vistas, ordenado e sem repetição; repetições iguais
+    int status;
+    uint64_t ns;    // menor tempo entre as repetições
+    long maxRssKb;  // maior pico entre as repetições
+} ResultadoMotor;
+
+// Copia as pistas para chaves comparáveis com strcmp: no mestre a ordem (e a
+// repetição) é a das formas normalizadas, nos outros níveis é a do texto
+static char **chavesComparacao(char *pistas[], size_t n, NivelMotor nivel, char **bloco)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < n; ++i)
+        bytes += strlen(pistas[i]) + 1;
+    char **chaves = malloc(n * sizeof(*chaves) + 1);
+    char *p = *bloco = malloc(bytes + 1);
+    if (chaves == NULL || p == NULL)
+    {
+        printf("Erro ao alocar memória para a comparação.\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t tam = strlen(pistas[i]);
+        chaves[i] = p;
+        if (nivel == NIVEL_MESTRE)
+            p += normalizarPista(pistas[i], tam, p) + 1;
+        else
+        {
+            p = copiarTexto(p, pistas[i]);
+            *p++ = '\0';
+        }
+    }
+    return chaves;
+}
+
+// Trechos da saída dos motores que a comparação reconhece
+#define MARCA_COMODO "Você está em: "
+#define MARCA_PISTA_AVENTUREIRO "Pista encontrada: "
+#define MARCA_PISTA_MESTRE "Pista visível: "
+#define MARCA_LISTA "===== Pistas Encontradas"
+#define MARCA_RELATORIO "===== Relatório Final"
+
+// Extrai cômodos visitados, pistas vistas, lista final e relatório da saída de um motor
+static void analisarSaida(char *texto, size_t tam, NivelMotor nivel, ResultadoMotor *r)
+{
+    size_t linhas = 1;
+    for (size_t i = 0; i < tam; ++i)
+        linhas += texto[i] == '\n';
+    char **vistas = malloc(linhas * sizeof(*vistas));
+    char **lista = malloc(linhas * sizeof(*lista));
+    if (vistas == NULL || lista == NULL)
+    {
+        printf("Erro ao alocar memória para a comparação.\n");
+        exit(1);
+    }
+    size_t totalVistas = 0;
+    enum
+    {
+        NO_JOGO,
+        NA_LISTA,
+        NO_RELATORIO
+    } trecho = NO_JOGO;
+    r->caminho = r->pistas = r->ranking = 0;
+    r->comodos = r->totalPistas = 0;
+    // só linhas completas; todo motor termina a saída com \n
+    for (char *linha = texto, *fim; (fim = memchr(linha, '\n', (size_t)(texto + tam - linha))) != NULL;)
+    {
+        *fim = '\0';
+        char *achado;
+        if (strncmp(linha, MARCA_LISTA, sizeof(MARCA_LISTA) - 1) == 0)
+            trecho = NA_LISTA;
+        else if (strncmp(linha, MARCA_RELATORIO, sizeof(MARCA_RELATORIO) - 1) == 0)
+            trecho = NO_RELATORIO;
+        else if (trecho == NA_LISTA && strncmp(linha, " - ", 3) == 0)
+        {
+            lista[r->totalPistas++] = linha + 3;
+            r->pistas = misturar64(r->pistas ^ hashSemente(linha + 3, 1));
+        }
+        else if (trecho == NA_LISTA)
+            trecho = NO_JOGO;
+        else if (trecho == NO_RELATORIO && linha[0] != '\0')
+            r->ranking = misturar64(r->ranking ^ hashSemente(linha, 2));
+        else if ((achado = strstr(linha, MARCA_COMODO)) != NULL)
+        {
+            r->caminho = misturar64(r->caminho ^ hashSemente(achado + sizeof(MARCA_COMODO) - 1, 3));
+            r->comodos++;
+        }
+        else if ((achado = strstr(linha, MARCA_PISTA_AVENTUREIRO)) != NULL)
+            vistas[totalVistas++] = achado + sizeof(MARCA_PISTA_AVENTUREIRO) - 1;
+        else if ((achado = strstr(linha, MARCA_PISTA_MESTRE)) != NULL)
+            vistas[totalVistas++] = achado + sizeof(MARCA_PISTA_MESTRE) - 1;
+        linha = fim + 1;
+    }
+
+    // lista final: em ordem estrita (sem repetição) e igual ao conjunto das vistas
+    char *blocoLista, *blocoVistas;
+    char **chavesLista = chavesComparacao(lista, r->totalPistas, nivel, &blocoLista);
+    char **chavesVistas = chavesComparacao(vistas, totalVistas, nivel, &blocoVistas);
+    qsort(chavesVistas, totalVistas, sizeof(*chavesVistas), compararTextos);
+    size_t unicas = 0;
+    for (size_t i = 0; i < totalVistas; ++i)
+        if (unicas == 0 || strcmp(chavesVistas[unicas - 1], chavesVistas[i]) != 0)
+            chavesVistas[unicas++] = chavesVistas[i];
+    r->coerente = unicas == r->totalPistas;
+    for (size_t i = 0; r->coerente && i < r->totalPistas; ++i)
+        r->coerente = strcmp(chavesLista[i], chavesVistas[i]) == 0;
+    free(chavesLista);
+    free(chavesVistas);
+    free(blocoLista);
+    free(blocoVistas);
+    free(vistas);
+    free(lista);
+}
+
+// Uma rodada: entrada e saída são arquivos temporários já abertos
+static int rodarMotor(const MotorComparacao *m, int entrada, int saida, uint64_t *ns, long *maxRssKb)
+{
+    if (lseek(entrada, 0, SEEK_SET) < 0 || lseek(saida, 0, SEEK_SET) < 0 || ftruncate(saida, 0) != 0)
+        return -1;
+    fflush(stdout);
+    uint64_t inicio = relogioNs();
+    pid_t pid = fork();
+    if (pid < 0)
+        return -1;
+    if (pid == 0)
+    {
+        int nulo = open("/dev/null", O_WRONLY);
+        if (dup2(entrada, STDIN_FILENO) < 0 || dup2(saida, STDOUT_FILENO) < 0 || nulo < 0 || dup2(nulo, STDERR_FILENO) < 0)
+            _exit(126);
+        execl(m->caminho, m->caminho, (char *)NULL);
+        _exit(127);
+    }
+    int status;
+    struct rusage uso;
+    if (wait4(pid, &status, 0, &uso) != pid)
+        return -1;
+    *ns = relogioNs() - inicio;
+    *maxRssKb = uso.ru_maxrss;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+// A saída é mapeada (cópia privada, gravável) e não lida para o heap: o pico
+// de memória de um filho recém-criado começa no RSS do pai, que fica pequeno
+static char *mapearSaida(int fd, size_t *tam)
+{
+    off_t fim = lseek(fd, 0, SEEK_END);
+    if (fim <= 0)
+        return NULL;
+    char *texto = mmap(NULL, (size_t)fim, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (texto == MAP_FAILED)
+        return NULL;
+    *tam = (size_t)fim;
+    return texto;
+}
+
+// RSS atual deste processo em KB: piso do que se consegue medir num filho
+static long rssAtualKb(void)
+{
+    long paginas = 0, residentes = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f == NULL)
+        return 0;
+    if (fscanf(f, "%ld %ld", &paginas, &residentes) != 2)
+        residentes = 0;
+    fclose(f);
+    return residentes * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static int lerMotor(const char *spec, MotorComparacao *m)
+{
+    const char *igual = strchr(spec, '=');
+    if (igual == NULL)
+        return 0;
+    for (int n = 0; n < TOTAL_NIVEIS; ++n)
+        if ((size_t)(igual - spec) == strlen(nomesNiveis[n]) && strncmp(spec, nomesNiveis[n], (size_t)(igual - spec)) == 0)
+        {
+            m->nivel = (NivelMotor)n;
+            m->caminho = igual + 1;
+            return 1;
+        }
+    return 0;
+}
+
+int compararNiveis(int argc, char *argv[])
+{
+    int repeticoes = argc > 0 ? atoi(argv[0]) : 3;
+    if (repeticoes < 1)
+        repeticoes = 1;
+    MotorComparacao motores[32];
+    int totalMotores = 0;
+    for (int i = 1; i < argc && totalMotores < 32; ++i)
+        if (!lerMotor(argv[i], &motores[totalMotores++]))
+        {
+            printf("Motor inválido: %s (use nível=executável, nível: novato, aventureiro ou mestre)\n", argv[i]);
+            return 1;
+        }
+    if (totalMotores == 0)
+    {
+        const MotorComparacao padrao[] = {
+            {NIVEL_NOVATO, "./novato"}, {NIVEL_AVENTUREIRO, "./aventureiro"}, {NIVEL_MESTRE, "/proc/self/exe"}};
+        for (int i = 0; i < 3; ++i)
+            if (access(padrao[i].caminho, X_OK) == 0)
+                motores[totalMotores++] = padrao[i];
+            else
+                printf("[comparar] %s ausente, ignorado\n", padrao[i].caminho);
+    }
+    setenv("MESTRE_SEMENTE", "2024", 1);
+
+    int totalRoteiros = sizeof(roteirosComparacao) / sizeof(roteirosComparacao[0]);
+    ResultadoMotor *res = calloc((size_t)totalMotores, sizeof(*res));
+    FILE *entrada = tmpfile(), *saida = tmpfile();
+    if (res == NULL || entrada == NULL || saida == NULL)
+    {
+        printf("Erro ao preparar a comparação.\n");
+        return 1;
+    }
+    printf("%-11s %-28s %8s %6s %10s %12s %8s  %s\n", "roteiro", "motor", "cômodos", "pistas", "tempo (ms)",
+           "jogadas/s", "RSS (KB)", "resultado");
+    int divergencias = 0;
+    for (int r = 0; r < totalRoteiros; ++r)
+    {
+        const RoteiroComparacao *rot = &roteirosComparacao[r];
+        rewind(entrada);
+        if (ftruncate(fileno(entrada), 0) != 0)
+            return 1;
+        fputs(rot->entrada, entrada);
+        for (int k = 0; rot->corpo != NULL && k < rot->repeticoes; ++k)
+            fputs(rot->corpo, entrada);
+        if (rot->fim != NULL)
+            fputs(rot->fim, entrada);
+        fflush(entrada);
+
+        for (int i = 0; i < totalMotores; ++i)
+        {
+            ResultadoMotor *m = &res[i];
+            uint64_t melhorNs = UINT64_MAX;
+            long picoRss = 0;
+            int status = 0, coerente = 1;
+            for (int k = 0; k < repeticoes && status == 0; ++k)
+            {
+                uint64_t ns;
+                long rss;
+                status = rodarMotor(&motores[i], fileno(entrada), fileno(saida), &ns, &rss);
+                size_t tam;
+                char *texto = status == 0 ? mapearSaida(fileno(saida), &tam) : NULL;
+                if (texto == NULL)
+                {
+                    status = status != 0 ? status : -1;
+                    break;
+                }
+                ResultadoMotor atual;
+                analisarSaida(texto, tam, motores[i].nivel, &atual);
+                munmap(texto, tam);
+                coerente = coerente && atual.coerente;
+                // a primeira rodada é a referência; as outras precisam repetir o que dá para repetir
+                if (k == 0)
+                    *m = atual;
+                else if (motores[i].nivel == NIVEL_MESTRE)
+                    coerente = coerente && atual.caminho == m->caminho && atual.pistas == m->pistas &&
+                               atual.ranking == m->ranking;
+                else
+                    coerente = coerente && atual.caminho == m->caminho;
+                if (ns < melhorNs)
+                    melhorNs = ns;
+                if (rss > picoRss)
+                    picoRss = rss;
+            }
+            m->status = status;
+            m->coerente = coerente;
+            m->ns = melhorNs;
+            m->maxRssKb = picoRss;
+
+            // referências: o primeiro motor do mesmo nível e, nos roteiros comuns, o primeiro de todos
+            const char *resultado = "ok";
+            int refNivel = i;
+            for (int j = 0; j < i; ++j)
+                if (motores[j].nivel == motores[i].nivel)
+                {
+                    refNivel = j;
+                    break;
+                }
+            if (m->status != 0)
+                resultado = "FALHOU";
+            else if (!m->coerente)
+                resultado = "INCOERENTE";
+            else if (rot->comum && res[0].status == 0 && m->caminho != res[0].caminho)
+                resultado = "CÔMODOS DIVERGEM";
+            else if (res[refNivel].status == 0 && m->caminho != res[refNivel].caminho)
+                resultado = "CÔMODOS DIVERGEM";
+            else if (motores[i].nivel == NIVEL_MESTRE && res[refNivel].status == 0 &&
+                     (m->pistas != res[refNivel].pistas || m->ranking != res[refNivel].ranking))
+                resultado = "PISTAS/RANKING DIVERGEM";
+            divergencias += strcmp(resultado, "ok") != 0;
+
+            char rotulo[64];
+            snprintf(rotulo, sizeof(rotulo), "%s=%s", nomesNiveis[motores[i].nivel], motores[i].caminho);
+            if (m->status != 0)
+                printf("%-11s %-28s %8s %6s %10s %12s %8s  %s (status %d)\n", rot->nome, rotulo, "-", "-", "-", "-", "-",
+                       resultado, m->status);
+            else
+                printf("%-11s %-28s %8zu %6zu %10.2f %12.0f %8ld  %s\n", rot->nome, rotulo, m->comodos, m->totalPistas,
+                       m->ns / 1e6, contarJogadas(rot, motores[i].nivel) * 1e9 / (double)m->ns, m->maxRssKb, resultado);
+        }
+    }
+    printf("[comparar] %d motor(es), %d roteiro(s), %d divergência(s); RSS abaixo de %ld KB é o piso do comparador\n",
+           totalMotores, totalRoteiros, divergencias, rssAtualKb());
+    fclose(entrada);
+    fclose(saida);
+    free(res);
+    return divergencias == 0 ? 0 : 1;
+}
+
+#else
+
+int compararNiveis(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    printf("A comparação entre níveis usa fork e wait4 e só está disponível no Linux.\n");
+    return 1;
+}
+
+#endif
+
+// ---------------------------------
+// Benchmarks
+// ---------------------------------
+// Cada benchmark confere o resultado contra o caminho original e devolve
+// 0 quando tudo bate; qualquer divergência faz ./mestre bench sair com 1.
+
+static const char *suspeitosSinteticos[] = {
+    "Mordomo", "Jardineiro", "Cozinheira", "Bibliotecario", "Visitante Misterioso"};
+
+// Base sintética com n pistas distintas (suspeitos em rodízio); os textos
+// vêm no mesmo bloco, então free(base) libera tudo
+#define TAM_PISTA_SINTETICA 40
+static LigacaoPistaSuspeito *criarBaseSintetica(int n, uint64_t semente)
+{
+    LigacaoPistaSuspeito *base = malloc((size_t)n * (sizeof(*base) + TAM_PISTA_SINTETICA) + 1);
+    if (base == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        exit(1);
+    }
+    char *textos = (char *)(base + n);
+    for (int i = 0; i < n; ++i)
+    {
+        char *pista = textos + (size_t)i * TAM_PISTA_SINTETICA;
+        snprintf(pista, TAM_PISTA_SINTETICA, "Pista %016llx sintetica", (unsigned long long)aleatorio64(&semente));
+        base[i].pista = pista;
+        base[i].suspeito = suspeitosSinteticos[i % 5];
+    }
+    return base;
+}
+
+// Compara o percurso em ordem de duas BSTs
+static int bstIguais(NoBST *a, NoBST *b)
+{
+    NoBST **va = NULL, **vb = NULL;
+    size_t na = 0, nb = 0, ca = 0, cb = 0;
+    achatarBST(a, &va, &na, &ca);
+    achatarBST(b, &vb, &nb, &cb);
+    int iguais = na == nb;
+    for (size_t i = 0; iguais && i < na; ++i)
+        iguais = strcmp(lerTexto(&va[i]->pista), lerTexto(&vb[i]->pista)) == 0;
+    free(va);
+    free(vb);
+    return iguais;
+}
+
+// Altura da BST (iterativa, pilha de nó + profundidade)
+static int alturaBST(NoBST *raiz)
+{
+    typedef struct
+    {
+        NoBST *no;
+        int prof;
+    } Item;
+    size_t cap = 64, topo = 0;
+    Item *pilha = malloc(cap * sizeof(*pilha));
+    int altura = 0;
+    if (raiz != NULL && pilha != NULL)
+        pilha[topo++] = (Item){raiz, 1};
+    while (topo > 0 && pilha != NULL)
+    {
+        Item it = pilha[--topo];
+        if (it.prof > altura)
+            altura = it.prof;
+        if (topo + 2 > cap)
+        {
+            cap *= 2;
+            pilha = realloc(pilha, cap * sizeof(*pilha));
+            if (pilha == NULL)
+                break;
+        }
+        if (it.no->esquerda)
+            pilha[topo++] = (Item){it.no->esquerda, it.prof + 1};
+        if (it.no->direita)
+            pilha[topo++] = (Item){it.no->direita, it.prof + 1};
+    }
+    free(pilha);
+    return altura;
+}
+
+// Lote: n pistas uma a uma (como no menu) contra inserirPistasEmLote
+static int benchLote(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 20000;
+    if (n < 1)
+        n = 1;
+    int repetidas = n / 10;
+    uint64_t semente = 42;
+
+    LigacaoPistaSuspeito *base = criarBaseSintetica(n, semente);
+    const char **lote = malloc((size_t)(n + repetidas) * sizeof(*lote));
+    if (lote == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int i = 0; i < n; ++i)
+        lote[i] = base[i].pista;
+    for (int i = 0; i < repetidas; ++i)
+        lote[n + i] = base[aleatorio64(&semente) % (uint64_t)n].pista;
+    for (int i = n + repetidas - 1; i > 0; --i)
+    {
+        int k = (int)(aleatorio64(&semente) % (uint64_t)(i + 1));
+        const char *t = lote[i];
+        lote[i] = lote[k];
+        lote[k] = t;
+    }
+
+    // caminho original: uma pista por vez
+    NoBST *bstA = NULL;
+    HashPistas hashA;
+    inicializarHashPistas(&hashA);
+    uint64_t t0 = relogioNs();
+    for (int i = 0; i < n + repetidas; ++i)
+    {
+        if (buscarBST(bstA, lote[i]))
+            continue;
+        bstA = inserirBST(bstA, lote[i]);
+        const char *suspeito = "Desconhecido";
+        for (int k = 0; k < n; ++k)
+            if (strcmp(base[k].pista, lote[i]) == 0)
+            {
+                suspeito = base[k].suspeito;
+                break;
+            }
+        inserirHashPista(&hashA, lote[i], suspeito);
+    }
+    uint64_t tA = relogioNs() - t0;
+
+    // caminho em lote (em duas metades, para exercitar a intercalação com a BST já existente)
+    NoBST *bstB = NULL;
+    HashPistas hashB;
+    inicializarHashPistas(&hashB);
+    int metade = (n + repetidas) / 2;
+    t0 = relogioNs();
+    inserirPistasEmLote(&bstB, &hashB, lote, metade, base, n);
+    inserirPistasEmLote(&bstB, &hashB, lote + metade, n + repetidas - metade, base, n);
+    uint64_t tB = relogioNs() - t0;
+
+    int ok = bstIguais(bstA, bstB);
+    for (int i = 0; ok && i < 5; ++i)
+        ok = contarPistasPorSuspeito(&hashA, suspeitosSinteticos[i]) == contarPistasPorSuspeito(&hashB, suspeitosSinteticos[i]);
+
+    printf("[lote] %d pistas (%d repetidas), %d thread(s)\n", n + repetidas, repetidas, numeroThreads());
+    printf("  uma a uma : %10.2f ms  altura %d\n", tA / 1e6, alturaBST(bstA));
+    printf("  em lote   : %10.2f ms  altura %d  (%.1fx)\n", tB / 1e6, alturaBST(bstB), tB ? (double)tA / tB : 0.0);
+    printf("  resultado : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+
+    liberarBST(bstA);
+    liberarBST(bstB);
+    liberarHashPistas(&hashA);
+    liberarHashPistas(&hashB);
+    free(lote);
+    free(base);
+    return ok ? 0 : 1;
+}
+
+// Hash perfeito (CHD) contra a tabela encadeada, com n pistas
+static int benchHashPerfeito(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 50000;
+    if (n < 1)
+        n = 1;
+    LigacaoPistaSuspeito *base = criarBaseSintetica(n, 7);
+
+    // consultas: todas as pistas (acertos) + n/4 chaves ausentes, embaralhadas
+    int ausentes = n / 4;
+    char (*faltam)[32] = malloc((size_t)ausentes * sizeof(*faltam) + 1);
+    const char **consultas = malloc((size_t)(n + ausentes) * sizeof(*consultas));
+    if (faltam == NULL || consultas == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    uint64_t semente = 99;
+    for (int i = 0; i < n; ++i)
+        consultas[i] = base[i].pista;
+    for (int i = 0; i < ausentes; ++i)
+    {
+        snprintf(faltam[i], sizeof(faltam[i]), "Ausente %016llx", (unsigned long long)aleatorio64(&semente));
+        consultas[n + i] = faltam[i];
+    }
+    for (int i = n + ausentes - 1; i > 0; --i)
+    {
+        int k = (int)(aleatorio64(&semente) % (uint64_t)(i + 1));
+        const char *t = consultas[i];
+        consultas[i] = consultas[k];
+        consultas[k] = t;
+    }
+
+    uint64_t t0 = relogioNs();
+    HashPistas encadeada;
+    inicializarHashPistas(&encadeada);
+    for (int i = 0; i < n; ++i)
+        inserirHashPista(&encadeada, base[i].pista, base[i].suspeito);
+    uint64_t tConstrucaoA = relogioNs() - t0;
+
+    t0 = relogioNs();
+    HashPistasPerfeito perfeita;
+    if (construirHashPistasPerfeito(&perfeita, base, n) != 0)
+    {
+        printf("[hash-perfeito] falha na construção\n");
+        return 1;
+    }
+    uint64_t tConstrucaoB = relogioNs() - t0;
+
+    const char **respA = malloc((size_t)(n + ausentes) * sizeof(*respA));
+    const char **respB = malloc((size_t)(n + ausentes) * sizeof(*respB));
+    if (respA == NULL || respB == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    t0 = relogioNs();
+    for (int i = 0; i < n + ausentes; ++i)
+        respA[i] = buscarHashPista(&encadeada, consultas[i]);
+    uint64_t tBuscaA = relogioNs() - t0;
+    t0 = relogioNs();
+    for (int i = 0; i < n + ausentes; ++i)
+        respB[i] = buscarHashPistasPerfeito(&perfeita, consultas[i]);
+    uint64_t tBuscaB = relogioNs() - t0;
+
+    int ok = 1;
+    for (int i = 0; ok && i < n + ausentes; ++i)
+        ok = (respA[i] == NULL) == (respB[i] == NULL) && (respA[i] == NULL || strcmp(respA[i], respB[i]) == 0);
+
+    int consultasTotal = n + ausentes;
+    printf("[hash-perfeito] %d pistas, %d consultas (%d ausentes)\n", n, consultasTotal, ausentes);
+    printf("  encadeada (TAM_HASH=%d): construção %8.2f ms, busca %8.1f ns/consulta\n",
+           TAM_HASH, tConstrucaoA / 1e6, (double)tBuscaA / consultasTotal);
+    printf("  perfeita (CHD)         : construção %8.2f ms, busca %8.1f ns/consulta, %.2f bits/chave\n",
+           tConstrucaoB / 1e6, (double)tBuscaB / consultasTotal, (double)bitsHashPerfeito(&perfeita.indice) / n);
+    printf("  resultado : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+
+    free(respA);
+    free(respB);
+    liberarHashPistasPerfeito(&perfeita);
+    liberarHashPistas(&encadeada);
+    free(consultas);
+    free(faltam);
+    free(base);
+    return ok ? 0 : 1;
+}
+
+// Coleta resultados de busca para comparação
+typedef struct
+{
+    const char **itens;
+    int qtd, cap;
+} ListaPistas;
+
+static void coletarPista(const char *pista, int distancia, void *ctx)
+{
+    (void)distancia;
+    ListaPistas *l = ctx;
+    if (l->qtd == l->cap)
+    {
+        l->cap = l->cap ? l->cap * 2 : 64;
+        l->itens = realloc(l->itens, (size_t)l->cap * sizeof(*l->itens));
+        if (l->itens == NULL)
+        {
+            printf("Erro ao alocar memória para o benchmark.\n");
+            exit(1);
+        }
+    }
+    l->itens[l->qtd++] = strdup(pista);
+}
+
+static void esvaziarLista(ListaPistas *l)
+{
+    for (int i = 0; i < l->qtd; ++i)
+        free((void *)l->itens[i]);
+    l->qtd = 0;
+}
+
+// Distância de edição por byte, versão direta (referência)
+static int distanciaEdicao(const char *a, const char *b, int *linha)
+{
+    int nb = (int)strlen(b);
+    for (int j = 0; j <= nb; ++j)
+        linha[j] = j;
+    for (int i = 1; a[i - 1]; ++i)
+    {
+        int diag = linha[0];
+        linha[0] = i;
+        for (int j = 1; j <= nb; ++j)
+        {
+            int acima = linha[j];
+            int v = diag + (a[i - 1] != b[j - 1]);
+            if (acima + 1 < v)
+                v = acima + 1;
+            if (linha[j - 1] + 1 < v)
+                v = linha[j - 1] + 1;
+            linha[j] = v;
+            diag = acima;
+        }
+    }
+    return linha[nb];
+}
+
+// Índice radix: prefixo e busca aproximada contra varredura linear da lista ordenada
+static int benchIndice(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 100000;
+    int qtdConsultas = argc > 1 ? atoi(argv[1]) : 200;
+    if (n < 1)
+        n = 1;
+    LigacaoPistaSuspeito *base = criarBaseSintetica(n, 11);
+    const char **pistas = malloc((size_t)n * sizeof(*pistas));
+    if (pistas == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int i = 0; i < n; ++i)
+        pistas[i] = base[i].pista;
+
+    NoBST *bst = NULL;
+    HashPistas hash;
+    inicializarHashPistas(&hash);
+    inserirPistasEmLote(&bst, &hash, pistas, n, base, n);
+    NoBST **ordenadas = NULL;
+    size_t qtdOrdenadas = 0, cap = 0;
+    achatarBST(bst, &ordenadas, &qtdOrdenadas, &cap);
+
+    uint64_t t0 = relogioNs();
+    NoRadix *indice = construirIndicePistas(bst);
+    uint64_t tConstrucao = relogioNs() - t0;
+
+    // percurso em ordem igual ao da BST (as duas sobre as chaves normalizadas)
+    ListaPistas a = {NULL, 0, 0}, b = {NULL, 0, 0};
+    percorrerRadix(indice, coletarPista, &a);
+    int ok = (size_t)a.qtd == qtdOrdenadas;
+    for (int i = 0; ok && i < a.qtd; ++i)
+        ok = strcmp(a.itens[i], lerTexto(&ordenadas[i]->normalizada)) == 0;
+    esvaziarLista(&a);
+
+    uint64_t semente = 5, tPrefixoIdx = 0, tPrefixoLin = 0, tAproxIdx = 0, tAproxLin = 0;
+    long achadosPrefixo = 0, achadosAprox = 0;
+    int *linha = malloc(256 * sizeof(int));
+    for (int q = 0; ok && q < qtdConsultas; ++q)
+    {
+        const char *origem = pistas[aleatorio64(&semente) % (uint64_t)n];
+
+        // prefixo: "Pista " + 1 a 4 dígitos hex de uma pista existente
+        char prefixo[16];
+        int tam = 7 + (int)(aleatorio64(&semente) % 4);
+        tam = (int)normalizarPista(origem, (size_t)tam, prefixo);
+        t0 = relogioNs();
+        buscarPrefixoRadix(indice, prefixo, coletarPista, &a);
+        tPrefixoIdx += relogioNs() - t0;
+        t0 = relogioNs();
+        for (size_t i = 0; i < qtdOrdenadas; ++i)
+            if (strncmp(lerTexto(&ordenadas[i]->normalizada), prefixo, (size_t)tam) == 0)
+                coletarPista(lerTexto(&ordenadas[i]->normalizada), 0, &b);
+        tPrefixoLin += relogioNs() - t0;
+        ok = a.qtd == b.qtd;
+        for (int i = 0; ok && i < a.qtd; ++i)
+            ok = strcmp(a.itens[i], b.itens[i]) == 0;
+        achadosPrefixo += a.qtd;
+        esvaziarLista(&a);
+        esvaziarLista(&b);
+
+        // aproximada: pista existente com até 2 bytes trocados
+        char termo[100];
+        normalizarPista(origem, strlen(origem), termo);
+        for (int e = (int)(aleatorio64(&semente) % 3); e > 0; --e)
+            termo[6 + aleatorio64(&semente) % 16] = "0123456789abcdef"[aleatorio64(&semente) % 16];
+        t0 = relogioNs();
+        buscarAproximadoRadix(indice, termo, 2, coletarPista, &a);
+        tAproxIdx += relogioNs() - t0;
+        t0 = relogioNs();
+        for (size_t i = 0; i < qtdOrdenadas; ++i)
+            if (distanciaEdicao(lerTexto(&ordenadas[i]->normalizada), termo, linha) <= 2)
+                coletarPista(lerTexto(&ordenadas[i]->normalizada), 0, &b);
+        tAproxLin += relogioNs() - t0;
+        ok = ok && a.qtd == b.qtd;
+        for (int i = 0; ok && i < a.qtd; ++i)
+            ok = strcmp(a.itens[i], b.itens[i]) == 0;
+        achadosAprox += a.qtd;
+        esvaziarLista(&a);
+        esvaziarLista(&b);
+    }
+
+    printf("[indice] %d pistas, %d consultas de cada tipo, construção %.2f ms\n", n, qtdConsultas, tConstrucao / 1e6);
+    printf("  prefixo    : radix %10.1f us/consulta, linear %10.1f us/consulta (%ld achadas)\n",
+           tPrefixoIdx / 1e3 / qtdConsultas, tPrefixoLin / 1e3 / qtdConsultas, achadosPrefixo);
+    printf("  aproximada : radix %10.1f us/consulta, linear %10.1f us/consulta (%ld achadas, dist <= 2)\n",
+           tAproxIdx / 1e3 / qtdConsultas, tAproxLin / 1e3 / qtdConsultas, achadosAprox);
+    printf("  resultado  : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+
+    free(linha);
+    free(a.itens);
+    free(b.itens);
+    liberarRadix(indice);
+    free(ordenadas);
+    liberarBST(bst);
+    liberarHashPistas(&hash);
+    free(pistas);
+    free(base);
+    return ok ? 0 : 1;
+}
+
+// Soma de verificação do conteúdo de uma mansão gerada (nomes, pistas e ligações)
+static uint64_t assinaturaMansao(const MansaoProcedural *m)
+{
+    uint64_t h = 0;
+    for (size_t i = 0; i < m->total; ++i)
+    {
+        const Comodo *c = &m->comodos[i];
+        uint64_t e = c->esquerda ? (uint64_t)(c->esquerda - m->comodos) : UINT64_MAX;
+        uint64_t d = c->direita ? (uint64_t)(c->direita - m->comodos) : UINT64_MAX;
+        h = misturar64(h ^ hashSemente(lerTexto(&c->nome), 1) ^ ((uint64_t)hashSemente(lerTexto(&c->pista), 2) << 32) ^ e ^ (d << 1));
+    }
+    return h;
+}
+
+// Gerador: cômodos por segundo em cada forma, e determinismo entre 1 e N threads
+static int benchGerador(int argc, char *argv[])
+{
+    size_t n = argc > 0 ? (size_t)atoll(argv[0]) : 1000000;
+    int ok = 1;
+    for (int f = 0; f < 3; ++f)
+    {
+        FormaMansao forma = (FormaMansao)f;
+        if (argc > 1 && !(lerFormaMansao(argv[1], &forma) && forma == (FormaMansao)f))
+            continue;
+        uint64_t t0 = relogioNs();
+        MansaoProcedural *m = gerarMansao(n, forma, 2024, 64, 4096, 0);
+        uint64_t t = relogioNs() - t0;
+        MansaoProcedural *ref = gerarMansao(n, forma, 2024, 64, 4096, 1);
+        int igual = assinaturaMansao(m) == assinaturaMansao(ref);
+        ok = ok && igual;
+        printf("[gerador] %-10s %10zu cômodos em %8.2f ms: %6.1f M cômodos/s, altura %zu, %zu bytes/cômodo, %s\n",
+               nomeFormaMansao(forma), n, t / 1e6, t ? n * 1e3 / t : 0.0, alturaMansao(&m->comodos[0]),
+               sizeof(Comodo), igual ? "determinístico" : "DIVERGÊNCIA entre threads");
+        liberarMansaoProcedural(ref);
+        liberarMansaoProcedural(m);
+    }
+    return ok ? 0 : 1;
+}
+
+// Pontuação incremental contra recontagem completa, com milhares de suspeitos e pistas
+static int benchPontuacao(int argc, char *argv[])
+{
+    int totalSuspeitos = argc > 0 ? atoi(argv[0]) : 5000;
+    int totalPistas = argc > 1 ? atoi(argv[1]) : 50000;
+    if (totalSuspeitos < 1)
+        totalSuspeitos = 1;
+    if (totalPistas < 1)
+        totalPistas = 1;
+    uint64_t semente = 31;
+
+    char **suspeitos = malloc((size_t)totalSuspeitos * sizeof(*suspeitos));
+    char (*nomes)[32] = malloc((size_t)totalSuspeitos * sizeof(*nomes));
+    LigacaoPistaSuspeito *base = criarBaseSintetica(totalPistas, 13);
+    LigacaoPonderada *lig = malloc((size_t)totalPistas * 4 * sizeof(*lig));
+    // ligação -> pista e suspeito, para a recontagem não passar pela CSR
+    int *pistaLig = malloc((size_t)totalPistas * 4 * sizeof(*pistaLig));
+    int *suspeitoLig = malloc((size_t)totalPistas * 4 * sizeof(*suspeitoLig));
+    unsigned char *coletadaRef = calloc((size_t)totalPistas, 1);
+    if (!suspeitos || !nomes || !lig || !pistaLig || !suspeitoLig || !coletadaRef)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int k = 0; k < totalSuspeitos; ++k)
+    {
+        snprintf(nomes[k], sizeof(nomes[k]), "Suspeito %d", k);
+        suspeitos[k] = nomes[k];
+    }
+    // cada pista aponta para 1 a 4 suspeitos, pesos de 0.25 a 2.0
+    int totalLig = 0;
+    for (int i = 0; i < totalPistas; ++i)
+    {
+        int grau = 1 + (int)(aleatorio64(&semente) % 4);
+        for (int g = 0; g < grau; ++g)
+        {
+            int s = (int)(aleatorio64(&semente) % (uint64_t)totalSuspeitos);
+            pistaLig[totalLig] = i;
+            suspeitoLig[totalLig] = s;
+            lig[totalLig++] = (LigacaoPonderada){base[i].pista, suspeitos[s], 0.25 * (double)(1 + aleatorio64(&semente) % 8)};
+        }
+    }
+
+    uint64_t t0 = relogioNs();
+    RelacaoPistaSuspeito rel;
+    construirRelacao(&rel, lig, totalLig, suspeitos, totalSuspeitos);
+    MotorPontuacao motor;
+    iniciarMotorPontuacao(&motor, &rel);
+    uint64_t tConstrucao = relogioNs() - t0;
+
+    // coleta todas as pistas em ordem aleatória; a cada checkpoint recalcula do zero
+    int *ordemColeta = malloc((size_t)totalPistas * sizeof(*ordemColeta));
+    double *referencia = malloc((size_t)totalSuspeitos * sizeof(*referencia));
+    int *rankA = malloc((size_t)totalSuspeitos * sizeof(*rankA));
+    if (!ordemColeta || !referencia || !rankA)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int i = 0; i < totalPistas; ++i)
+        ordemColeta[i] = i;
+    for (int i = totalPistas - 1; i > 0; --i)
+    {
+        int k = (int)(aleatorio64(&semente) % (uint64_t)(i + 1));
+        int t = ordemColeta[i];
+        ordemColeta[i] = ordemColeta[k];
+        ordemColeta[k] = t;
+    }
+
+    int ok = 1, checkpoints = 0;
+    uint64_t tIncremental = 0, tRecontagem = 0, tRanking = 0;
+    int passo = totalPistas / 10 > 0 ? totalPistas / 10 : 1;
+    for (int i = 0; i < totalPistas && ok; ++i)
+    {
+        t0 = relogioNs();
+        registrarPistaMotor(&motor, base[ordemColeta[i]].pista);
+        tIncremental += relogioNs() - t0;
+        coletadaRef[ordemColeta[i]] = 1;
+
+        if ((i + 1) % passo == 0 || i + 1 == totalPistas)
+        {
+            // recontagem completa a partir das ligações de entrada (não da CSR do motor)
+            t0 = relogioNs();
+            memset(referencia, 0, (size_t)totalSuspeitos * sizeof(*referencia));
+            for (int k = 0; k < totalLig; ++k)
+                if (coletadaRef[pistaLig[k]])
+                    referencia[suspeitoLig[k]] += lig[k].peso;
+            tRecontagem += relogioNs() - t0;
+            checkpoints++;
+
+            for (int k = 0; ok && k < totalSuspeitos; ++k)
+                ok = motor.pontuacao[k] - referencia[k] < 1e-6 && referencia[k] - motor.pontuacao[k] < 1e-6;
+
+            t0 = relogioNs();
+            rankingMotor(&motor, rankA);
+            tRanking += relogioNs() - t0;
+            for (int k = 1; ok && k < totalSuspeitos; ++k)
+                ok = motor.pontuacao[rankA[k - 1]] + EPSILON_PONTUACAO >= motor.pontuacao[rankA[k]];
+        }
+    }
+
+    printf("[pontuacao] %d suspeitos, %d pistas, %d ligações, construção %.2f ms\n",
+           totalSuspeitos, totalPistas, totalLig, tConstrucao / 1e6);
+    printf("  incremental : %8.1f ns por pista coletada\n", (double)tIncremental / totalPistas);
+    printf("  recontagem  : %8.1f us por recontagem completa\n", tRecontagem / 1e3 / (checkpoints ? checkpoints : 1));
+    printf("  ranking     : %8.1f us por ordenação\n", tRanking / 1e3 / (checkpoints ? checkpoints : 1));
+    printf("  resultado   : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+
+    liberarMotorPontuacao(&motor);
+    liberarRelacao(&rel);
+    free(rankA);
+    free(referencia);
+    free(ordemColeta);
+    free(coletadaRef);
+    free(suspeitoLig);
+    free(pistaLig);
+    free(lig);
+    free(base);
+    free(nomes);
+    free(suspeitos);
+    return ok ? 0 : 1;
+}
+
+// Relação CSR contra a tabela encadeada: pistas por suspeito e suspeito de cada pista
+static int benchRelacao(int argc, char *argv[])
+{
+    int totalSuspeitos = argc > 0 ? atoi(argv[0]) : 200;
+    int totalPistas = argc > 1 ? atoi(argv[1]) : 50000;
+    if (totalSuspeitos < 1)
+        totalSuspeitos = 1;
+    if (totalPistas < 1)
+        totalPistas = 1;
+    uint64_t semente = 37;
+
+    char **suspeitos = malloc((size_t)totalSuspeitos * sizeof(*suspeitos));
+    char (*nomes)[32] = malloc((size_t)totalSuspeitos * sizeof(*nomes));
+    LigacaoPistaSuspeito *base = criarBaseSintetica(totalPistas, 17);
+    LigacaoPonderada *lig = malloc((size_t)totalPistas * sizeof(*lig) + 1);
+    int *grau = calloc((size_t)totalSuspeitos, sizeof(*grau));
+    if (!suspeitos || !nomes || !lig || !grau)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int k = 0; k < totalSuspeitos; ++k)
+    {
+        snprintf(nomes[k], sizeof(nomes[k]), "Suspeito %d", k);
+        suspeitos[k] = nomes[k];
+    }
+    // uma ligação por pista, como na tabela encadeada
+    HashPistas hash;
+    inicializarHashPistas(&hash);
+    for (int i = 0; i < totalPistas; ++i)
+    {
+        int k = (int)(aleatorio64(&semente) % (uint64_t)totalSuspeitos);
+        base[i].suspeito = suspeitos[k];
+        lig[i] = (LigacaoPonderada){base[i].pista, base[i].suspeito, 1.0};
+        inserirHashPista(&hash, base[i].pista, base[i].suspeito);
+        grau[k]++;
+    }
+
+    uint64_t t0 = relogioNs();
+    RelacaoPistaSuspeito rel;
+    construirRelacao(&rel, lig, totalPistas, suspeitos, totalSuspeitos);
+    uint64_t tConstrucao = relogioNs() - t0;
+    int ok = rel.totalLigacoes == totalPistas;
+
+    // pistas por suspeito: varredura da tabela inteira por suspeito x fatia CSR
+    long somaEncadeada = 0, somaRelacao = 0;
+    t0 = relogioNs();
+    for (int k = 0; k < totalSuspeitos; ++k)
+        somaEncadeada += contarPistasPorSuspeito(&hash, suspeitos[k]);
+    uint64_t tPorSuspeitoEnc = relogioNs() - t0;
+    t0 = relogioNs();
+    for (int k = 0; k < totalSuspeitos; ++k)
+    {
+        int qtd;
+        const int *pistas = pistasDoSuspeito(&rel, k, &qtd);
+        for (int i = 0; i < qtd; ++i)
+            somaRelacao += rel.suspeitoDe[rel.inicioPista[pistas[i]]] == k;
+    }
+    uint64_t tPorSuspeitoRel = relogioNs() - t0;
+    ok = ok && somaEncadeada == totalPistas && somaRelacao == totalPistas;
+    for (int k = 0; ok && k < totalSuspeitos; ++k)
+    {
+        int qtd;
+        pistasDoSuspeito(&rel, k, &qtd);
+        ok = qtd == grau[k];
+    }
+
+    // suspeito de cada pista: busca encadeada x id perfeito + vizinho direto
+    t0 = relogioNs();
+    for (int i = 0; ok && i < totalPistas; ++i)
+    {
+        const char *s = buscarHashPista(&hash, base[i].pista);
+        ok = s != NULL && strcmp(s, base[i].suspeito) == 0;
+    }
+    uint64_t tPorPistaEnc = relogioNs() - t0;
+    t0 = relogioNs();
+    for (int i = 0; ok && i < totalPistas; ++i)
+    {
+        int qtd, p = idPistaRelacao(&rel, base[i].pista);
+        const int *alvo = p >= 0 ? suspeitosDaPista(&rel, p, &qtd) : NULL;
+        ok = alvo != NULL && qtd == 1 && strcmp(suspeitos[alvo[0]], base[i].suspeito) == 0;
+    }
+    uint64_t tPorPistaRel = relogioNs() - t0;
+
+    size_t bytesRel = ((size_t)rel.totalPistas + totalSuspeitos + 2) * sizeof(int) +
+                      (size_t)rel.totalLigacoes * 2 * (sizeof(int) + sizeof(double)) +
+                      (size_t)rel.totalPistas * sizeof(char *) + bitsHashPerfeito(&rel.indicePistas) / 8;
+    printf("[relacao] %d suspeitos, %d pistas, construção %.2f ms, %.1f bytes/ligação fora os textos\n",
+           totalSuspeitos, totalPistas, tConstrucao / 1e6, (double)bytesRel / rel.totalLigacoes);
+    printf("  pistas por suspeito : encadeada %10.1f us/suspeito, CSR %8.3f us/suspeito\n",
+           tPorSuspeitoEnc / 1e3 / totalSuspeitos, tPorSuspeitoRel / 1e3 / totalSuspeitos);
+    printf("  suspeito da pista   : encadeada %10.1f ns/pista,    CSR %8.1f ns/pista\n",
+           (double)tPorPistaEnc / totalPistas, (double)tPorPistaRel / totalPistas);
+    printf("  resultado           : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+
+    liberarRelacao(&rel);
+    liberarHashPistas(&hash);
+    free(grau);
+    free(lig);
+    free(base);
+    free(nomes);
+    free(suspeitos);
+    return ok ? 0 : 1;
+}
+
+// Relatório final: escala com o número de threads, sai idêntico ao de uma
+// thread e conta por suspeito o mesmo que as ligações de entrada
+static int benchRelatorio(int argc, char *argv[])
+{
+    int totalLig = argc > 0 ? atoi(argv[0]) : 1000000;
+    int totalSuspeitos = argc > 1 ? atoi(argv[1]) : 1000;
+    if (totalLig < 1)
+        totalLig = 1;
+    if (totalSuspeitos < 1)
+        totalSuspeitos = 1;
+    uint64_t semente = 41;
+
+    char **suspeitos = malloc((size_t)totalSuspeitos * sizeof(*suspeitos));
+    char (*nomes)[32] = malloc((size_t)totalSuspeitos * sizeof(*nomes));
+    double *pontuacao = calloc((size_t)totalSuspeitos, sizeof(*pontuacao));
+    int *esperado = calloc((size_t)totalSuspeitos, sizeof(*esperado));
+    char (*textos)[40] = malloc((size_t)totalLig * sizeof(*textos));
+    LigacaoPonderada *lig = malloc((size_t)totalLig * sizeof(*lig));
+    int *suspeitoLig = malloc((size_t)totalLig * sizeof(*suspeitoLig));
+    int *inicioLig = malloc(((size_t)totalLig + 1) * sizeof(*inicioLig));
+    if (!suspeitos || !nomes || !pontuacao || !esperado || !textos || !lig || !suspeitoLig || !inicioLig)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int k = 0; k < totalSuspeitos; ++k)
+    {
+        snprintf(nomes[k], sizeof(nomes[k]), "Suspeito %d", k);
+        suspeitos[k] = nomes[k];
+    }
+    // cada pista pesa contra 1 a 3 suspeitos distintos
+    int totalPistas = 0, n = 0;
+    while (n < totalLig)
+    {
+        int grau = 1 + (int)(aleatorio64(&semente) % 3), primeiro = (int)(aleatorio64(&semente) % (uint64_t)totalSuspeitos);
+        snprintf(textos[totalPistas], sizeof(textos[totalPistas]), "Pista %016llx sintetica", (unsigned long long)aleatorio64(&semente));
+        inicioLig[totalPistas] = n;
+        for (int g = 0; g < grau && g < totalSuspeitos && n < totalLig; ++g)
+        {
+            suspeitoLig[n] = (primeiro + g) % totalSuspeitos;
+            lig[n] = (LigacaoPonderada){textos[totalPistas], suspeitos[suspeitoLig[n]], 0.25 * (double)(1 + n % 8)};
+            n++;
+        }
+        totalPistas++;
+    }
+    inicioLig[totalPistas] = n;
+    RelacaoPistaSuspeito rel;
+    construirRelacao(&rel, lig, totalLig, suspeitos, totalSuspeitos);
+
+    // nove de cada dez pistas coletadas, em ordem aleatória; a referência vem de lig[]
+    int *coletadas = malloc((size_t)totalPistas * sizeof(*coletadas));
+    int *ordem = malloc((size_t)totalPistas * sizeof(*ordem));
+    if (!coletadas || !ordem)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int i = 0; i < totalPistas; ++i)
+        ordem[i] = i;
+    for (int i = totalPistas - 1; i > 0; --i)
+    {
+        int k = (int)(aleatorio64(&semente) % (uint64_t)(i + 1)), t = ordem[i];
+        ordem[i] = ordem[k];
+        ordem[k] = t;
+    }
+    int qtdColetadas = totalPistas - totalPistas / 10, ligColetadas = 0, ok = 1;
+    for (int i = 0; ok && i < qtdColetadas; ++i)
+    {
+        coletadas[i] = idPistaRelacao(&rel, textos[ordem[i]]);
+        ok = coletadas[i] >= 0;
+        for (int k = inicioLig[ordem[i]]; k < inicioLig[ordem[i] + 1]; ++k)
+        {
+            esperado[suspeitoLig[k]]++;
+            pontuacao[suspeitoLig[k]] += lig[k].peso;
+            ligColetadas++;
+        }
+    }
+    if (!ok)
+        qtdColetadas = 0; // pista repetida no sorteio: o relatório não pode receber id -1
+
+    RelatorioFinal ref;
+    uint64_t t0 = relogioNs();
+    montarRelatorio(&ref, &rel, coletadas, qtdColetadas, pontuacao, suspeitos, 1);
+    uint64_t tUma = relogioNs() - t0;
+    ok = ok && ref.totalLigacoes == ligColetadas;
+    for (int k = 0; ok && k < totalSuspeitos; ++k)
+        ok = ref.contagem[k] == esperado[k];
+    for (int j = 1; ok && j < totalSuspeitos; ++j)
+        ok = pontuacao[ref.ranking[j - 1]] >= pontuacao[ref.ranking[j]];
+
+    printf("[relatorio] %d ligações, %d pistas (%d coletadas), %d suspeitos, %zu bytes de relatório\n", totalLig, totalPistas,
+           qtdColetadas, totalSuspeitos, ref.texto.tam);
+    printf("  %2d thread(s): %9.2f ms\n", 1, tUma / 1e6);
+    int maxThreads = argc > 2 ? atoi(argv[2]) : numeroThreads();
+    for (int threads = 2; ok && threads <= maxThreads && threads <= 64; threads *= 2)
+    {
+        RelatorioFinal r;
+        t0 = relogioNs();
+        montarRelatorio(&r, &rel, coletadas, qtdColetadas, pontuacao, suspeitos, threads);
+        uint64_t t = relogioNs() - t0;
+        ok = r.texto.tam == ref.texto.tam && memcmp(r.texto.dados, ref.texto.dados, r.texto.tam) == 0;
+        printf("  %2d thread(s): %9.2f ms (%.2fx)\n", threads, t / 1e6, t ? (double)tUma / t : 0.0);
+        liberarRelatorio(&r);
+    }
+    printf("  resultado   : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+
+    liberarRelatorio(&ref);
+    liberarRelacao(&rel);
+    free(ordem);
+    free(coletadas);
+    free(inicioLig);
+    free(suspeitoLig);
+    free(lig);
+    free(textos);
+    free(esperado);
+    free(pontuacao);
+    free(nomes);
+    free(suspeitos);
+    return ok ? 0 : 1;
+}
+
+// Registro compartilhado: contenção de 1 a 64 threads, CAS x trava global.
+// Todas as threads registram todas as pistas (cada uma começando num ponto
+// diferente), então quase toda inserção disputa a mesma chave com outra thread.
+typedef struct
+{
+    RegistroCompartilhado *r;
+    pthread_mutex_t *trava; // != NULL: versão com trava global
+    LigacaoPistaSuspeito *base;
+    int n, inicio;
+    long novas;
+} CargaRegistro;
+
+static void *carregarRegistro(void *arg)
+{
+    CargaRegistro *c = arg;
+    for (int j = 0; j < c->n; ++j)
+    {
+        int i = (c->inicio + j) % c->n;
+        int suspeito = i % 5; // mesmo rodízio de criarBaseSintetica
+        int novo;
+        if (c->trava)
+        {
+            pthread_mutex_lock(c->trava);
+            novo = registrarPistaCompartilhada(c->r, c->base[i].pista, suspeito);
+            pthread_mutex_unlock(c->trava);
+        }
+        else
+            novo = registrarPistaCompartilhada(c->r, c->base[i].pista, suspeito);
+        if (novo == 1)
+            c->novas++;
+    }
+    consolidarEstatisticas();
+    return NULL;
+}
+
+static int benchRegistro(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 100000;
+    int maxThreads = argc > 1 ? atoi(argv[1]) : 64;
+    if (n < 1)
+        n = 1;
+    if (maxThreads < 1 || maxThreads > 64)
+        maxThreads = 64;
+    LigacaoPistaSuspeito *base = criarBaseSintetica(n, 19);
+    pthread_mutex_t trava = PTHREAD_MUTEX_INITIALIZER;
+    int ok = 1;
+
+    printf("[registro] %d pistas distintas, cada thread registra todas\n", n);
+    for (int threads = 1; ok && threads <= maxThreads; threads *= 2)
+    {
+        double mops[2];
+        for (int comTrava = 0; comTrava < 2; ++comTrava)
+        {
+            RegistroCompartilhado r;
+            criarRegistroCompartilhado(&r, (size_t)n, 5);
+            pthread_t ids[64];
+            CargaRegistro cargas[64];
+            uint64_t t0 = relogioNs();
+            for (int t = 0; t < threads; ++t)
+            {
+                cargas[t] = (CargaRegistro){&r, comTrava ? &trava : NULL, base, n, (int)((long)n * t / threads), 0};
+                pthread_create(&ids[t], NULL, carregarRegistro, &cargas[t]);
+            }
+            long novas = 0;
+            for (int t = 0; t < threads; ++t)
+            {
+                pthread_join(ids[t], NULL);
+                novas += cargas[t].novas;
+            }
+            uint64_t t = relogioNs() - t0;
+            mops[comTrava] = t ? (double)n * threads * 1e3 / t : 0.0;
+
+            // cada pista registrada uma única vez, contadores exatos
+            ok = ok && novas == n && r.total == (uint64_t)n;
+            for (int k = 0; ok && k < 5; ++k)
+                ok = contagemCompartilhada(&r, k) == (uint64_t)(n / 5 + (k < n % 5));
+            for (int i = 0; ok && i < n; i += 97)
+                ok = contemPistaCompartilhada(&r, base[i].pista);
+            liberarRegistroCompartilhado(&r);
+        }
+        printf("  %2d thread(s): CAS %7.2f Mops/s, trava global %7.2f Mops/s\n", threads, mops[0], mops[1]);
+    }
+    printf("  resultado   : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+    free(base);
+    return ok ? 0 : 1;
+}
+
+// Motor de jogo: passos por segundo com entradas sorteadas; a cada partida
+// encerrada confere as pontuações contra uma recontagem pelas pistas coletadas
+static int benchPasso(int argc, char *argv[])
+{
+    long passos = argc > 0 ? atol(argv[0]) : 10000000;
+    if (passos < 1)
+        passos = 1;
+    srand(7);
+    CenarioPadrao cenario;
+    montarCenarioPadrao(&cenario, NULL);
+    const MundoJogo mundo = cenario.mundo;
+    const RelacaoPistaSuspeito rel = *mundo.rel;
+    EstadoJogo e;
+    iniciarJogo(&mundo, &e);
+
+    static const char *numeros[] = {"1", "2", "3", "4", "5", "9"};
+    EventoJogo ev[MAX_EVENTOS_PASSO];
+    uint64_t semente = 3, eventos = 0;
+    long partidas = 0;
+    int ok = 1;
+    uint64_t t0 = relogioNs();
+    for (long i = 0; i < passos && ok; ++i)
+    {
+        uint64_t r = aleatorio64(&semente);
+        const char *entrada;
+        if (e.fase == FASE_MAPA)
+            entrada = (r & 15) == 0 ? "s" : (r & 16 ? "e" : "d");
+        else if (e.fase == FASE_FINAL)
+            entrada = (r & 7) == 0 ? "4" : numeros[(r >> 3) % 3]; // ranking, listar ou acusar
+        else
+            entrada = numeros[(r >> 3) % 6];
+        eventos += (uint64_t)passoJogo(&mundo, &e, entrada, ev);
+
+        if (e.fase == FASE_FIM)
+        {
+            double ref[TOTAL_SUSPEITOS_PADRAO] = {0};
+            int coletadas = 0;
+            for (int p = 0; p < rel.totalPistas; ++p)
+                if (pistaColetadaMotor(&e.motor, p))
+                {
+                    coletadas++;
+                    for (int k = rel.inicioPista[p]; k < rel.inicioPista[p + 1]; ++k)
+                        ref[rel.suspeitoDe[k]] += rel.pesoPista[k];
+                }
+            ok = coletadas == e.motor.totalColetadas;
+            for (int k = 0; ok && k < TOTAL_SUSPEITOS_PADRAO; ++k)
+                ok = e.motor.pontuacao[k] - ref[k] < 1e-9 && ref[k] - e.motor.pontuacao[k] < 1e-9;
+            partidas++;
+            reiniciarJogo(&mundo, &e);
+        }
+    }
+    uint64_t t = relogioNs() - t0;
+    size_t bytesEstado = sizeof(EstadoJogo) + ((size_t)rel.totalSuspeitos + 1) * sizeof(*e.motor.pontuacao) +
+                         ((size_t)rel.totalPistas / 64 + 1) * sizeof(*e.motor.coletada);
+
+    printf("[passo] %ld passos, %ld partidas, %llu eventos em %.2f ms: %.1f M passos/s, %zu bytes de estado\n",
+           passos, partidas, (unsigned long long)eventos, t / 1e6, t ? passos * 1e3 / t : 0.0, bytesEstado);
+    printf("  resultado : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+
+    liberarJogo(&e);
+    liberarCenarioPadrao(&cenario);
+    return ok ? 0 : 1;
+}
+
+// Coleção persistente: toda a árvore de exploração (um estado por cômodo,
+// cada um bifurcado do pai) contra clonar BST e contadores a cada bifurcação
+typedef struct
+{
+    const Comodo *c;
+    ColecaoPersistente col;
+    NoBST *bst;         // só na versão com cópia
+    uint32_t *contagem;
+    int total;
+} ItemExploracao;
+
+static NoBST *clonarBST(const NoBST *n, size_t *nos)
+{
+    if (n == NULL)
+        return NULL;
+    NoBST *c = criarNoBST(lerTexto(&n->pista));
+    (*nos)++;
+    c->esquerda = clonarBST(n->esquerda, nos);
+    c->direita = clonarBST(n->direita, nos);
+    return c;
+}
+
+static int benchPersistente(int argc, char *argv[])
+{
+    size_t n = argc > 0 ? (size_t)atoll(argv[0]) : 4000;
+    FormaMansao forma = FORMA_ENVIESADA;
+    if (argc > 1 && !lerFormaMansao(argv[1], &forma))
+    {
+        printf("Forma desconhecida: %s\n", argv[1]);
+        return 1;
+    }
+    const int totalSuspeitos = 64;
+    MansaoProcedural *m = gerarMansao(n, forma, 77, totalSuspeitos, 512, 0);
+    HashPistasPerfeito pistas;
+    IndiceSuspeitos nomes;
+    construirHashPistasPerfeito(&pistas, m->base, m->totalBase);
+    construirIndiceSuspeitos(&nomes, m->suspeitos, m->totalSuspeitos);
+    int *suspeitoComodo = malloc(n * sizeof(*suspeitoComodo));
+    uint64_t *assinatura = malloc(n * sizeof(*assinatura));
+    ItemExploracao *pilha = malloc(n * sizeof(*pilha));
+    if (!suspeitoComodo || !assinatura || !pilha)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        const char *sus = m->comodos[i].pista.tam ? buscarHashPistasPerfeito(&pistas, lerTexto(&m->comodos[i].pista)) : NULL;
+        suspeitoComodo[i] = sus ? idSuspeito(&nomes, sus) : -1;
+    }
+    int conferir = n <= 20000; // a versão com cópia é quadrática; só roda em mansões pequenas
+
+    // persistente: cada cômodo bifurca o estado do pai em O(1)
+    Arena arena = {NULL, 0};
+    size_t topo = 0, maxPistas = 0;
+    uint64_t t0 = relogioNs();
+    pilha[topo++] = (ItemExploracao){&m->comodos[0], colecaoVazia(totalSuspeitos), NULL, NULL, 0};
+    while (topo > 0)
+    {
+        ItemExploracao it = pilha[--topo];
+        size_t i = (size_t)(it.c - m->comodos);
+        if (it.c->pista.tam)
+            registrarPistaPersistente(&arena, &it.col, lerTexto(&it.c->pista), suspeitoComodo[i]);
+        if ((size_t)it.col.totalPistas > maxPistas)
+            maxPistas = (size_t)it.col.totalPistas;
+        if (conferir)
+        {
+            uint64_t h = (uint64_t)it.col.totalPistas;
+            for (int k = 0; k < totalSuspeitos; ++k)
+                h = misturar64(h ^ ((uint64_t)k << 32 | contagemPersistente(&it.col, k)));
+            assinatura[i] = h;
+        }
+        if (it.c->direita)
+            pilha[topo++] = (ItemExploracao){it.c->direita, it.col, NULL, NULL, 0};
+        if (it.c->esquerda)
+            pilha[topo++] = (ItemExploracao){it.c->esquerda, it.col, NULL, NULL, 0};
+    }
+    uint64_t tPersistente = relogioNs() - t0;
+    printf("[persistente] %s, %zu cômodos, até %zu pistas por caminho\n", nomeFormaMansao(forma), n, maxPistas);
+    printf("  persistente : %9.2f ms, %10zu bytes, %zu estados todos acessíveis (%.1f bytes/bifurcação)\n",
+           tPersistente / 1e6, arena.bytes, n, (double)arena.bytes / n);
+
+    int ok = 1;
+    if (conferir)
+    {
+        // cópia: cada bifurcação clona a BST e os contadores do pai
+        size_t vivos = 0, pico = 0, copiados = 0;
+        topo = 0;
+        t0 = relogioNs();
+        pilha[topo++] = (ItemExploracao){&m->comodos[0], colecaoVazia(0), NULL,
+                                         calloc((size_t)totalSuspeitos, sizeof(uint32_t)), 0};
+        while (topo > 0 && ok)
+        {
+            ItemExploracao it = pilha[--topo];
+            size_t i = (size_t)(it.c - m->comodos);
+            if (it.c->pista.tam && !buscarBST(it.bst, lerTexto(&it.c->pista)))
+            {
+                it.bst = inserirBST(it.bst, lerTexto(&it.c->pista));
+                it.total++;
+                vivos++;
+                if (suspeitoComodo[i] >= 0)
+                    it.contagem[suspeitoComodo[i]]++;
+            }
+            uint64_t h = (uint64_t)it.total;
+            for (int k = 0; k < totalSuspeitos; ++k)
+                h = misturar64(h ^ ((uint64_t)k << 32 | it.contagem[k]));
+            ok = h == assinatura[i];
+
+            const Comodo *filhos[2] = {it.c->direita, it.c->esquerda};
+            for (int f = 0; f < 2; ++f)
+            {
+                if (filhos[f] == NULL)
+                    continue;
+                size_t nos = 0;
+                uint32_t *cont = malloc((size_t)totalSuspeitos * sizeof(*cont));
+                memcpy(cont, it.contagem, (size_t)totalSuspeitos * sizeof(*cont));
+                pilha[topo++] = (ItemExploracao){filhos[f], colecaoVazia(0), clonarBST(it.bst, &nos), cont, it.total};
+                vivos += nos;
+                copiados += nos;
+            }
+            size_t bytes = vivos * sizeof(NoBST) + (topo + 1) * (size_t)totalSuspeitos * sizeof(uint32_t);
+            if (bytes > pico)
+                pico = bytes;
+            vivos -= (size_t)it.total;
+            liberarBST(it.bst);
+            free(it.contagem);
+        }
+        while (topo > 0)
+        {
+            liberarBST(pilha[--topo].bst);
+            free(pilha[topo].contagem);
+        }
+        uint64_t tCopia = relogioNs() - t0;
+        printf("  cópia       : %9.2f ms, pico de %10zu bytes vivos, %zu nós clonados\n", tCopia / 1e6, pico, copiados);
+    }
+    else
+        printf("  cópia       : omitida (mais de 20000 cômodos)\n");
+    printf("  resultado   : %s\n", !conferir ? "não conferido" : ok ? "OK" : "DIVERGÊNCIA");
+
+    liberarArena(&arena);
+    free(pilha);
+    free(assinatura);
+    free(suspeitoComodo);
+    liberarIndiceSuspeitos(&nomes);
+    liberarHashPistasPerfeito(&pistas);
+    liberarMansaoProcedural(m);
+    return ok ? 0 : 1;
+}
+
+// Rota ótima: confere contra força bruta em mansões pequenas (cenário padrão,
+// com pesos e evidências secundárias) e mede mansões geradas grandes
+static int conferirRotaOtima(const Comodo *hall, const RelacaoPistaSuspeito *rel, const RotaOtima *r)
+{
+    const Comodo **pilha = malloc(((size_t)r->movimentos + 1) * sizeof(*pilha));
+    unsigned char *coletada = calloc((size_t)rel->totalPistas + 1, 1);
+    double *pontuacao = calloc((size_t)rel->totalSuspeitos, sizeof(*pontuacao));
+    if (!pilha || !coletada || !pontuacao)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        exit(1);
+    }
+    int topo = 0, ok = (int)strlen(r->rota) == r->movimentos;
+    pilha[topo++] = hall;
+    for (int i = 0; ok && i < r->movimentos; ++i)
+    {
+        const Comodo *atual = pilha[topo - 1];
+        if (r->rota[i] == 'v')
+        {
+            ok = topo > 1;
+            topo--;
+            continue;
+        }
+        const Comodo *dest = r->rota[i] == 'e' ? atual->esquerda : atual->direita;
+        ok = dest != NULL;
+        if (!ok)
+            break;
+        pilha[topo++] = dest;
+        int p = dest->pista.tam ? idPistaRelacao(rel, lerTexto(&dest->pista)) : -1;
+        if (p >= 0 && !coletada[p])
+        {
+            coletada[p] = 1;
+            for (int k = rel->inicioPista[p]; k < rel->inicioPista[p + 1]; ++k)
+                pontuacao[rel->suspeitoDe[k]] += rel->pesoPista[k];
+        }
+    }
+    double p = ok ? pontuacao[r->suspeito] : 0;
+    ok = ok && p + EPSILON_PONTUACAO >= LIMIAR_ACUSACAO && p - r->pontuacao < 1e-6 && r->pontuacao - p < 1e-6;
+    for (int k = 0; ok && k < rel->totalSuspeitos; ++k)
+        ok = pontuacao[k] <= p + EPSILON_PONTUACAO;
+    free(pilha);
+    free(coletada);
+    free(pontuacao);
+    return ok;
+}
+
+static int numerarForcaBruta(const Comodo *c, int pai, int prof, const Comodo *no[], int paiNo[], int profNo[], int n)
+{
+    no[n] = c;
+    paiNo[n] = pai;
+    profNo[n] = prof;
+    int eu = n++;
+    if (c->esquerda)
+        n = numerarForcaBruta(c->esquerda, eu, prof + 1, no, paiNo, profNo, n);
+    if (c->direita)
+        n = numerarForcaBruta(c->direita, eu, prof + 1, no, paiNo, profNo, n);
+    return n;
+}
+
+// Menor custo entre todas as subárvores com o Hall (até 20 cômodos), ou -1
+static int forcaBrutaRota(const Comodo *hall, const RelacaoPistaSuspeito *rel)
+{
+    const Comodo *no[20];
+    int pai[20], prof[20], pista[20];
+    int n = numerarForcaBruta(hall, -1, 0, no, pai, prof, 0);
+    for (int i = 0; i < n; ++i)
+        pista[i] = i > 0 && no[i]->pista.tam ? idPistaRelacao(rel, lerTexto(&no[i]->pista)) : -1;
+    double *pontuacao = malloc((size_t)rel->totalSuspeitos * sizeof(*pontuacao));
+    unsigned char *coletada = malloc((size_t)rel->totalPistas + 1);
+    int melhor = -1;
+    for (uint32_t mascara = 0; mascara < 1u << (n - 1); ++mascara)
+    {
+        int conexo = 1, arestas = 0, profMax = 0;
+        for (int i = 1; conexo && i < n; ++i)
+            if (mascara >> (i - 1) & 1)
+            {
+                conexo = pai[i] == 0 || (mascara >> (pai[i] - 1) & 1);
+                arestas++;
+                if (prof[i] > profMax)
+                    profMax = prof[i];
+            }
+        int custo = 2 * arestas - profMax;
+        if (!conexo || (melhor >= 0 && custo >= melhor))
+            continue;
+        memset(pontuacao, 0, (size_t)rel->totalSuspeitos * sizeof(*pontuacao));
+        memset(coletada, 0, (size_t)rel->totalPistas + 1);
+        for (int i = 1; i < n; ++i)
+            if ((mascara >> (i - 1) & 1) && pista[i] >= 0 && !coletada[pista[i]])
+            {
+                coletada[pista[i]] = 1;
+                for (int k = rel->inicioPista[pista[i]]; k < rel->inicioPista[pista[i] + 1]; ++k)
+                    pontuacao[rel->suspeitoDe[k]] += rel->pesoPista[k];
+            }
+        for (int s = 0; s < rel->totalSuspeitos; ++s)
+        {
+            int valida = pontuacao[s] + EPSILON_PONTUACAO >= LIMIAR_ACUSACAO;
+            for (int k = 0; valida && k < rel->totalSuspeitos; ++k)
+                valida = pontuacao[k] <= pontuacao[s] + EPSILON_PONTUACAO;
+            if (valida)
+            {
+                melhor = custo;
+                break;
+            }
+        }
+    }
+    free(pontuacao);
+    free(coletada);
+    return melhor;
+}
+
+static int benchRota(int argc, char *argv[])
+{
+    size_t n = argc > 0 ? (size_t)atoll(argv[0]) : 1000000;
+    int threads = argc > 1 ? atoi(argv[1]) : numeroThreads();
+    if (threads < 1)
+        threads = 1;
+
+    // 1) exatidão: cenário padrão em mansões de até 17 cômodos
+    LigacaoPonderada *lig = montarLigacoesPonderadas(basePadrao, TOTAL_BASE_PADRAO, evidenciasExtrasPadrao, TOTAL_EXTRAS_PADRAO);
+    RelacaoPistaSuspeito rel;
+    construirRelacao(&rel, lig, TOTAL_BASE_PADRAO + TOTAL_EXTRAS_PADRAO, suspeitosPadrao, TOTAL_SUSPEITOS_PADRAO);
+    int casos = 400, iguais = 0, semAcusacao = 0, ok = 1;
+    uint64_t estado = 2024;
+    for (int caso = 0; caso < casos; ++caso)
+    {
+        MansaoProcedural *m = gerarMansao((size_t)(5 + caso % 13), (FormaMansao)(caso % 3), 500 + (uint64_t)caso, 1, 0, 1);
+        for (size_t i = 0; i < m->total; ++i)
+        {
+            uint64_t h = aleatorio64(&estado);
+            if (h % 100 < 85)
+                m->comodos[i].pista = referenciarTexto(basePadrao[(h >> 8) % TOTAL_BASE_PADRAO].pista);
+        }
+        RotaOtima r;
+        resolverRotaOtima(&m->comodos[0], &rel, 1 + caso % 3, &r);
+        int forca = forcaBrutaRota(&m->comodos[0], &rel);
+        int certo = r.suspeito < 0 ? forca < 0 : r.movimentos == forca && conferirRotaOtima(&m->comodos[0], &rel, &r);
+        if (!certo && ok)
+            printf("  caso %d: rota %d (%s), força bruta %d\n", caso, r.suspeito < 0 ? -1 : r.movimentos,
+                   r.rota ? r.rota : "-", forca);
+        ok = ok && certo;
+        iguais += certo;
+        semAcusacao += forca < 0;
+        liberarRotaOtima(&r);
+        liberarMansaoProcedural(m);
+    }
+    printf("[rota] força bruta: %d/%d mansões pequenas iguais (%d sem acusação possível)\n", iguais, casos, semAcusacao);
+    liberarRelacao(&rel);
+    free(lig);
+
+    // 2) escala: mansões geradas, 1 thread x todas
+    int limites[2] = {1, threads};
+    for (int f = 0; f < 3; ++f)
+    {
+        MansaoProcedural *m = gerarMansao(n, (FormaMansao)f, 99, 64, 512, 0);
+        LigacaoPonderada *ligM = montarLigacoesPonderadas(m->base, m->totalBase, NULL, 0);
+        construirRelacao(&rel, ligM, m->totalBase, m->suspeitos, m->totalSuspeitos);
+        printf("[rota] %s, %zu cômodos (altura %zu)\n", nomeFormaMansao(m->forma), n, alturaMansao(&m->comodos[0]));
+        int custo[2] = {-1, -1};
+        for (int t = 0; t < 2; ++t)
+        {
+            if (t == 1 && threads == 1)
+                break;
+            RotaOtima r;
+            uint64_t t0 = relogioNs();
+            resolverRotaOtima(&m->comodos[0], &rel, limites[t], &r);
+            uint64_t dt = relogioNs() - t0;
+            custo[t] = r.suspeito < 0 ? -1 : r.movimentos;
+            int conferida = r.suspeito < 0 || conferirRotaOtima(&m->comodos[0], &rel, &r);
+            ok = ok && conferida && custo[t] == custo[0];
+            printf("  %2d thread(s): %9.2f ms, %d movimentos, suspeito %s (%.1f), %llu estados%s\n", limites[t],
+                   dt / 1e6, custo[t], r.suspeito < 0 ? "-" : m->suspeitos[r.suspeito], r.pontuacao,
+                   (unsigned long long)r.estados, conferida ? "" : " ROTA INVÁLIDA");
+            liberarRotaOtima(&r);
+        }
+        liberarRelacao(&rel);
+        free(ligM);
+        liberarMansaoProcedural(m);
+    }
+    printf("  resultado : %s\n", ok ? "OK" : "DIVERGÊNCIA");
+    return ok ? 0 : 1;
+}
+
+// Pista aleatória com maiúsculas, acentos, NBSP e brancos repetidos
+static size_t pistaBaguncada(uint64_t *estado, char *s, size_t max)
+{
+    static const char *const pedacos[] = {"Pista", "pista", "ESTÁ", "chão", "Ç", "ã", "É", "ü", "ß", "×", "Æ",
+                                          " ", "  ", "\t", "\xC2\xA0", "luz", "Lama", "0x1F", "-", "z", "Z"};
+    size_t n = 0, alvo = aleatorio64(estado) % max;
+    while (n < alvo)
+    {
+        const char *p = pedacos[aleatorio64(estado) % (sizeof(pedacos) / sizeof(pedacos[0]))];
+        size_t t = strlen(p);
+        if (n + t >= max)
+            break;
+        memcpy(s + n, p, t);
+        n += t;
+    }
+    s[n] = '\0';
+    return n;
+}
+
+// Normalização SIMD x escalar, e chave de 64 bits x strcmp na busca binária
+static int benchNormalizacao(int argc, char *argv[])
+{
+    int n = argc > 0 ? atoi(argv[0]) : 200000;
+    if (n < 2)
+        n = 2;
+    int ok = 1;
+
+    // 1) casos fixos
+    static const char *const casos[][2] = {
+        {"  Pista  ", "pista"}, {"Pista", "pista"}, {"A luz está apagada.", "a luz esta apagada."},
+        {"Sinais de lama\tna  ESTUFA", "sinais de lama na estufa"}, {"CHÃO\xC2\xA0sujo", "chao sujo"},
+        {"Æ × ß", "\xC3\xA6 \xC3\x97 \xC3\x9F"}, {" \t\r\n", ""}, {"", ""}};
+    for (size_t c = 0; c < sizeof(casos) / sizeof(casos[0]); ++c)
+    {
+        char saida[64];
+        normalizarPista(casos[c][0], strlen(casos[c][0]), saida);
+        if (strcmp(saida, casos[c][1]) != 0)
+        {
+            printf("  \"%s\" -> \"%s\", esperado \"%s\"\n", casos[c][0], saida, casos[c][1]);
+            ok = 0;
+        }
+    }
+
+    // 2) pistas aleatórias: SIMD igual ao escalar, chave na ordem de strcmp
+    uint64_t estado = 42;
+    size_t tamTexto = 256;
+    char *entradas = malloc((size_t)n * tamTexto);
+    char *normalizadas = malloc((size_t)n * tamTexto);
+    size_t *tam = malloc((size_t)n * sizeof(*tam));
+    if (entradas == NULL || normalizadas == NULL || tam == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    size_t bytes = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        // três em quatro parecidas com as da base; o resto bagunçado
+        char *s = entradas + (size_t)i * tamTexto;
+        if (i % 4)
+            snprintf(s, tamTexto, "%s %s Pista %016llx %s", basePadrao[aleatorio64(&estado) % TOTAL_BASE_PADRAO].pista,
+                     basePadrao[aleatorio64(&estado) % TOTAL_BASE_PADRAO].pista, (unsigned long long)aleatorio64(&estado),
+                     evidenciasExtrasPadrao[i % TOTAL_EXTRAS_PADRAO].pista);
+        else
+            pistaBaguncada(&estado, s, tamTexto);
+        tam[i] = strlen(s);
+        bytes += tam[i];
+    }
+    int divergencias = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        char referencia[256];
+        char *s = entradas + (size_t)i * tamTexto, *d = normalizadas + (size_t)i * tamTexto;
+        size_t a = normalizarPista(s, tam[i], d);
+        size_t b = normalizarPistaEscalar(s, tam[i], referencia);
+        if (a != b || strcmp(d, referencia) != 0)
+            divergencias++;
+    }
+    for (int i = 0; i + 1 < n; ++i)
+    {
+        const char *x = normalizadas + (size_t)i * tamTexto, *y = normalizadas + (size_t)(i + 1) * tamTexto;
+        ChavePista kx = montarChave(x, strlen(x)), ky = montarChave(y, strlen(y));
+        int c1 = compararChaves(&kx, &ky), c2 = strcmp(x, y);
+        if ((c1 > 0) != (c2 > 0) || (c1 < 0) != (c2 < 0))
+            divergencias++;
+    }
+    ok = ok && divergencias == 0;
+
+    // 3) vazão: escalar x SIMD sobre o mesmo corpus
+    double tempo[2];
+    for (int v = 0; v < 2; ++v)
+    {
+        uint64_t t0 = relogioNs();
+        for (int i = 0; i < n; ++i)
+        {
+            const char *s = entradas + (size_t)i * tamTexto;
+            char *d = normalizadas + (size_t)i * tamTexto;
+            if (v == 0)
+                normalizarPistaEscalar(s, tam[i], d);
+            else
+                normalizarPista(s, tam[i], d);
+        }
+        tempo[v] = (double)(relogioNs() - t0);
+    }
+
+    // 4) descida na BST: prefixo guardado no nó x strcmp no texto do nó
+    NoBST *raiz = NULL;
+    for (int i = 0; i < n; ++i)
+        raiz = inserirBST(raiz, entradas + (size_t)i * tamTexto);
+    ChavePista *consultas = malloc((size_t)n * sizeof(*consultas));
+    if (consultas == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        return 1;
+    }
+    for (int q = 0; q < n; ++q)
+    {
+        const char *alvo = normalizadas + (size_t)q * 7919 % (size_t)n * tamTexto;
+        consultas[q] = montarChave(alvo, strlen(alvo));
+    }
+    long achadas[2] = {0, 0}, esperadas = 0;
+    for (int q = 0; q < n; ++q)
+        esperadas += consultas[q].tam > 0; // pista só de brancos não entra na árvore
+    uint64_t tDescida[2];
+    for (int v = 0; v < 2; ++v)
+    {
+        uint64_t t0 = relogioNs();
+        for (int q = 0; q < n; ++q)
+        {
+            const NoBST *no = raiz;
+            while (no != NULL)
+            {
+                int cmp = v == 0 ? strcmp(consultas[q].texto, lerTexto(&no->normalizada)) : compararChaveNo(&consultas[q], no);
+                if (cmp == 0)
+                {
+                    achadas[v]++;
+                    break;
+                }
+                no = cmp < 0 ? no->esquerda : no->direita;
+            }
+        }
+        tDescida[v] = relogioNs() - t0;
+    }
+    ok = ok && achadas[0] == esperadas && achadas[1] == esperadas;
+
+#if defined(__AVX2__)
+    const char *kernel = "AVX2";
+#elif defined(__SSE2__)
+    const char *kernel = "SSE2";
+#else
+    const char *kernel = "escalar";
+#endif
+    printf("[normalizacao] %d pistas, %.1f MB, kernel %s\n", n, bytes / 1e6, kernel);
+    printf("  escalar   : %8.2f ms (%7.1f MB/s)\n", tempo[0] / 1e6, tempo[0] > 0 ? bytes * 1e3 / tempo[0] : 0.0);
+    printf("  vetorial  : %8.2f ms (%7.1f MB/s, %.1fx)\n", tempo[1] / 1e6, tempo[1] > 0 ? bytes * 1e3 / tempo[1] : 0.0,
+           tempo[1] > 0 ? tempo[0] / tempo[1] : 0.0);
+    printf("  BST       : strcmp %6.1f ns, prefixo de 64 bits %6.1f ns por busca (altura %d)\n", (double)tDescida[0] / n,
+           (double)tDescida[1] / n, alturaBST(raiz));
+    printf("  resultado : %s (%d divergências)\n", ok ? "OK" : "DIVERGÊNCIA", divergencias);
+
+    free(consultas);
+    liberarBST(raiz);
+    free(tam);
+    free(normalizadas);
+    free(entradas);
+    return ok ? 0 : 1;
+}
+
+// Bytes por cômodo e por pista no layout compacto, contra os vetores fixos antigos
+static int benchMemoria(int argc, char *argv[])
+{
+    size_t n = argc > 0 ? (size_t)atoll(argv[0]) : 1000000;
+    // layout antigo: char nome[50], pista[100] e dois ponteiros; char pista[100] + filhos; pista[100] + suspeito[50] + próximo
+    const size_t antigoComodo = 168, antigoBST = 120, antigoHash = 160;
+    int ok = 1;
+    for (int f = 0; f < 3; ++f)
+    {
+        MansaoProcedural *m = gerarMansao(n, (FormaMansao)f, 2024, 64, 4096, 0);
+        double porComodo = (double)(sizeof(Comodo) * m->total + m->textos.bytes) / (double)m->total;
+        printf("[memoria] %-10s %10zu cômodos: %6.1f bytes/cômodo (nomes fora da linha: %zu bytes), antes %zu\n",
+               nomeFormaMansao(m->forma), m->total, porComodo, m->textos.bytes, antigoComodo);
+        ok = ok && porComodo < antigoComodo;
+
+        NoBST *raiz = NULL;
+        HashPistas hash;
+        inicializarHashPistas(&hash);
+        ContagemMemoria bst0, hash0, bst1, hash1;
+        consultarMemoria(MEM_PISTAS, &bst0);
+        consultarMemoria(MEM_HASH, &hash0);
+        for (int i = 0; i < m->totalBase; ++i)
+        {
+            if (!buscarBST(raiz, m->base[i].pista))
+                raiz = inserirBST(raiz, m->base[i].pista);
+            inserirHashPista(&hash, m->base[i].pista, m->base[i].suspeito);
+        }
+        consultarMemoria(MEM_PISTAS, &bst1);
+        consultarMemoria(MEM_HASH, &hash1);
+        double porNoBST = (double)(bst1.bytes - bst0.bytes) / (double)(bst1.objetos - bst0.objetos);
+        double porNoHash = (double)(hash1.bytes - hash0.bytes) / (double)(hash1.objetos - hash0.objetos);
+        printf("          %10d pistas : %6.1f bytes/nó BST (antes %zu), %6.1f bytes/nó hash (antes %zu)\n", m->totalBase,
+               porNoBST, antigoBST, porNoHash, antigoHash);
+        ok = ok && porNoBST < antigoBST && porNoHash < antigoHash;
+        liberarBST(raiz);
+        liberarHashPistas(&hash);
+        liberarMansaoProcedural(m);
+    }
+
+    // pistas além dos 99 caracteres antigos não são mais truncadas, pelo
+    // caminho do jogo: base[] -> cômodo (distribuirPistas) -> BST e hash (lote)
+    char longa[300];
+    for (int i = 0; i < (int)sizeof(longa) - 1; ++i)
+        longa[i] = (char)('a' + i % 26);
+    longa[sizeof(longa) - 1] = '\0';
+    LigacaoPistaSuspeito baseLonga[] = {{longa, "Suspeito de nome bem comprido"}};
+    Comodo *c = criarComodo(longa, "");
+    while (c->pista.tam == 0) // 10% dos cômodos ficam sem pista
+        distribuirPistas(&c, 1, baseLonga, 1);
+    const char *coletada[] = {lerTexto(&c->pista)};
+    NoBST *raiz = NULL;
+    HashPistas hash;
+    inicializarHashPistas(&hash);
+    inserirPistasEmLote(&raiz, &hash, coletada, 1, baseLonga, 1);
+    const char *suspeito = buscarHashPista(&hash, longa);
+    int inteira = raiz != NULL && strcmp(lerTexto(&raiz->pista), longa) == 0 && buscarBST(raiz, longa) && suspeito != NULL &&
+                  strcmp(suspeito, baseLonga[0].suspeito) == 0;
+    inteira = inteira && lerTexto(&c->nome)[sizeof(longa) - 2] == longa[sizeof(longa) - 2] && c->nome.tam == sizeof(longa) - 1;
+    printf("[memoria] pista de %zu caracteres: %s\n", sizeof(longa) - 1, inteira ? "preservada" : "TRUNCADA");
+    ok = ok && inteira;
+    liberarArvore(c);
+    liberarBST(raiz);
+    liberarHashPistas(&hash);
+    fflush(stdout);
+    imprimirMemoria(STDOUT_FILENO);
+    return ok ? 0 : 1;
+}
+
+// Anda do Hall até o cômodo de índice de heap dado, preparando cada passo; NULL se não existe
+static const Comodo *caminharSobDemanda(MansaoSobDemanda *m, uint64_t indice)
+{
+    // bits de indice+1 abaixo do mais alto: 0 = esquerda, 1 = direita
+    uint64_t k = indice + 1;
+    const Comodo *c = &m->hall->comodo;
+    for (int b = 62 - __builtin_clzll(k); b >= 0 && c != NULL; --b)
+    {
+        prepararComodo(m, c);
+        c = (k >> b) & 1 ? c->direita : c->esquerda;
+    }
+    return c;
+}
+
+// Soma de verificação de todos os cômodos até a profundidade; não depende da ordem nem da capacidade
+static uint64_t assinaturaSobDemanda(MansaoSobDemanda *m, uint32_t profundidade, size_t *total)
+{
+    uint64_t h = 0;
+    *total = 0;
+    for (uint64_t i = 0; i < (2ull << profundidade) - 1; ++i)
+    {
+        const Comodo *c = caminharSobDemanda(m, i);
+        if (c == NULL)
+            continue;
+        h ^= misturar64(i ^ hashSemente(lerTexto(&c->nome), 1) ^ ((uint64_t)hashSemente(lerTexto(&c->pista), 2) << 32));
+        ++*total;
+    }
+    return h;
+}
+
+// Mansão sob demanda: passeios longos com poucos cômodos vivos, e o mesmo
+// caminho dando o mesmo cômodo com qualquer capacidade
+static int benchSobDemanda(int argc, char *argv[])
+{
+    long passos = argc > 0 ? atol(argv[0]) : 1000000;
+    size_t capacidade = argc > 1 ? (size_t)atoll(argv[1]) : 1024;
+    int ok = 1;
+
+    // determinismo: enumeração completa até a profundidade 12, sem despejo x despejando a cada passo
+    uint32_t rasa = 12;
+    size_t totalGrande, totalMinima;
+    MansaoSobDemanda *grande = criarMansaoSobDemanda(99, (size_t)1 << 20, rasa, basePadrao, TOTAL_BASE_PADRAO);
+    uint64_t a = assinaturaSobDemanda(grande, rasa, &totalGrande);
+    MansaoSobDemanda *minima = criarMansaoSobDemanda(99, 3, rasa, basePadrao, TOTAL_BASE_PADRAO);
+    uint64_t b = assinaturaSobDemanda(minima, rasa, &totalMinima);
+    int igual = a == b && totalGrande == totalMinima;
+    printf("[sobdemanda] profundidade %u, %zu cômodos: capacidade %zu x 3 (%llu despejos) -> %s\n", rasa, totalGrande,
+           grande->capacidade, (unsigned long long)minima->despejados, igual ? "iguais" : "DIVERGÊNCIA");
+    ok = ok && igual && grande->despejados == 0;
+    liberarMansaoSobDemanda(grande);
+    liberarMansaoSobDemanda(minima);
+
+    // passeios aleatórios até a profundidade 60; volta ao Hall ao chegar num beco
+    ContagemMemoria antes, depois;
+    consultarMemoria(MEM_COMODOS, &antes);
+    MansaoSobDemanda *m = criarMansaoSobDemanda(2024, capacidade, 60, basePadrao, TOTAL_BASE_PADRAO);
+    uint64_t x = 0x5EED;
+    uint32_t profundidadeAlcancada = 0;
+    const Comodo *c = &m->hall->comodo;
+    uint64_t t0 = relogioNs();
+    for (long p = 0; p < passos; ++p)
+    {
+        prepararComodo(m, c);
+        x = misturar64(x + p);
+        const Comodo *prox = x & 1 ? c->direita : c->esquerda;
+        if (prox == NULL)
+            prox = x & 1 ? c->esquerda : c->direita;
+        if (prox == NULL)
+            prox = &m->hall->comodo;
+        c = prox;
+        uint32_t prof = ((const ComodoSobDemanda *)c)->profundidade;
+        if (prof > profundidadeAlcancada)
+            profundidadeAlcancada = prof;
+    }
+    uint64_t t1 = relogioNs();
+    consultarMemoria(MEM_COMODOS, &depois);
+    printf("[sobdemanda] %ld passos, capacidade %zu: %llu criados, %llu despejados, pico %zu vivos, profundidade %u\n", passos,
+           m->capacidade, (unsigned long long)m->criados, (unsigned long long)m->despejados, m->picoVivos, profundidadeAlcancada);
+    size_t bytesVivos = depois.bytes - antes.bytes;
+    printf("              %.1f ns/passo, %.1f ns/cômodo criado, %zu bytes vivos\n", (double)(t1 - t0) / (double)passos,
+           (double)(t1 - t0) / (double)(m->criados ? m->criados : 1), bytesVivos);
+    ok = ok && m->picoVivos <= m->capacidade;
+
+    // mansão inteira em memória com tantos cômodos quanto os criados no passeio
+    size_t n = m->criados < 4000000 ? (size_t)m->criados : 4000000;
+    consultarMemoria(MEM_COMODOS, &antes);
+    MansaoProcedural *inteira = gerarMansao(n, FORMA_BALANCEADA, 2024, 64, 4096, 0);
+    consultarMemoria(MEM_COMODOS, &depois);
+    size_t bytesInteira = depois.bytes - antes.bytes + inteira->textos.bytes;
+    printf("              mansão inteira com %zu cômodos: %zu bytes (%.0fx)\n", n, bytesInteira,
+           (double)bytesInteira / (double)(bytesVivos ? bytesVivos : 1));
+    liberarMansaoProcedural(inteira);
+    liberarMansaoSobDemanda(m);
+    return ok ? 0 : 1;
+}
+
+// Passeios do Hall até uma folha escolhendo o lado ao acaso, como um jogador
+// no menu; a soma depende só da forma da árvore e dos cômodos lidos
+static uint64_t passearAteFolhas(const Comodo *hall, long passeios, uint64_t semente, uint64_t *passos)
+{
+    uint64_t soma = 0, x = semente;
+    *passos = 0;
+    for (long p = 0; p < passeios; ++p)
+    {
+        const Comodo *c = hall;
+        for (;;)
+        {
+            soma += (unsigned char)c->nome.prefixo[0];
+            int lado = (int)(aleatorio64(&x) & 1);
+            const Comodo *prox = lado ? c->direita : c->esquerda;
+            if (prox == NULL)
+                prox = lado ? c->esquerda : c->direita;
+            if (prox == NULL)
+                break;
+            c = prox;
+            ++*passos;
+        }
+    }
+    return soma;
+}
+
+// Mesma forma, mesmos nomes e mesmas pistas (percurso em paralelo das duas árvores)
+static int mesmaMansao(const Comodo *a, const Comodo *b, size_t total)
+{
+    const Comodo **pilha = malloc(2 * (total + 1) * sizeof(*pilha));
+    if (pilha == NULL)
+        return 0;
+    size_t topo = 0;
+    int igual = 1;
+    pilha[topo++] = a;
+    pilha[topo++] = b;
+    while (igual && topo > 0)
+    {
+        const Comodo *y = pilha[--topo], *x = pilha[--topo];
+        if (x == NULL || y == NULL)
+        {
+            igual = x == y;
+            continue;
+        }
+        igual = strcmp(lerTexto(&x->nome), lerTexto(&y->nome)) == 0 && strcmp(lerTexto(&x->pista), lerTexto(&y->pista)) == 0;
+        pilha[topo++] = x->esquerda;
+        pilha[topo++] = y->esquerda;
+        pilha[topo++] = x->direita;
+        pilha[topo++] = y->direita;
+    }
+    free(pilha);
+    return igual;
+}
+
+// Cópia da mansão gerada em nós de malloc criados numa ordem aleatória e
+// depois ligados, como num heap que já foi usado (liberar com liberarArvore)
+static Comodo *copiarParaMalloc(const MansaoProcedural *m, uint64_t semente)
+{
+    size_t n = m->total;
+    Comodo **nos = malloc(n * sizeof(*nos));
+    size_t *ordem = malloc(n * sizeof(*ordem));
+    if (nos == NULL || ordem == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        exit(1);
+    }
+    uint64_t x = semente;
+    for (size_t i = 0; i < n; ++i)
+        ordem[i] = i;
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        size_t j = (size_t)(aleatorio64(&x) % (i + 1)), tmp = ordem[i];
+        ordem[i] = ordem[j];
+        ordem[j] = tmp;
+    }
+    for (size_t k = 0; k < n; ++k)
+        nos[ordem[k]] = criarComodo(lerTexto(&m->comodos[ordem[k]].nome), lerTexto(&m->comodos[ordem[k]].pista));
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Comodo *g = &m->comodos[i];
+        nos[i]->esquerda = g->esquerda ? nos[g->esquerda - m->comodos] : NULL;
+        nos[i]->direita = g->direita ? nos[g->direita - m->comodos] : NULL;
+    }
+    Comodo *raiz = nos[0];
+    free(ordem);
+    free(nos);
+    return raiz;
+}
+
+// Mansão congelada: passeios até as folhas na árvore de malloc (nós criados
+// fora de ordem, como num heap que já foi usado) x cópia em BFS x cópia vEB
+static int benchCongelada(int argc, char *argv[])
+{
+    size_t tamanhos[] = {1000000, 4000000};
+    int totalTamanhos = 2;
+    if (argc > 0)
+    {
+        tamanhos[0] = (size_t)atoll(argv[0]);
+        totalTamanhos = 1;
+    }
+    long passeios = argc > 1 ? atol(argv[1]) : 1000000;
+    FormaMansao forma = FORMA_BALANCEADA;
+    if (argc > 2 && (!lerFormaMansao(argv[2], &forma) || forma == FORMA_ENVIESADA))
+    {
+        printf("Forma inválida para passeios até as folhas: %s (balanceada ou corredores)\n", argv[2]);
+        return 1;
+    }
+    int ok = 1;
+    for (int t = 0; t < totalTamanhos; ++t)
+    {
+        size_t n = tamanhos[t];
+        MansaoProcedural *m = gerarMansao(n, forma, 2024, 64, 4096, 0);
+        Comodo *raiz = copiarParaMalloc(m, 42);
+
+        uint64_t passos, t0 = relogioNs();
+        uint64_t somaPonteiros = passearAteFolhas(raiz, passeios, 7, &passos);
+        uint64_t tPonteiros = relogioNs() - t0;
+        printf("[congelada] %-10s %10zu cômodos (altura %zu), %ld passeios, %.1f passos por passeio\n", nomeFormaMansao(forma), n,
+               alturaMansao(raiz), passeios, (double)passos / (double)passeios);
+        printf("            %-22s %8.1f ns/passo\n", "ponteiros (malloc)", (double)tPonteiros / (double)passos);
+
+        const OrdemCongelada ordens[] = {ORDEM_BFS, ORDEM_VEB};
+        const char *nomesOrdens[] = {"BFS contíguo", "van Emde Boas"};
+        for (int o = 0; o < 2; ++o)
+        {
+            t0 = relogioNs();
+            MansaoCongelada *c = congelarMansao(raiz, ordens[o]);
+            uint64_t tCongelar = relogioNs() - t0;
+            uint64_t passosCongelada;
+            t0 = relogioNs();
+            uint64_t soma = passearAteFolhas(c->comodos, passeios, 7, &passosCongelada);
+            uint64_t tPasseio = relogioNs() - t0;
+            int igual = soma == somaPonteiros && passosCongelada == passos && c->total == n && mesmaMansao(raiz, c->comodos, n);
+            printf("            %-22s %8.1f ns/passo (%.2fx), congelar %.1f ns/cômodo -> %s\n", nomesOrdens[o],
+                   (double)tPasseio / (double)passos, (double)tPonteiros / (double)tPasseio, (double)tCongelar / (double)n,
+                   igual ? "mesma mansão" : "DIVERGÊNCIA");
+            ok = ok && igual;
+            liberarMansaoCongelada(c);
+        }
+        liberarArvore(raiz);
+        liberarMansaoProcedural(m);
+    }
+#ifdef TABELAS_GERADAS
+    // A mansão estática do jogo já vem de gerar-tabelas em ordem vEB; congelar de novo não move nenhum cômodo
+    MansaoCongelada *c = congelarMansao(&mansaoGerada[0], ORDEM_VEB);
+    int jaVeb = c->total == TOTAL_COMODOS_GERADOS;
+    for (size_t i = 0; jaVeb && i < c->total; ++i)
+    {
+        const Comodo *x = &c->comodos[i], *y = &mansaoGerada[i];
+        jaVeb = strcmp(lerTexto(&x->nome), lerTexto(&y->nome)) == 0 &&
+                (x->esquerda ? x->esquerda - c->comodos : -1) == (y->esquerda ? y->esquerda - mansaoGerada : -1) &&
+                (x->direita ? x->direita - c->comodos : -1) == (y->direita ? y->direita - mansaoGerada : -1);
+    }
+    printf("[congelada] mansão gerada (%d cômodos) %s\n", TOTAL_COMODOS_GERADOS,
+           jaVeb ? "já em ordem vEB" : "FORA da ordem vEB: rode ./mestre gerar-tabelas > mestre_tabelas.h");
+    ok = ok && jaVeb;
+    liberarMansaoCongelada(c);
+#endif
+    return ok ? 0 : 1;
+}
+
+// Os mesmos passeios de passearAteFolhas, navegando pela topologia sucinta
+static uint64_t passearSucinta(const MansaoSucinta *m, long passeios, uint64_t semente, uint64_t *passos)
+{
+    uint64_t soma = 0, x = semente;
+    *passos = 0;
+    for (long p = 0; p < passeios; ++p)
+    {
+        size_t c = 0;
+        for (;;)
+        {
+            soma += (unsigned char)nomeSucinto(m, c)[0];
+            int lado = (int)(aleatorio64(&x) & 1);
+            size_t prox = filhoSucinto(m, c, lado);
+            if (prox == SIZE_MAX)
+                prox = filhoSucinto(m, c, !lado);
+            if (prox == SIZE_MAX)
+                break;
+            c = prox;
+            ++*passos;
+        }
+    }
+    return soma;
+}
+
+// Mansão sucinta: bytes da topologia, passeios e subidas ao pai contra a
+// cópia congelada em vEB, e a mesma mansão gravada e mapeada de volta
+static int benchSucinta(int argc, char *argv[])
+{
+    size_t n = argc > 0 ? (size_t)atoll(argv[0]) : 4000000;
+    long passeios = argc > 1 ? atol(argv[1]) : 1000000;
+    FormaMansao forma = FORMA_BALANCEADA;
+    if (argc > 2 && (!lerFormaMansao(argv[2], &forma) || forma == FORMA_ENVIESADA))
+    {
+        printf("Forma inválida para passeios até as folhas: %s (balanceada ou corredores)\n", argv[2]);
+        return 1;
+    }
+    MansaoProcedural *gerada = gerarMansao(n, forma, 2024, 64, 4096, 0);
+    uint64_t t0 = relogioNs();
+    MansaoSucinta *s = sucintarMansao(gerada->comodos);
+    uint64_t tSucintar = relogioNs() - t0;
+
+    // mesma forma e mesmos textos que a cópia em BFS (mesma numeração)
+    MansaoCongelada *bfs = congelarMansao(gerada->comodos, ORDEM_BFS);
+    int igual = s->total == bfs->total;
+    for (size_t i = 0; igual && i < bfs->total; ++i)
+    {
+        const Comodo *c = &bfs->comodos[i];
+        size_t e = filhoSucinto(s, i, 0), d = filhoSucinto(s, i, 1);
+        igual = e == (c->esquerda ? (size_t)(c->esquerda - bfs->comodos) : SIZE_MAX) &&
+                d == (c->direita ? (size_t)(c->direita - bfs->comodos) : SIZE_MAX) &&
+                (e == SIZE_MAX || paiSucinto(s, e) == i) && (d == SIZE_MAX || paiSucinto(s, d) == i) &&
+                strcmp(nomeSucinto(s, i), lerTexto(&c->nome)) == 0 && strcmp(pistaSucinta(s, i), lerTexto(&c->pista)) == 0;
+    }
+    igual = igual && paiSucinto(s, 0) == SIZE_MAX;
+    liberarMansaoCongelada(bfs);
+
+    size_t bytesTopologia = (size_t)((const char *)s->baseNome - (const char *)s->bits);
+    printf("[sucinta] %-10s %zu cômodos, %zu pistas distintas, sucintar %.1f ns/cômodo -> %s\n", nomeFormaMansao(forma), n,
+           s->totalPistas, (double)tSucintar / (double)n, igual ? "mesma mansão" : "DIVERGÊNCIA");
+    printf("          topologia: %.2f bits/cômodo (ponteiros: %zu), %zu bytes\n", 8.0 * (double)bytesTopologia / (double)n,
+           8 * 2 * sizeof(Comodo *), bytesTopologia);
+    printf("          mansão inteira: %.1f bytes/cômodo (Comodo + nomes longos: %.1f)\n", (double)s->bloco->tamBloco / (double)n,
+           (double)(n * sizeof(Comodo) + gerada->textos.bytes) / (double)n);
+
+    // passeios até as folhas: ponteiros na melhor ordem x bits (na memória e mapeados)
+    MansaoCongelada *veb = congelarMansao(gerada->comodos, ORDEM_VEB);
+    uint64_t passosVeb, passosSucinta, passosMapeada;
+    t0 = relogioNs();
+    uint64_t somaVeb = passearAteFolhas(veb->comodos, passeios, 7, &passosVeb);
+    uint64_t tVeb = relogioNs() - t0;
+    t0 = relogioNs();
+    uint64_t somaSucinta = passearSucinta(s, passeios, 7, &passosSucinta);
+    uint64_t tSucinta = relogioNs() - t0;
+    liberarMansaoCongelada(veb);
+
+    FILE *arquivo = tmpfile();
+    MansaoSucinta *mapeada = NULL;
+    if (arquivo != NULL && gravarMansaoSucinta(s, fileno(arquivo)) == 0)
+        mapeada = mapearMansaoSucinta(fileno(arquivo));
+    uint64_t somaMapeada = 0, tMapeada = 0;
+    if (mapeada != NULL)
+    {
+        t0 = relogioNs();
+        somaMapeada = passearSucinta(mapeada, passeios, 7, &passosMapeada);
+        tMapeada = relogioNs() - t0;
+    }
+    int passeiosIguais = somaSucinta == somaVeb && passosSucinta == passosVeb && mapeada != NULL && somaMapeada == somaVeb &&
+                         passosMapeada == passosVeb;
+    double porPasso = 1.0 / (double)(passosVeb ? passosVeb : 1);
+    printf("          passeios: vEB %.1f ns/passo, sucinta %.1f ns/passo, mapeada %.1f ns/passo -> %s\n",
+           (double)tVeb * porPasso, (double)tSucinta * porPasso, (double)tMapeada * porPasso,
+           passeiosIguais ? "mesmos caminhos" : "DIVERGÊNCIA");
+
+    // subidas ao pai a partir de cômodos aleatórios
+    uint64_t x = 99, somaPais = 0;
+    size_t subidas = 1000000;
+    t0 = relogioNs();
+    for (size_t k = 0; k < subidas; ++k)
+        somaPais += paiSucinto(s, 1 + aleatorio64(&x) % (n > 1 ? n - 1 : 1));
+    uint64_t tPais = relogioNs() - t0;
+    printf("          pai: %.1f ns por consulta (soma %llu)\n", (double)tPais / (double)subidas, (unsigned long long)somaPais);
+
+    liberarMansaoSucinta(mapeada);
+    if (arquivo != NULL)
+        fclose(arquivo);
+
+    // arquivos estragados (um campo por vez, ou cortado no fim) são recusados
+    const char *b = (const char *)s->bloco;
+    struct
+    {
+        size_t off;
+        uint32_t valor;
+    } estragos[] = {
+        {offsetof(CabecalhoSucinta, total), UINT32_MAX},
+        {offsetof(CabecalhoSucinta, bytesNomes), UINT32_MAX},
+        {(size_t)((const char *)&s->bits[0] - b), n > 1 ? 0 : 1},
+        {(size_t)((const char *)&s->rank[0] - b), 1},
+        {(size_t)((const char *)&s->amostras[0] - b), UINT32_MAX},
+        {(size_t)((const char *)&s->offNome[n - 1] - b), UINT32_MAX},
+        {(size_t)((const char *)&s->pistaDe[n - 1] - b), (uint32_t)s->totalPistas},
+        {(size_t)((const char *)&s->offPista[s->totalPistas - 1] - b), UINT32_MAX},
+        {s->bloco->tamBloco, 0}, // corte: o arquivo perde o último byte
+    };
+    int totalEstragos = (int)(sizeof(estragos) / sizeof(estragos[0])), recusados = 0;
+    for (int k = 0; k < totalEstragos; ++k)
+    {
+        FILE *f = tmpfile();
+        if (f == NULL || gravarMansaoSucinta(s, fileno(f)) != 0)
+        {
+            if (f != NULL)
+                fclose(f);
+            continue;
+        }
+        int estragado = estragos[k].off == s->bloco->tamBloco
+                            ? ftruncate(fileno(f), (off_t)s->bloco->tamBloco - 1) == 0
+                            : pwrite(fileno(f), &estragos[k].valor, sizeof(estragos[k].valor), (off_t)estragos[k].off) ==
+                                  (ssize_t)sizeof(estragos[k].valor);
+        MansaoSucinta *ruim = estragado ? mapearMansaoSucinta(fileno(f)) : NULL;
+        recusados += estragado && ruim == NULL;
+        liberarMansaoSucinta(ruim);
+        fclose(f);
+    }
+    printf("          arquivos estragados: %d de %d recusados\n", recusados, totalEstragos);
+
+    liberarMansaoSucinta(s);
+    liberarMansaoProcedural(gerada);
+    return igual && passeiosIguais && recusados == totalEstragos ? 0 : 1;
+}
+
+// Consultas intercaladas: buscas na BST e caminhos pela mansão, uma consulta
+// por vez x várias em voo com prefetch, em árvores maiores que a cache
+static int benchIntercalado(int argc, char *argv[])
+{
+    size_t n = argc > 0 ? (size_t)atoll(argv[0]) : 4000000;
+    size_t consultas = argc > 1 ? (size_t)atoll(argv[1]) : 1000000;
+    if (n < 1)
+        n = 1;
+    if (consultas < 1)
+        consultas = 1;
+    const int grupos[] = {1, 4, 8, 16, 32};
+    const int totalGrupos = (int)(sizeof(grupos) / sizeof(grupos[0]));
+    long llc = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+    int ok = 1;
+
+    // 1) BST com n pistas inseridas em ordem aleatória; metade das consultas existe
+    const size_t tamPista = 24;
+    char *textos = malloc(n * tamPista);
+    char *buscadas = malloc(consultas * tamPista);
+    const char **lote = malloc(consultas * sizeof(*lote));
+    int *esperado = malloc(consultas * sizeof(*esperado));
+    int *achou = malloc(consultas * sizeof(*achou));
+    if (textos == NULL || buscadas == NULL || lote == NULL || esperado == NULL || achou == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        exit(1);
+    }
+    uint64_t x = 47;
+    ContagemMemoria antes, depois;
+    consultarMemoria(MEM_PISTAS, &antes);
+    NoBST *bst = NULL;
+    uint64_t t0 = relogioNs();
+    for (size_t i = 0; i < n; ++i)
+    {
+        snprintf(textos + i * tamPista, tamPista, "%016llx Pista", (unsigned long long)aleatorio64(&x));
+        bst = inserirBST(bst, textos + i * tamPista);
+    }
+    uint64_t tMontar = relogioNs() - t0;
+    consultarMemoria(MEM_PISTAS, &depois);
+    for (size_t i = 0; i < consultas; ++i)
+    {
+        if (i & 1)
+            lote[i] = textos + (aleatorio64(&x) % n) * tamPista;
+        else
+        {
+            snprintf(buscadas + i * tamPista, tamPista, "%016llx pista", (unsigned long long)aleatorio64(&x));
+            lote[i] = buscadas + i * tamPista;
+        }
+    }
+    printf("[intercalado] BST: %zu pistas (altura %d), %.0f MB de nós, LLC %.0f MB, montar %.1f ns/pista\n", n, alturaBST(bst),
+           (double)(depois.bytes - antes.bytes) / 1048576.0, (double)llc / 1048576.0, (double)tMontar / (double)n);
+
+    t0 = relogioNs();
+    for (size_t i = 0; i < consultas; ++i)
+        esperado[i] = buscarBST(bst, lote[i]);
+    uint64_t tSequencial = relogioNs() - t0;
+    size_t encontradas = 0;
+    for (size_t i = 0; i < consultas; ++i)
+        encontradas += (size_t)esperado[i];
+    printf("              %zu consultas, %zu encontradas\n", consultas, encontradas);
+    printf("              %-14s %8.1f ns/consulta\n", "buscarBST", (double)tSequencial / (double)consultas);
+    for (int g = 0; g < totalGrupos; ++g)
+    {
+        memset(achou, 0xff, consultas * sizeof(*achou));
+        t0 = relogioNs();
+        buscarBSTIntercalado(bst, lote, consultas, achou, grupos[g]);
+        uint64_t t = relogioNs() - t0;
+        int igual = memcmp(achou, esperado, consultas * sizeof(*achou)) == 0;
+        printf("              %2d em voo      %8.1f ns/consulta (%.2fx) -> %s\n", grupos[g], (double)t / (double)consultas,
+               (double)tSequencial / (double)t, igual ? "mesmas respostas" : "DIVERGÊNCIA");
+        ok = ok && igual;
+    }
+    liberarBST(bst);
+    free(achou);
+    free(esperado);
+    free(lote);
+    free(buscadas);
+    free(textos);
+
+    // 2) mansão balanceada de n cômodos em nós de malloc; índices até n + n/8 (alguns não existem)
+    MansaoProcedural *m = gerarMansao(n, FORMA_BALANCEADA, 2024, 64, 4096, 0);
+    uint64_t *indices = malloc(consultas * sizeof(*indices));
+    const Comodo **esperados = malloc(consultas * sizeof(*esperados));
+    const Comodo **saida = malloc(consultas * sizeof(*saida));
+    if (indices == NULL || esperados == NULL || saida == NULL)
+    {
+        printf("Erro ao alocar memória para o benchmark.\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < consultas; ++i)
+        indices[i] = aleatorio64(&x) % (n + n / 8 + 1);
+    // na forma balanceada o índice de heap é a posição no vetor do gerador
+    int caminhoCerto = 1;
+    for (size_t i = 0; caminhoCerto && i < consultas && i < 100000; ++i)
+        caminhoCerto = comodoDoCaminho(m->comodos, indices[i]) == (indices[i] < n ? &m->comodos[indices[i]] : NULL);
+    consultarMemoria(MEM_COMODOS, &antes);
+    Comodo *hall = copiarParaMalloc(m, 42);
+    consultarMemoria(MEM_COMODOS, &depois);
+    size_t bytesMansao = depois.bytes - antes.bytes;
+    liberarMansaoProcedural(m);
+    printf("[intercalado] mansão: %zu cômodos (altura %zu), %.0f MB de nós -> %s\n", n, alturaMansao(hall),
+           (double)bytesMansao / 1048576.0, caminhoCerto ? "caminhos certos" : "DIVERGÊNCIA");
+    ok = ok && caminhoCerto;
+
+    t0 = relogioNs();
+    for (size_t i = 0; i < consultas; ++i)
+        esperados[i] = comodoDoCaminho(hall, indices[i]);
+    tSequencial = relogioNs() - t0;
+    printf("              %-14s %8.1f ns/caminho\n", "comodoDoCaminho", (double)tSequencial / (double)consultas);
+    for (int g = 0; g < totalGrupos; ++g)
+    {
+        memset(saida, 0, consultas * sizeof(*saida));
+        t0 = relogioNs();
+        comodosDosCaminhosIntercalado(hall, indices, consultas, saida, grupos[g]);
+        uint64_t t = relogioNs() - t0;
+        int igual = memcmp(saida, esperados, consultas * sizeof(*saida)) == 0;
+        printf("              %2d em voo      %8.1f ns/caminho (%.2fx) -> %s\n", grupos[g], (double)t / (double)consultas,
+               (double)tSequencial / (double)t, igual ? "mesmos cômodos" : "DIVERGÊNCIA");
+        ok = ok && igual;
+    }
+    liberarArvore(hall);
+    free(saida);
+    free(esperados);
+    free(indices);
+    return ok ? 0 : 1;
+}
+
+// Tabelas geradas: a mesma conferência de "./mestre conferir-tabelas", aqui
+// para a rodada de benchmarks pegar um mestre_tabelas.h desatualizado
+static int benchTabelas(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+#ifdef TABELAS_GERADAS
+    uint64_t t0 = relogioNs();
+    int ok = conferirTabelasGeradas();
+    uint64_t t = relogioNs() - t0;
+    printf("[tabelas] mestre_tabelas.h %s (conferência em %.1f us, fora da partida)\n",
+           ok ? "bate com as fontes" : "DESATUALIZADO: rode ./mestre gerar-tabelas > mestre_tabelas.h", (double)t / 1e3);
+    return ok ? 0 : 1;
+#else
+    printf("[tabelas] build sem mestre_tabelas.h: nada a conferir\n");
+    return 0;
+#endif
+}
+
+typedef struct
+{
+    const char *nome;
+    int (*executar)(int argc, char *argv[]);
+    const char *descricao;
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"lote", benchLote, "[n]  inserção uma a uma x inserirPistasEmLote"},
+    {"hash-perfeito", benchHashPerfeito, "[n]  hash perfeito (CHD) x tabela encadeada"},
+    {"indice", benchIndice, "[n] [consultas]  índice radix x varredura linear"},
+    {"gerador", benchGerador, "[n] [forma]  mansões procedurais (balanceada, enviesada, corredores)"},
+    {"pontuacao", benchPontuacao, "[suspeitos] [pistas]  pontuação incremental x recontagem"},
+    {"relacao", benchRelacao, "[suspeitos] [pistas]  relação CSR x tabela encadeada"},
+    {"relatorio", benchRelatorio, "[ligações] [suspeitos] [threads]  relatório final com 1..N threads"},
+    {"registro", benchRegistro, "[pistas] [threads]  registro compartilhado: CAS x trava global, 1..64 threads"},
+    {"passo", benchPasso, "[passos]  motor de jogo: passos por segundo"},
+    {"persistente", benchPersistente, "[n] [forma]  coleção persistente x cópia a cada bifurcação"},
+    {"rota", benchRota, "[n] [threads]  rota ótima: força bruta em mansões pequenas e escala"},
+    {"memoria", benchMemoria, "[n]  bytes por cômodo e por pista no layout compacto"},
+    {"congelada", benchCongelada, "[n] [passeios] [forma]  passeios até as folhas: malloc x BFS x van Emde Boas"},
+    {"sucinta", benchSucinta, "[n] [passeios] [forma]  topologia em 2 bits por cômodo: rank/select x ponteiros"},
+    {"intercalado", benchIntercalado, "[n] [consultas]  buscas e caminhos em lote: uma por vez x várias em voo"},
+    {"sobdemanda", benchSobDemanda, "[passos] [capacidade]  mansão criada conforme se anda, com despejo LRU"},
+    {"tabelas", benchTabelas, "  mestre_tabelas.h confere com as fontes (cômodos, ligações, pistas, suspeitos)"},
+    {"normalizacao", benchNormalizacao, "[n]  normalização de pistas: SIMD x escalar, chave de 64 bits x strcmp"},
+};
+
+// ./mestre bench [nome [parâmetros...]]
+// Todo benchmark precisa devolver cada estrutura que criou: sobra conta como falha
+static int executarBenchmark(const Benchmark *b, int argc, char *argv[])
+{
+    ContagemMemoria antes[TOTAL_CATEGORIAS_MEMORIA];
+    for (int cat = 0; cat < TOTAL_CATEGORIAS_MEMORIA; ++cat)
+        consultarMemoria((CategoriaMemoria)cat, &antes[cat]);
+    int falhou = b->executar(argc, argv) != 0;
+    return conferirVazamentos(antes, b->nome) ? 1 : falhou;
+}
+
+int executarBenchmarks(int argc, char *argv[])
+{
+    int total = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    if (argc == 0)
+    {
+        int falhas = 0;
+        for (int i = 0; i < total; ++i)
+            falhas += executarBenchmark(&benchmarks[i], 0, NULL) != 0;
+        return falhas ? 1 : 0;
+    }
+    for (int i = 0; i < total; ++i)
+        if (strcmp(argv[0], benchmarks[i].nome) == 0)
+            return executarBenchmark(&benchmarks[i], argc - 1, argv + 1);
+
+    printf("Benchmark desconhecido: %s\nDisponíveis:\n", argv[0]);
+    for (int i = 0; i < total; ++i)
+        printf("  %-12s %s\n", benchmarks[i].nome, benchmarks[i].descricao);
+    return 1;
 }
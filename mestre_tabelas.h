@@ -0,0 +1,114 @@
+// Gerado por "./mestre gerar-tabelas" - não editar à mão.
+// Cenário padrão: mansão estática e relação pista <-> suspeito (CHD + CSR), só leitura.
+#ifndef MESTRE_TABELAS_H
+#define MESTRE_TABELAS_H
+
+#define TABELAS_GERADAS 1
+#define TOTAL_COMODOS_GERADOS 12
+#define TOTAL_BASE_GERADA 15
+#define TOTAL_SUSPEITOS_GERADOS 5
+// impressaoCenarioPadrao() das fontes que geraram este arquivo
+#define IMPRESSAO_CENARIO_GERADO 0xf0faff91bf2f7682ull
+
+// em ordem van Emde Boas, como congelarMansao(raiz, ORDEM_VEB); sem pistas (ver pistaDe).
+// Os casts só atendem ao tipo de Comodo: nada escreve nestes cômodos.
+static const Comodo mansaoGerada[TOTAL_COMODOS_GERADOS] = {
+    {{15, "Hall", {.longo = "Hall de Entrada"}}, {0}, (Comodo *)&mansaoGerada[1], (Comodo *)&mansaoGerada[2]},
+    {{7, "Cozi", {.resto = "nha"}}, {0}, (Comodo *)&mansaoGerada[3], (Comodo *)&mansaoGerada[5]},
+    {{10, "Bibl", {.resto = "ioteca"}}, {0}, (Comodo *)&mansaoGerada[7], (Comodo *)&mansaoGerada[10]},
+    {{13, "Quar", {.longo = "Quarto Master"}}, {0}, (Comodo *)&mansaoGerada[4], NULL},
+    {{6, "Clos", {.resto = "et"}}, {0}, NULL, NULL},
+    {{10, "Escr", {.resto = "itorio"}}, {0}, (Comodo *)&mansaoGerada[6], NULL},
+    {{16, "Sala", {.longo = "Sala de Arquivos"}}, {0}, NULL, NULL},
+    {{14, "Sala", {.longo = "Sala de Jantar"}}, {0}, (Comodo *)&mansaoGerada[8], NULL},
+    {{6, "Jard", {.resto = "im"}}, {0}, (Comodo *)&mansaoGerada[9], NULL},
+    {{6, "Estu", {.resto = "fa"}}, {0}, NULL, NULL},
+    {{13, "Sala", {.longo = "Sala de Estar"}}, {0}, NULL, (Comodo *)&mansaoGerada[11]},
+    {{8, "Banh", {.resto = "eiro"}}, {0}, NULL, NULL}
+};
+
+// cômodo de mansaoGerada[] na ordem de criação de montarMansao
+static const unsigned char ordemMontagemGerada[TOTAL_COMODOS_GERADOS] = {
+    0, 1, 2, 3, 5, 7, 10, 11,
+    4, 6, 8, 9};
+
+// id na relação de cada pista de basePadrao
+static const int16_t idPistaDaBaseGerada[TOTAL_BASE_GERADA] = {
+    14, 6, 2, 1, 5, 10, 12, 7,
+    9, 13, 4, 11, 8, 0, 3};
+
+// texto de cada id de pista
+static const char *const pistasGeradas[] = {
+    "Sujeira próxima aos arquivos.",
+    "Uma janela está entreaberta.",
+    "Um objeto foi derrubado.",
+    "Garrafa vazia na adega.",
+    "Bilhete com letras cortadas.",
+    "Um cheiro estranho vem daqui.",
+    "Há pegadas de lama.",
+    "Livro antigo fora do lugar.",
+    "Sinais de lama na estufa.",
+    "Ferramentas sujas largadas.",
+    "Marcas de faca na mesa.",
+    "Papel rasgado no chão.",
+    "Perfume caro no ar.",
+    "Copo quebrado na cozinha.",
+    "A luz está apagada."
+};
+
+// CHD das pistas (ver construirHashPerfeito)
+static const uint16_t deslocamentoGerado[] = {
+    7, 6, 4, 17, 0};
+
+static const uint64_t ocupadoGerado[] = {
+    0x00000000001ed7b9ull};
+
+static const uint32_t rankGerado[] = {
+    0u};
+
+// CSR pista -> suspeitos e suspeito -> pistas (ver construirRelacao)
+static const int inicioPistaGerado[] = {
+    0, 2, 3, 4, 6, 7, 8, 10,
+    12, 13, 14, 15, 16, 17, 19, 20};
+
+static const int suspeitoDeGerado[] = {
+    0, 3, 4, 2, 4, 0, 4, 1,
+    1, 4, 0, 3, 1, 1, 2, 0,
+    4, 2, 0, 0};
+
+static const double pesoPistaGerado[] = {
+    0x1p+0, 0x1p-1, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p-1, 0x1p+0, 0x1p+0,
+    0x1p+0, 0x1p-1, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p+0,
+    0x1p+0, 0x1p+0, 0x1p-1, 0x1p+0};
+
+static const int inicioSuspeitoGerado[] = {
+    0, 6, 10, 13, 15, 20};
+
+static const int pistaDeGerado[] = {
+    14, 7, 11, 0, 13, 3, 6, 5,
+    9, 8, 2, 10, 13, 7, 0, 1,
+    12, 4, 3, 6};
+
+static const double pesoSuspeitoGerado[] = {
+    0x1p+0, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p-1, 0x1p-1, 0x1p+0, 0x1p+0,
+    0x1p+0, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p+0, 0x1p-1, 0x1p+0,
+    0x1p+0, 0x1p+0, 0x1p+0, 0x1p-1};
+
+// Os casts só atendem aos tipos de RelacaoPistaSuspeito; nunca passe para liberarRelacao.
+#define RELACAO_GERADA 1
+static const RelacaoPistaSuspeito relacaoGerada = {
+    .indicePistas = {.n = 15u, .m = 22u, .baldes = 5u, .semente = 0x09f1fd9d03f0a9b4ull,
+                     .deslocamento = (uint16_t *)deslocamentoGerado, .ocupado = (uint64_t *)ocupadoGerado,
+                     .rank = (uint32_t *)rankGerado},
+    .pistas = (const char **)pistasGeradas,
+    .totalPistas = 15,
+    .totalSuspeitos = 5,
+    .totalLigacoes = 20,
+    .inicioPista = (int *)inicioPistaGerado,
+    .suspeitoDe = (int *)suspeitoDeGerado,
+    .pesoPista = (double *)pesoPistaGerado,
+    .inicioSuspeito = (int *)inicioSuspeitoGerado,
+    .pistaDe = (int *)pistaDeGerado,
+    .pesoSuspeito = (double *)pesoSuspeitoGerado};
+
+#endif